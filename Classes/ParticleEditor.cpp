@@ -11,7 +11,10 @@
 #include "base/CCDirector.h"
 
 #include "2d/CCParticleSystem.h"
+#include "2d/CCParticleSystemQuad.h"
 #include "2d/CCParticleExamples.h"
+#include "2d/CCParticleBinary.h"
+#include "2d/CCParticleBudgetManager.h"
 #include "base/base64.h"
 #include "platform/CCFileUtils.h"
 #include "platform/CCImage.h"
@@ -77,6 +80,10 @@ ParticleEditor::ParticleEditor(cocos2d::Node* parent)
     visibleSize = cocos2d::Director::getInstance()->getVisibleSize();
     visibleOrigin = cocos2d::Director::getInstance()->getVisibleOrigin();
 
+    // systems are recreated and resized a lot while editing, recycle their particle arrays
+    cocos2d::ParticleData::setArenaPoolCapacity(4 * 1024 * 1024);
+    cocos2d::ParticleSystem::setParallelUpdateEnabled(true);
+
     loadSprites();
     addParticleSystem("res/particles/Comet.plist");
 }
@@ -96,10 +103,42 @@ void ParticleEditor::draw()
             serialize(systemData[currentIdx], "/Users/mehmeteminkacmaz/Desktop/");
         }
 
+        if(ImGui::Button("Export binary", ImVec2{100,20}))
+        {
+            exportBinary(systemData[currentIdx], cocos2d::FileUtils::getInstance()->getWritablePath() + "particle" + cocos2d::ParticleBinary::FILE_EXTENSION);
+        }
+
         if(ImGui::Button("Reset", ImVec2{100,20}))
         {
             resetCurrentParticleSystem();
         }
+
+        // bytes streamed to the vertex buffers since the previous editor frame
+        ImGui::Separator();
+        ImGui::Text("Particles: %d", systemData[currentIdx].system->getParticleCount());
+        auto quadSystem = dynamic_cast<cocos2d::ParticleSystemQuad*>(systemData[currentIdx].system);
+        ImGui::Text("Draw path: %s", quadSystem && quadSystem->isDirectDraw() ? "direct" : "batched");
+        ImGui::Text("Uploaded: %.1f KB/frame", cocos2d::ParticleSystemQuad::getUploadedBytes() / 1024.0f);
+        cocos2d::ParticleSystemQuad::resetUploadedBytes();
+        auto renderer = cocos2d::Director::getInstance()->getRenderer();
+        ImGui::Text("Renderer streamed: %.1f KB, %d stalls", renderer->getStreamedBytes() / 1024.0f, (int)renderer->getStreamStalls());
+
+        auto budget = cocos2d::ParticleBudgetManager::getInstance();
+        bool budgetEnabled = budget->isEnabled();
+        if(ImGui::Checkbox("Particle budget", &budgetEnabled))
+        {
+            budget->setEnabled(budgetEnabled);
+        }
+        if(budgetEnabled)
+        {
+            const auto& telemetry = budget->getTelemetry();
+            ImGui::Text("Frame: %.2f ms, particles: %.2f ms", telemetry.frameTime * 1000, telemetry.particleTime * 1000);
+            ImGui::Text("Simulate %.2f ms, quads %.2f ms, draw %.2f ms", telemetry.phaseTime[0] * 1000, telemetry.phaseTime[1] * 1000, telemetry.phaseTime[2] * 1000);
+            ImGui::Text("Scales: low %.2f, normal %.2f, high %.2f",
+                        budget->getScale(cocos2d::ParticleSystem::BudgetPriority::LOW),
+                        budget->getScale(cocos2d::ParticleSystem::BudgetPriority::NORMAL),
+                        budget->getScale(cocos2d::ParticleSystem::BudgetPriority::HIGH));
+        }
         ImGui::End();
     }
 
@@ -129,7 +168,10 @@ void ParticleEditor::addParticleSystem(cocos2d::ParticleSystem* ps)
 
 void ParticleEditor::resetCurrentParticleSystem()
 {
+    // replay the same particles
+    systemData[currentIdx].system->setRandomSeed(systemData[currentIdx].randomSeed);
     systemData[currentIdx].system->resetSystem();
+    systemData[currentIdx].system->prewarm(systemData[currentIdx].prewarm);
 }
 
 void ParticleEditor::drawParticleSystemData(ParticleSystemData& data)
@@ -166,6 +208,22 @@ void ParticleEditor::drawParticleSystemData(ParticleSystemData& data)
                 ps->setAngleVar(data.emitAngleVar);
             }
 
+            if(ImGui::InputScalar("Random Seed", ImGuiDataType_U64, &data.randomSeed))
+            {
+                ps->setRandomSeed(data.randomSeed);
+                ps->resetSystem();
+                ps->prewarm(data.prewarm);
+            }
+
+            // seconds simulated when the system is reset, at 60 steps per second
+            if(ImGui::InputFloat("Prewarm", &data.prewarm, 0.1f, 1.0f))
+            {
+                data.prewarm = std::max(data.prewarm, 0.f);
+                ps->setRandomSeed(data.randomSeed);
+                ps->resetSystem();
+                ps->prewarm(data.prewarm);
+            }
+
             ImGui::Spacing();
             ImGui::Spacing();
 
@@ -399,7 +457,7 @@ void ParticleEditor::changeTexture(ParticleSystemData& data, const std::string&
     }
 }
 
-void ParticleEditor::serialize(const ParticleSystemData& data, const std::string& path)
+cocos2d::ValueMap ParticleEditor::toDictionary(const ParticleSystemData& data)
 {
     cocos2d::ValueMap dict;
 
@@ -410,7 +468,7 @@ void ParticleEditor::serialize(const ParticleSystemData& data, const std::string
     dict.emplace("emitterType", cocos2d::Value{data.typeIdx});
     
     dict.emplace("sourcePositionx", cocos2d::Value{data.system->getPositionX()});
-    dict.emplace("sourcePositionx", cocos2d::Value{data.system->getPositionY()});
+    dict.emplace("sourcePositiony", cocos2d::Value{data.system->getPositionY()});
     dict.emplace("sourcePositionVariancex", cocos2d::Value{data.emitPositionVariance[0]});
     dict.emplace("sourcePositionVariancey", cocos2d::Value{data.emitPositionVariance[1]});
 
@@ -472,6 +530,13 @@ void ParticleEditor::serialize(const ParticleSystemData& data, const std::string
     dict.emplace("blendFuncSource", cocos2d::Value{blendIndexToGLenum(data.blendSrcIdx)});
     dict.emplace("blendFuncDestination", cocos2d::Value{blendIndexToGLenum(data.blendDstIdx)});
 
+    return dict;
+}
+
+void ParticleEditor::serialize(const ParticleSystemData& data, const std::string& path)
+{
+    cocos2d::ValueMap dict = toDictionary(data);
+
     const auto compressed = compressToGzip(data.textureImage->getData(), static_cast<const size_t>(data.textureImage->getDataLen()));
 
     char* encoded = nullptr;
@@ -489,6 +554,19 @@ void ParticleEditor::serialize(const ParticleSystemData& data, const std::string
     }
 }
 
+void ParticleEditor::exportBinary(const ParticleSystemData& data, const std::string& path)
+{
+    // the texture goes in decoded, ready to upload
+    cocos2d::ValueMap dict = toDictionary(data);
+    if(!cocos2d::ParticleBinary::writeToFile(dict, data.textureImage, path)) {
+        CCLOG("WRONG");
+    }
+    else
+    {
+        CCLOG("SUCCESS %s", path.c_str());
+    }
+}
+
 void ParticleEditor::updatePropertiesFromSystem(ParticleSystemData& data)
 {
     auto* ps = data.system;
@@ -499,6 +577,7 @@ void ParticleEditor::updatePropertiesFromSystem(ParticleSystemData& data)
 	data.maxParticles = ps->getTotalParticles();
 	data.emitAngle = ps->getAngle();
 	data.emitAngleVar = ps->getAngleVar();
+	data.randomSeed = ps->getRandomSeed();
 	data.typeIdx = static_cast<int>(ps->getEmitterMode());
 
     if(ps->getEmitterMode() == cocos2d::ParticleSystem::Mode::GRAVITY) {
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "base/ccTypes.h"
+#include "base/CCValue.h"
 #include "math/Vec2.h"
 #include "imgui.h"
 
@@ -35,6 +36,8 @@ private:
 		int maxParticles = 0;
 		float emitAngle = 0.f;
 		float emitAngleVar = 0.f;
+		uint64_t randomSeed = 0;
+		float prewarm = 0.f;
 		int typeIdx = 0;
 
 		// emitter props - gravity
@@ -99,7 +102,9 @@ private:
 
 	static void changeTexture(ParticleSystemData& data, const std::string& texturePath);
 
+	static cocos2d::ValueMap toDictionary(const ParticleSystemData& data);
 	static void serialize(const ParticleSystemData& data, const std::string& path);
+	static void exportBinary(const ParticleSystemData& data, const std::string& path);
 	static void updatePropertiesFromSystem(ParticleSystemData& data);
 	
 	template<typename T, typename M>
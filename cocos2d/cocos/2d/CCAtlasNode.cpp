@@ -50,6 +50,8 @@ AtlasNode::AtlasNode()
 , _uniformColor(0)
 , _ignoreContentScaleFactor(false)
 {
+    // QuadCommand acquires the shared index buffer lazily
+    setVisitThreadSafe(false);
 }
 
 AtlasNode::~AtlasNode()
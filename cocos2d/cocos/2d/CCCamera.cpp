@@ -109,6 +109,7 @@ const Camera* Camera::getVisitingCamera()
 
 Camera::Camera()
 {
+    setVisitThreadSafe(false);
     _frustum.setClipZ(true);
 }
 
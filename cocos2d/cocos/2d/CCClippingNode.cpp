@@ -60,6 +60,7 @@ ClippingNode::ClippingNode()
 , _originStencilProgram(nullptr)
 , _stencilStateManager(new StencilStateManager())
 {
+    setVisitThreadSafe(false);
 }
 
 ClippingNode::~ClippingNode()
@@ -126,6 +126,7 @@ TMXLayer::TMXLayer()
 , _vData(nullptr)
 , _indexBuffer(nullptr)
 {
+    setVisitThreadSafe(false);
 }
 
 TMXLayer::~TMXLayer()
@@ -430,6 +430,7 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
 , _underlineNode(nullptr)
 , _strikethroughEnabled(false)
 {
+    setVisitThreadSafe(false);
     setAnchorPoint(Vec2::ANCHOR_MIDDLE);
     reset();
     _hAlignment = hAlignment;
@@ -39,6 +39,7 @@ NS_CC_BEGIN
 
 LabelTTF::LabelTTF()
 {
+    setVisitThreadSafe(false);
     _renderLabel = Label::create();
     _renderLabel->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
     this->addChild(_renderLabel);
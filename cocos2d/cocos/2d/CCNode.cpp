@@ -37,10 +37,12 @@ THE SOFTWARE.
 #include "base/CCScheduler.h"
 #include "base/CCEventDispatcher.h"
 #include "base/ccUTF8.h"
+#include "base/CCJobSystem.h"
 #include "2d/CCCamera.h"
 #include "2d/CCActionManager.h"
 #include "2d/CCScene.h"
 #include "2d/CCComponent.h"
+#include "renderer/CCRenderer.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
@@ -98,6 +100,7 @@ Node::Node()
 , _glProgramState(nullptr)
 , _running(false)
 , _visible(true)
+, _visitThreadSafe(true)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
 , _isTransitionFinished(false)
@@ -1242,6 +1245,86 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     return flags;
 }
 
+void Node::visitChildren(Renderer* renderer, ssize_t begin, ssize_t end, uint32_t flags)
+{
+    auto visitList = Renderer::getVisitList();
+    if (visitList)
+    {
+        // on a worker thread, nodes that opted out are left for the main thread
+        for (auto i = begin; i < end; ++i)
+        {
+            auto child = _children.at(i);
+            if (child->_visitThreadSafe)
+                child->visit(renderer, _modelViewTransform, flags);
+            else
+                visitList->push_back({nullptr, child, &_modelViewTransform, flags});
+        }
+        return;
+    }
+
+    // only worth it when there is a subtree for every thread
+    auto jobSystem = JobSystem::getInstance();
+    const ssize_t threads = jobSystem->getWorkerCount() + 1;
+    ssize_t threadSafe = 0;
+    if (_director->isParallelVisitEnabled() && threads > 1 && end - begin >= threads)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            threadSafe += _children.at(i)->_visitThreadSafe ? 1 : 0;
+        }
+    }
+    if (threadSafe < threads || threads == 1)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            _children.at(i)->visit(renderer, _modelViewTransform, flags);
+        }
+        return;
+    }
+
+    // culling reads the matrices of the visiting camera, compute them before the workers do
+    auto camera = Camera::getVisitingCamera();
+    if (camera)
+    {
+        camera->getViewProjectionMatrix();
+    }
+
+    // contiguous ranges with a list each, so that merging the lists in order gives the serial visit order
+    const int ranges = (int) std::min(end - begin, threads * 4);
+    std::vector<Renderer::VisitList> lists(ranges);
+    jobSystem->parallelFor(ranges, [&](int range) {
+        auto& list = lists[range];
+        Renderer::setVisitList(&list);
+        auto first = begin + (end - begin) * range / ranges;
+        auto last = begin + (end - begin) * (range + 1) / ranges;
+        for (auto i = first; i < last; ++i)
+        {
+            auto child = _children.at(i);
+            if (child->_visitThreadSafe)
+                child->visit(renderer, _modelViewTransform, flags);
+            else
+                list.push_back({nullptr, child, &_modelViewTransform, flags});
+        }
+        Renderer::setVisitList(nullptr);
+    });
+
+    for (const auto& list : lists)
+    {
+        for (const auto& entry : list)
+        {
+            if (entry.command)
+            {
+                renderer->addCommand(entry.command);
+                continue;
+            }
+            _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+            _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, *entry.parentTransform);
+            entry.node->visit(renderer, *entry.parentTransform, entry.parentFlags);
+            _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        }
+    }
+}
+
 bool Node::isVisitableByVisitingCamera() const
 {
     auto camera = Camera::getVisitingCamera();
@@ -1259,15 +1342,21 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
 
+    // the worker threads of a parallel visit leave the shared matrix stack alone
+    const bool onMainThread = Renderer::getVisitList() == nullptr;
+
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
-    _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-    _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    if (onMainThread)
+    {
+        _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    }
     
     bool visibleByCamera = isVisitableByVisitingCamera();
 
-    int i = 0;
+    ssize_t i = 0;
 
     if(!_children.empty())
     {
@@ -1277,24 +1366,26 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
         {
             auto node = _children.at(i);
 
-            if (node && node->_localZOrder < 0)
-                node->visit(renderer, _modelViewTransform, flags);
-            else
+            if (!node || node->_localZOrder >= 0)
                 break;
         }
+        visitChildren(renderer, 0, i, flags);
+
         // self draw
         if (visibleByCamera)
             this->draw(renderer, _modelViewTransform, flags);
 
-        for(auto it=_children.cbegin()+i, itCend = _children.cend(); it != itCend; ++it)
-            (*it)->visit(renderer, _modelViewTransform, flags);
+        visitChildren(renderer, i, _children.size(), flags);
     }
     else if (visibleByCamera)
     {
         this->draw(renderer, _modelViewTransform, flags);
     }
 
-    _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    if (onMainThread)
+    {
+        _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    }
     
     // FIX ME: Why need to set _orderOfArrival to 0??
     // Please refer to https://github.com/cocos2d/cocos2d-x/pull/6920
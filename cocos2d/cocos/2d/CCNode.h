@@ -1180,6 +1180,25 @@ public:
     virtual void visit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags);
     virtual void visit() final;
 
+    /**
+     * Sets whether visit() and draw() of this node may run on a worker thread.
+     *
+     * When Director::setParallelVisitEnabled() is on, subtrees are visited on the JobSystem
+     * threads and their render commands are merged in the order of a serial visit.
+     * Nodes whose visit or draw use the matrix stack, render groups or other shared state
+     * opt out, they are visited on the main thread at their place in that order.
+     * The default value is true.
+     *
+     * @param safe Whether the node can be visited off the main thread.
+     */
+    void setVisitThreadSafe(bool safe) { _visitThreadSafe = safe; }
+    /**
+     * Returns whether visit() and draw() of this node may run on a worker thread.
+     *
+     * @see `setVisitThreadSafe(bool)`
+     */
+    bool isVisitThreadSafe() const { return _visitThreadSafe; }
+
 
     /** Returns the Scene that contains the Node.
      It returns `nullptr` if the node doesn't belong to any Scene.
@@ -1891,6 +1910,9 @@ protected:
     
     //check whether this camera mask is visible by the current visiting camera
     bool isVisitableByVisitingCamera() const;
+
+    // visits the children in [begin, end), on the worker threads when the parallel visit is on
+    void visitChildren(Renderer* renderer, ssize_t begin, ssize_t end, uint32_t flags);
     
     // update quaternion from Rotation3D
     void updateRotationQuat();
@@ -1986,6 +2008,8 @@ protected:
 
     bool _visible;                  ///< is this node visible
 
+    bool _visitThreadSafe;          ///< whether this node can be visited on a worker thread
+
     bool _ignoreAnchorPointForPosition; ///< true if the Anchor Vec2 will be (0,0) when you position the Node, false otherwise.
                                           ///< Used by Layer and Scene.
 
@@ -57,6 +57,7 @@ NodeGrid::NodeGrid()
 , _nodeGrid(nullptr)
 , _gridRect(Rect::ZERO)
 {
+    setVisitThreadSafe(false);
 
 }
 
@@ -44,6 +44,7 @@ NS_CC_BEGIN
 ParticleBatchNode::ParticleBatchNode()
 : _textureAtlas(nullptr)
 {
+    setVisitThreadSafe(false);
 
 }
 
@@ -433,6 +434,15 @@ void ParticleBatchNode::disableParticle(int particleIndex)
     quad->br.vertices.x = quad->br.vertices.y = quad->tr.vertices.x = quad->tr.vertices.y = quad->tl.vertices.x = quad->tl.vertices.y = quad->bl.vertices.x = quad->bl.vertices.y = 0.0f;
 }
 
+void ParticleBatchNode::disableParticles(int particleIndex, int count)
+{
+    V3F_C4B_T2F_Quad* quad = &((_textureAtlas->getQuads())[particleIndex]);
+    for (int i = 0; i < count; ++i, ++quad)
+    {
+        quad->br.vertices.x = quad->br.vertices.y = quad->tr.vertices.x = quad->tr.vertices.y = quad->tl.vertices.x = quad->tl.vertices.y = quad->bl.vertices.x = quad->bl.vertices.y = 0.0f;
+    }
+}
+
 // ParticleBatchNode - add / remove / reorder helper methods
 
 // add child helper
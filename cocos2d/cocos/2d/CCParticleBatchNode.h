@@ -109,6 +109,13 @@ public:
      */
     void disableParticle(int particleIndex);
 
+    /** Disables count consecutive particles, starting at particleIndex.
+     *
+     * @param particleIndex The index of the first particle.
+     * @param count The number of particles.
+     */
+    void disableParticles(int particleIndex, int count);
+
     /** Gets the texture atlas used for drawing the quads.
      *
      * @return The texture atlas used for drawing the quads.
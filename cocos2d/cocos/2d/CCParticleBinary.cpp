@@ -0,0 +1,436 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "2d/CCParticleBinary.h"
+#include "base/CCDirector.h"
+#include "base/ZipUtils.h"
+#include "base/ccUTF8.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
+#include "renderer/CCTextureCache.h"
+#include "xxhash.h"
+
+#include <vector>
+
+NS_CC_BEGIN
+
+namespace
+{
+    // The fields are stored as they are in memory, little endian like every supported platform.
+    const char BINARY_MAGIC[4] = { 'C', 'C', 'P', 'B' };
+    const uint32_t BINARY_VERSION = 1;
+    // the pixels start on a 16 bytes boundary, so that they can be uploaded from the mapped file
+    const uint32_t BINARY_TEXTURE_ALIGNMENT = 16;
+
+    enum TextureType : uint32_t
+    {
+        TEXTURE_NONE,
+        TEXTURE_RGBA8888,
+        TEXTURE_ENCODED,
+    };
+
+    struct BinaryHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t configOffset;
+        uint32_t configSize;
+        uint32_t textureType;
+        uint32_t textureWidth;
+        uint32_t textureHeight;
+        uint32_t texturePremultiplied;
+        uint32_t textureOffset;
+        uint32_t textureSize;
+        uint32_t nameOffset;
+        uint32_t nameSize;
+    };
+
+    struct BinaryConfig
+    {
+        int32_t maxParticles;
+        float angle;
+        float angleVar;
+        float duration;
+        uint32_t blendSrc;
+        uint32_t blendDst;
+        float startColor[4];
+        float startColorVar[4];
+        float endColor[4];
+        float endColorVar[4];
+        float startSize;
+        float startSizeVar;
+        float endSize;
+        float endSizeVar;
+        float sourcePosition[2];
+        float posVar[2];
+        float startSpin;
+        float startSpinVar;
+        float endSpin;
+        float endSpinVar;
+        int32_t emitterMode;
+        float gravity[2];
+        float speed;
+        float speedVar;
+        float radialAccel;
+        float radialAccelVar;
+        float tangentialAccel;
+        float tangentialAccelVar;
+        int32_t rotationIsDir;
+        float startRadius;
+        float startRadiusVar;
+        float endRadius;
+        float endRadiusVar;
+        float rotatePerSecond;
+        float rotatePerSecondVar;
+        float life;
+        float lifeVar;
+        int32_t yCoordFlipped;
+    };
+
+    static_assert(sizeof(BinaryHeader) == 48, "BinaryHeader is part of the file format");
+    static_assert(sizeof(BinaryConfig) == 212, "BinaryConfig is part of the file format");
+
+    void toColor(const float* in, Color4F& out)
+    {
+        out.r = in[0];
+        out.g = in[1];
+        out.b = in[2];
+        out.a = in[3];
+    }
+
+    void fromColor(const Color4F& in, float* out)
+    {
+        out[0] = in.r;
+        out[1] = in.g;
+        out[2] = in.b;
+        out[3] = in.a;
+    }
+
+    // Gets the pixels of an image as RGBA8888, false for the formats that can't be converted
+    bool getRGBA8888(Image* image, std::vector<unsigned char>& pixels)
+    {
+        if (image->isCompressed())
+        {
+            return false;
+        }
+        const unsigned char* data = image->getData();
+        const size_t count = (size_t)image->getWidth() * image->getHeight();
+        switch (image->getRenderFormat())
+        {
+        case Texture2D::PixelFormat::RGBA8888:
+            pixels.assign(data, data + count * 4);
+            return true;
+        case Texture2D::PixelFormat::RGB888:
+            pixels.resize(count * 4);
+            for (size_t i = 0; i < count; ++i)
+            {
+                pixels[i * 4] = data[i * 3];
+                pixels[i * 4 + 1] = data[i * 3 + 1];
+                pixels[i * 4 + 2] = data[i * 3 + 2];
+                pixels[i * 4 + 3] = 255;
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+const char* const ParticleBinary::FILE_EXTENSION = ".ccpb";
+
+bool ParticleBinary::isBinaryFile(const std::string& filename)
+{
+    return FileUtils::getInstance()->getFileExtension(filename) == FILE_EXTENSION;
+}
+
+bool ParticleBinary::readConfig(const unsigned char* bytes, ssize_t size, const std::string& fullPath, const std::string& dirname,
+                                bool loadTexture, ParticleConfig& config)
+{
+    BinaryHeader header;
+    if (size < (ssize_t)sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 || header.version != BINARY_VERSION)
+    {
+        CCLOG("cocos2d: ParticleBinary: %s is not a compiled particle file of this version", fullPath.c_str());
+        return false;
+    }
+    if (header.configSize != sizeof(BinaryConfig)
+        || (uint64_t)header.configOffset + header.configSize > (uint64_t)size
+        || (uint64_t)header.textureOffset + header.textureSize > (uint64_t)size
+        || (uint64_t)header.nameOffset + header.nameSize > (uint64_t)size)
+    {
+        CCLOG("cocos2d: ParticleBinary: %s is truncated", fullPath.c_str());
+        return false;
+    }
+
+    BinaryConfig binary;
+    memcpy(&binary, bytes + header.configOffset, sizeof(binary));
+
+    config.maxParticles = binary.maxParticles;
+    config.angle = binary.angle;
+    config.angleVar = binary.angleVar;
+    config.duration = binary.duration;
+    config.blendFunc.src = binary.blendSrc;
+    config.blendFunc.dst = binary.blendDst;
+    toColor(binary.startColor, config.startColor);
+    toColor(binary.startColorVar, config.startColorVar);
+    toColor(binary.endColor, config.endColor);
+    toColor(binary.endColorVar, config.endColorVar);
+    config.startSize = binary.startSize;
+    config.startSizeVar = binary.startSizeVar;
+    config.endSize = binary.endSize;
+    config.endSizeVar = binary.endSizeVar;
+    config.sourcePosition.set(binary.sourcePosition[0], binary.sourcePosition[1]);
+    config.posVar.set(binary.posVar[0], binary.posVar[1]);
+    config.startSpin = binary.startSpin;
+    config.startSpinVar = binary.startSpinVar;
+    config.endSpin = binary.endSpin;
+    config.endSpinVar = binary.endSpinVar;
+    config.emitterMode = (ParticleSystem::Mode)binary.emitterMode;
+    config.gravity.set(binary.gravity[0], binary.gravity[1]);
+    config.speed = binary.speed;
+    config.speedVar = binary.speedVar;
+    config.radialAccel = binary.radialAccel;
+    config.radialAccelVar = binary.radialAccelVar;
+    config.tangentialAccel = binary.tangentialAccel;
+    config.tangentialAccelVar = binary.tangentialAccelVar;
+    config.rotationIsDir = binary.rotationIsDir != 0;
+    config.startRadius = binary.startRadius;
+    config.startRadiusVar = binary.startRadiusVar;
+    config.endRadius = binary.endRadius;
+    config.endRadiusVar = binary.endRadiusVar;
+    config.rotatePerSecond = binary.rotatePerSecond;
+    config.rotatePerSecondVar = binary.rotatePerSecondVar;
+    config.life = binary.life;
+    config.lifeVar = binary.lifeVar;
+    config.yCoordFlipped = binary.yCoordFlipped;
+
+    if (config.emitterMode != ParticleSystem::Mode::GRAVITY && config.emitterMode != ParticleSystem::Mode::RADIUS)
+    {
+        CCASSERT(false, "Invalid emitterType in config file");
+        return false;
+    }
+
+    config.texture = nullptr;
+    if (!loadTexture)
+    {
+        return true;
+    }
+
+    // unlike the plists, the embedded texture comes first, it costs no file system lookup
+    auto textureCache = Director::getInstance()->getTextureCache();
+    if (header.textureType != TEXTURE_NONE)
+    {
+        // keyed by content, a file exported again under the same name must not find the previous texture
+        std::string key = StringUtils::format("particleBinary:%08x:%u:%u",
+                                              XXH32(bytes + header.textureOffset, (int)header.textureSize, 0),
+                                              (unsigned int)header.textureSize, (unsigned int)header.textureType);
+        config.texture = textureCache->getTextureForKey(key);
+        if (!config.texture)
+        {
+            Image* image = new (std::nothrow) Image();
+            bool isOK = false;
+            if (header.textureType == TEXTURE_RGBA8888)
+            {
+                isOK = (uint64_t)header.textureWidth * header.textureHeight * 4 == header.textureSize
+                    && image->initWithRawData(bytes + header.textureOffset, header.textureSize,
+                                              header.textureWidth, header.textureHeight, 8, header.texturePremultiplied != 0);
+            }
+            else
+            {
+                isOK = image->initWithImageData(bytes + header.textureOffset, header.textureSize);
+            }
+            if (isOK)
+            {
+                config.texture = textureCache->addImage(image, key);
+            }
+            else
+            {
+                CCLOG("cocos2d: ParticleBinary: error decoding the texture of %s", fullPath.c_str());
+            }
+            image->release();
+        }
+    }
+    else if (header.nameSize > 0)
+    {
+        std::string textureName((const char*)bytes + header.nameOffset, header.nameSize);
+        // set not pop-up message box when load image failed
+        bool notify = FileUtils::getInstance()->isPopupNotify();
+        FileUtils::getInstance()->setPopupNotify(false);
+        config.texture = textureCache->addImage(dirname + textureName);
+        FileUtils::getInstance()->setPopupNotify(notify);
+    }
+    return true;
+}
+
+bool ParticleBinary::writeToFile(ValueMap& dictionary, Image* image, const std::string& path)
+{
+    ParticleConfig config = ParticleConfig();
+    if (!ParticleSystem::readConfig(dictionary, "", false, config, nullptr))
+    {
+        return false;
+    }
+
+    BinaryConfig binary;
+    memset(&binary, 0, sizeof(binary));
+    binary.maxParticles = config.maxParticles;
+    binary.angle = config.angle;
+    binary.angleVar = config.angleVar;
+    binary.duration = config.duration;
+    binary.blendSrc = config.blendFunc.src;
+    binary.blendDst = config.blendFunc.dst;
+    fromColor(config.startColor, binary.startColor);
+    fromColor(config.startColorVar, binary.startColorVar);
+    fromColor(config.endColor, binary.endColor);
+    fromColor(config.endColorVar, binary.endColorVar);
+    binary.startSize = config.startSize;
+    binary.startSizeVar = config.startSizeVar;
+    binary.endSize = config.endSize;
+    binary.endSizeVar = config.endSizeVar;
+    binary.sourcePosition[0] = config.sourcePosition.x;
+    binary.sourcePosition[1] = config.sourcePosition.y;
+    binary.posVar[0] = config.posVar.x;
+    binary.posVar[1] = config.posVar.y;
+    binary.startSpin = config.startSpin;
+    binary.startSpinVar = config.startSpinVar;
+    binary.endSpin = config.endSpin;
+    binary.endSpinVar = config.endSpinVar;
+    binary.emitterMode = (int32_t)config.emitterMode;
+    binary.gravity[0] = config.gravity.x;
+    binary.gravity[1] = config.gravity.y;
+    binary.speed = config.speed;
+    binary.speedVar = config.speedVar;
+    binary.radialAccel = config.radialAccel;
+    binary.radialAccelVar = config.radialAccelVar;
+    binary.tangentialAccel = config.tangentialAccel;
+    binary.tangentialAccelVar = config.tangentialAccelVar;
+    binary.rotationIsDir = config.rotationIsDir ? 1 : 0;
+    binary.startRadius = config.startRadius;
+    binary.startRadiusVar = config.startRadiusVar;
+    binary.endRadius = config.endRadius;
+    binary.endRadiusVar = config.endRadiusVar;
+    binary.rotatePerSecond = config.rotatePerSecond;
+    binary.rotatePerSecondVar = config.rotatePerSecondVar;
+    binary.life = config.life;
+    binary.lifeVar = config.lifeVar;
+    binary.yCoordFlipped = config.yCoordFlipped;
+
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.textureType = TEXTURE_NONE;
+
+    // the texture, decoded to RGBA8888 whenever possible
+    std::vector<unsigned char> texture;
+    Image* decoded = nullptr;
+    if (!image)
+    {
+        auto it = dictionary.find("textureImageData");
+        if (it != dictionary.end() && !it->second.asString().empty())
+        {
+            const std::string& textureData = it->second.asString();
+            unsigned char* deflated = nullptr;
+            ssize_t deflatedLen = ZipUtils::inflateBase64Memory(textureData.c_str(), (ssize_t)textureData.size(), &deflated);
+            if (!deflated)
+            {
+                CCLOG("cocos2d: ParticleBinary: error ungzipping textureImageData");
+                return false;
+            }
+            decoded = new (std::nothrow) Image();
+            if (decoded && decoded->initWithImageData(deflated, deflatedLen))
+            {
+                image = decoded;
+            }
+            // kept encoded when it can't be converted
+            texture.assign(deflated, deflated + deflatedLen);
+            header.textureType = TEXTURE_ENCODED;
+            free(deflated);
+        }
+    }
+    if (image)
+    {
+        if (getRGBA8888(image, texture))
+        {
+            header.textureType = TEXTURE_RGBA8888;
+            header.textureWidth = image->getWidth();
+            header.textureHeight = image->getHeight();
+            header.texturePremultiplied = image->hasPremultipliedAlpha() ? 1 : 0;
+        }
+        else if (!decoded)
+        {
+            CCLOG("cocos2d: ParticleBinary: the texture can't be converted to RGBA8888");
+            return false;
+        }
+    }
+    CC_SAFE_RELEASE(decoded);
+
+    std::string textureName;
+    if (header.textureType == TEXTURE_NONE)
+    {
+        textureName = dictionary["textureFileName"].asString();
+    }
+
+    header.configOffset = sizeof(header);
+    header.configSize = sizeof(binary);
+    header.nameOffset = header.configOffset + header.configSize;
+    header.nameSize = (uint32_t)textureName.size();
+    uint32_t end = header.nameOffset + header.nameSize;
+    header.textureOffset = (end + BINARY_TEXTURE_ALIGNMENT - 1) / BINARY_TEXTURE_ALIGNMENT * BINARY_TEXTURE_ALIGNMENT;
+    header.textureSize = (uint32_t)texture.size();
+
+    std::vector<unsigned char> file(header.textureOffset + header.textureSize, 0);
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + header.configOffset, &binary, sizeof(binary));
+    if (!textureName.empty())
+    {
+        memcpy(file.data() + header.nameOffset, textureName.data(), textureName.size());
+    }
+    if (!texture.empty())
+    {
+        memcpy(file.data() + header.textureOffset, texture.data(), texture.size());
+    }
+
+    Data data;
+    data.copy(file.data(), (ssize_t)file.size());
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+bool ParticleBinary::convertPlist(const std::string& plistFile, const std::string& path)
+{
+    auto fileUtils = FileUtils::getInstance();
+    ValueMap dict = fileUtils->getValueMapFromFile(fileUtils->fullPathForFilename(plistFile));
+    if (dict.empty())
+    {
+        CCLOG("cocos2d: ParticleBinary: can't read %s", plistFile.c_str());
+        return false;
+    }
+    return writeToFile(dict, nullptr, path);
+}
+
+NS_CC_END
@@ -0,0 +1,97 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCPARTICLEBINARY_H_
+#define __CCPARTICLEBINARY_H_
+
+#include "2d/CCParticleSystem.h"
+#include <string>
+
+NS_CC_BEGIN
+
+class Image;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class ParticleBinary
+ * @brief Compiled particle files, a binary alternative to the plists.
+ *
+ * A compiled file holds the emitter parameters as fixed size fields and the texture as RGBA8888 pixels
+ * ready to upload, or as an encoded image when it could not be decoded to RGBA8888.
+ * It is memory mapped and read in place: loading parses no XML, does no string lookups and
+ * no base64 or gzip decoding.
+ * ParticleSystem::initWithFile() and ParticleTemplateCache read the files with the FILE_EXTENSION extension.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL ParticleBinary
+{
+public:
+    /** Extension of the compiled particle files. */
+    static const char* const FILE_EXTENSION;
+
+    /** Returns whether a file name has the extension of the compiled particle files. */
+    static bool isBinaryFile(const std::string& filename);
+
+    /** Reads the emitter parameters of a compiled particle file.
+     *
+     * @param bytes Contents of the file.
+     * @param size Size of the file.
+     * @param fullPath Full path of the file, the key of its embedded texture in the TextureCache.
+     * @param dirname Directory of the file, the texture file name is relative to it.
+     * @param loadTexture Whether the texture is found or loaded.
+     * @param config The parameters read.
+     * @return false if the file is not a valid compiled particle file.
+     */
+    static bool readConfig(const unsigned char* bytes, ssize_t size, const std::string& fullPath, const std::string& dirname,
+                           bool loadTexture, ParticleConfig& config);
+
+    /** Writes a compiled particle file from a plist dictionary.
+     *
+     * @param dictionary Emitter parameters, as in a particle plist.
+     * @param image The texture. When nullptr, the textureImageData or textureFileName of the dictionary is used.
+     * @param path Full path of the file to write.
+     * @return true if the file was written.
+     */
+    static bool writeToFile(ValueMap& dictionary, Image* image, const std::string& path);
+
+    /** Compiles a particle plist.
+     *
+     * @param plistFile Particle plist file name.
+     * @param path Full path of the compiled file to write.
+     * @return true if the file was written.
+     */
+    static bool convertPlist(const std::string& plistFile, const std::string& path);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CCPARTICLEBINARY_H_
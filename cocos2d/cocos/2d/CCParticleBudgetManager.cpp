@@ -0,0 +1,222 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "2d/CCParticleBudgetManager.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+static ParticleBudgetManager* s_particleBudgetManager = nullptr;
+
+ParticleBudgetManager::ScopedTimer::ScopedTimer(Phase phase)
+: _phase(phase)
+, _enabled(s_particleBudgetManager && s_particleBudgetManager->isEnabled())
+{
+    if (_enabled)
+    {
+        _start = std::chrono::steady_clock::now();
+    }
+}
+
+ParticleBudgetManager::ScopedTimer::~ScopedTimer()
+{
+    if (_enabled && s_particleBudgetManager)
+    {
+        std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - _start;
+        s_particleBudgetManager->addTime(_phase, elapsed.count());
+    }
+}
+
+ParticleBudgetManager* ParticleBudgetManager::getInstance()
+{
+    if (s_particleBudgetManager == nullptr)
+    {
+        s_particleBudgetManager = new (std::nothrow) ParticleBudgetManager;
+    }
+    return s_particleBudgetManager;
+}
+
+void ParticleBudgetManager::destroyInstance()
+{
+    delete s_particleBudgetManager;
+    s_particleBudgetManager = nullptr;
+}
+
+float ParticleBudgetManager::getCurrentScale(ParticleSystem::BudgetPriority priority)
+{
+    if (s_particleBudgetManager == nullptr || !s_particleBudgetManager->_enabled)
+        return 1.0f;
+    return s_particleBudgetManager->getScale(priority);
+}
+
+ParticleBudgetManager::ParticleBudgetManager()
+: _enabled(false)
+, _afterDrawListener(nullptr)
+, _targetFrameTime(1.0f / 55)
+, _particleTimeBudget(0)
+, _maxParticles(0)
+, _scaleStep(0.1f)
+, _framesSinceAdjustment(0)
+{
+    _minScales[static_cast<int>(ParticleSystem::BudgetPriority::LOW)] = 0.1f;
+    _minScales[static_cast<int>(ParticleSystem::BudgetPriority::NORMAL)] = 0.3f;
+    _minScales[static_cast<int>(ParticleSystem::BudgetPriority::HIGH)] = 0.6f;
+    for (auto& nanoseconds : _phaseNanoseconds)
+    {
+        nanoseconds = 0;
+    }
+    _telemetry = Telemetry();
+    resetScales();
+}
+
+ParticleBudgetManager::~ParticleBudgetManager()
+{
+    setEnabled(false);
+}
+
+void ParticleBudgetManager::setEnabled(bool enabled)
+{
+    if (_enabled == enabled)
+        return;
+
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    if (enabled)
+    {
+        _afterDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*) {
+            endFrame();
+        });
+        _telemetry = Telemetry();
+        _telemetry.frameTime = _targetFrameTime;
+    }
+    else
+    {
+        dispatcher->removeEventListener(_afterDrawListener);
+        _afterDrawListener = nullptr;
+        resetScales();
+    }
+    _enabled = enabled;
+}
+
+void ParticleBudgetManager::setMinScale(ParticleSystem::BudgetPriority priority, float scale)
+{
+    int index = static_cast<int>(priority);
+    // emitting nothing would stop the clock of the emitters too
+    _minScales[index] = clampf(scale, 0.01f, 1.0f);
+    _scales[index] = std::max(_scales[index], _minScales[index]);
+}
+
+float ParticleBudgetManager::getMinScale(ParticleSystem::BudgetPriority priority) const
+{
+    return _minScales[static_cast<int>(priority)];
+}
+
+float ParticleBudgetManager::getScale(ParticleSystem::BudgetPriority priority) const
+{
+    return _scales[static_cast<int>(priority)];
+}
+
+void ParticleBudgetManager::resetScales()
+{
+    for (auto& scale : _scales)
+    {
+        scale = 1.0f;
+    }
+    _framesSinceAdjustment = 0;
+}
+
+void ParticleBudgetManager::addTime(Phase phase, float seconds)
+{
+    _phaseNanoseconds[static_cast<int>(phase)] += static_cast<long long>(seconds * 1e9f);
+}
+
+void ParticleBudgetManager::endFrame()
+{
+    _telemetry.systems = 0;
+    _telemetry.offscreenSystems = 0;
+    _telemetry.particles = 0;
+    for (auto system : ParticleSystem::getAllParticleSystems())
+    {
+        ++_telemetry.systems;
+        if (system->isOffscreen())
+        {
+            ++_telemetry.offscreenSystems;
+        }
+        _telemetry.particles += system->getParticleCount();
+    }
+
+    float particleTime = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        _telemetry.phaseTime[i] = _phaseNanoseconds[i].exchange(0) * 1e-9f;
+        particleTime += _telemetry.phaseTime[i];
+    }
+
+    // smoothed, a single slow frame (loading a texture...) should not degrade the effects
+    _telemetry.frameTime += (Director::getInstance()->getDeltaTime() - _telemetry.frameTime) * 0.1f;
+    _telemetry.particleTime += (particleTime - _telemetry.particleTime) * 0.1f;
+
+    if (++_framesSinceAdjustment < ADJUSTMENT_INTERVAL)
+        return;
+
+    bool overBudget = _telemetry.frameTime > _targetFrameTime
+        || (_particleTimeBudget > 0 && _telemetry.particleTime > _particleTimeBudget)
+        || (_maxParticles > 0 && _telemetry.particles > _maxParticles);
+    // some slack, not to oscillate around the target
+    bool underBudget = _telemetry.frameTime < _targetFrameTime * 0.9f
+        && (_particleTimeBudget <= 0 || _telemetry.particleTime < _particleTimeBudget * 0.8f)
+        && (_maxParticles <= 0 || _telemetry.particles < _maxParticles * 0.9f);
+
+    if (overBudget)
+    {
+        // the lowest priority class that can still be reduced
+        for (int i = 0; i < PRIORITY_COUNT; ++i)
+        {
+            if (_scales[i] > _minScales[i])
+            {
+                _scales[i] = std::max(_scales[i] - _scaleStep, _minScales[i]);
+                _framesSinceAdjustment = 0;
+                break;
+            }
+        }
+    }
+    else if (underBudget)
+    {
+        // the highest priority class that is reduced
+        for (int i = PRIORITY_COUNT - 1; i >= 0; --i)
+        {
+            if (_scales[i] < 1.0f)
+            {
+                _scales[i] = std::min(_scales[i] + _scaleStep * 0.5f, 1.0f);
+                _framesSinceAdjustment = 0;
+                break;
+            }
+        }
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,179 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCPARTICLEBUDGETMANAGER_H_
+#define __CCPARTICLEBUDGETMANAGER_H_
+
+#include "2d/CCParticleSystem.h"
+#include <atomic>
+#include <chrono>
+
+NS_CC_BEGIN
+
+class EventListenerCustom;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class ParticleBudgetManager
+ * @brief Singleton scaling down the emission of the particle systems when a frame takes too long.
+ *
+ * Once enabled, the manager measures every frame the time spent simulating the particles,
+ * generating and uploading their quads and drawing them, and counts the live particles.
+ * While the frame time is above the target, or the particles exceed their own budgets,
+ * the emission rate and the particle cap of the systems are scaled down one priority class
+ * at a time: BudgetPriority::LOW first, BudgetPriority::HIGH last. They are restored in the
+ * reverse order once the frame time is back under the target.
+ *
+ * The scales are combined with the factor set by EngineDataManager on Android.
+ * @js NA
+ */
+class CC_DLL ParticleBudgetManager
+{
+public:
+    /** The measured parts of the particle work. */
+    enum class Phase
+    {
+        SIMULATE,   //!< emitting and simulating the particles
+        QUADS,      //!< generating and uploading the quads
+        DRAW,       //!< issuing the draw commands
+    };
+
+    /** What the particles cost in the last frame. */
+    struct Telemetry
+    {
+        /** number of running particle systems */
+        int systems;
+        /** number of systems culled by offscreen culling */
+        int offscreenSystems;
+        /** number of live particles */
+        int particles;
+        /** time spent in each Phase, in seconds; SIMULATE and QUADS add the time of all the threads */
+        float phaseTime[3];
+        /** smoothed duration of a frame, in seconds */
+        float frameTime;
+        /** smoothed time spent on the particles in a frame, in seconds */
+        float particleTime;
+    };
+
+    /** Measures the time from its construction to its destruction when the manager is enabled. */
+    class CC_DLL ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Phase phase);
+        ~ScopedTimer();
+    private:
+        Phase _phase;
+        bool _enabled;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    /** Returns the shared instance of the manager. */
+    static ParticleBudgetManager* getInstance();
+
+    /** Destroys the manager, restoring the full emission of every system. */
+    static void destroyInstance();
+
+    /** Gets the scale of the emission of a priority class, 1 when no manager is enabled. */
+    static float getCurrentScale(ParticleSystem::BudgetPriority priority);
+
+    /** Enables or disables the manager, disabled by default. Disabling it restores the scales. */
+    void setEnabled(bool enabled);
+    /** Whether or not the manager is enabled. */
+    bool isEnabled() const { return _enabled; }
+
+    /** Sets the frame time above which the emission is reduced, in seconds. Default is 1/55. */
+    void setTargetFrameTime(float seconds) { _targetFrameTime = seconds; }
+    /** Gets the frame time above which the emission is reduced, in seconds. */
+    float getTargetFrameTime() const { return _targetFrameTime; }
+
+    /** Sets the time the particles may take in a frame, in seconds, 0 (the default) for no limit.
+     * It catches particles that are too costly on a device whose frame time is capped by the vertical sync.
+     */
+    void setParticleTimeBudget(float seconds) { _particleTimeBudget = seconds; }
+    /** Gets the time the particles may take in a frame, in seconds. */
+    float getParticleTimeBudget() const { return _particleTimeBudget; }
+
+    /** Sets the number of live particles above which the emission is reduced, 0 (the default) for no limit. */
+    void setMaxParticles(int count) { _maxParticles = count; }
+    /** Gets the number of live particles above which the emission is reduced. */
+    int getMaxParticles() const { return _maxParticles; }
+
+    /** Sets the lowest scale of a priority class, in [0.01, 1]. Defaults are 0.1 for LOW, 0.3 for NORMAL and 0.6 for HIGH. */
+    void setMinScale(ParticleSystem::BudgetPriority priority, float scale);
+    /** Gets the lowest scale of a priority class. */
+    float getMinScale(ParticleSystem::BudgetPriority priority) const;
+
+    /** Sets how much a scale is lowered when the frames are over budget, it is raised at half that speed. Default is 0.1.
+     * The scales are adjusted at most every ADJUSTMENT_INTERVAL frames, so that the smoothed times can follow.
+     */
+    void setScaleStep(float step) { _scaleStep = step; }
+    /** Gets how much a scale is lowered when the frames are over budget. */
+    float getScaleStep() const { return _scaleStep; }
+
+    /** Gets the scale of the emission rate and particle cap of a priority class. */
+    float getScale(ParticleSystem::BudgetPriority priority) const;
+    /** Restores the full emission of every priority class. */
+    void resetScales();
+
+    /** Gets what the particles cost in the last frame. */
+    const Telemetry& getTelemetry() const { return _telemetry; }
+
+    /** Adds time spent in a phase of the current frame, it may be called from any thread. */
+    void addTime(Phase phase, float seconds);
+
+CC_CONSTRUCTOR_ACCESS:
+    ParticleBudgetManager();
+    ~ParticleBudgetManager();
+
+protected:
+    static const int PRIORITY_COUNT = 3;
+    static const int ADJUSTMENT_INTERVAL = 10;
+
+    /** Collects the telemetry of the frame and adjusts the scales, after it is drawn. */
+    void endFrame();
+
+    bool _enabled;
+    EventListenerCustom* _afterDrawListener;
+    float _targetFrameTime;
+    float _particleTimeBudget;
+    int _maxParticles;
+    float _scaleStep;
+    float _minScales[PRIORITY_COUNT];
+    float _scales[PRIORITY_COUNT];
+    int _framesSinceAdjustment;
+    /** nanoseconds spent in each phase in the current frame */
+    std::atomic<long long> _phaseNanoseconds[3];
+    Telemetry _telemetry;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CCPARTICLEBUDGETMANAGER_H_
@@ -46,16 +46,27 @@ THE SOFTWARE.
 #include "2d/CCParticleSystem.h"
 
 #include <string>
+#include <map>
+#include <algorithm>
+#include <cfloat>
 
 #include "2d/CCParticleBatchNode.h"
+#include "2d/CCParticleBinary.h"
+#include "2d/CCParticleBudgetManager.h"
 #include "renderer/CCTextureAtlas.h"
-#include "base/base64.h"
+#include "renderer/CCRenderer.h"
 #include "base/ZipUtils.h"
 #include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCJobSystem.h"
 #include "base/CCProfiling.h"
 #include "base/ccUTF8.h"
+#include "math/MathUtil.h"
 #include "renderer/CCTextureCache.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
+#include "xxhash.h"
 
 using namespace std;
 
@@ -79,34 +90,92 @@ NS_CC_BEGIN
 //
 
 
-inline void normalize_point(float x, float y, particle_point* out)
+// particles processed by one job when a system is updated in chunks, a multiple of the array padding.
+// 4096 floats are 16KB per attribute
+static const int PARTICLE_CHUNK_SIZE = 4096;
+
+// random streams of the spawned particles, a particle uses the number of each stream given by its serial number
+enum SpawnStream : uint32_t
+{
+    SPAWN_STREAM_LIFE,
+    SPAWN_STREAM_POS_X,
+    SPAWN_STREAM_POS_Y,
+    SPAWN_STREAM_COLOR_R,
+    SPAWN_STREAM_COLOR_G,
+    SPAWN_STREAM_COLOR_B,
+    SPAWN_STREAM_COLOR_A,
+    SPAWN_STREAM_END_COLOR_R,
+    SPAWN_STREAM_END_COLOR_G,
+    SPAWN_STREAM_END_COLOR_B,
+    SPAWN_STREAM_END_COLOR_A,
+    SPAWN_STREAM_SIZE,
+    SPAWN_STREAM_END_SIZE,
+    SPAWN_STREAM_SPIN,
+    SPAWN_STREAM_END_SPIN,
+    SPAWN_STREAM_ANGLE,
+    SPAWN_STREAM_SPEED,
+    SPAWN_STREAM_RADIAL_ACCEL,
+    SPAWN_STREAM_TANGENTIAL_ACCEL,
+    SPAWN_STREAM_RADIUS,
+    SPAWN_STREAM_ROTATE_PER_SECOND,
+    SPAWN_STREAM_END_RADIUS
+};
+
+// alignment of the ParticleData block, and of each array in it
+static const size_t PARTICLE_DATA_ALIGNMENT = 64;
+// arrays are padded to a multiple of this many elements
+static const int PARTICLE_DATA_PADDING = PARTICLE_DATA_ALIGNMENT / sizeof(float);
+
+static const int PARTICLE_DATA_COMMON_ARRAYS = 19;
+static const int PARTICLE_DATA_MODE_ARRAYS = 4;
+
+// released blocks kept for reuse, sorted by size
+static std::multimap<size_t, void*> s_arenaPool;
+static size_t s_arenaPoolSize = 0;
+static size_t s_arenaPoolCapacity = 0;
+
+static size_t getStride(int count)
+{
+    return ((count + PARTICLE_DATA_PADDING - 1) / PARTICLE_DATA_PADDING) * PARTICLE_DATA_PADDING;
+}
+
+// size is updated to the real size of the block when it comes from the pool
+static void* allocArena(size_t& size)
+{
+    // a block of the pool is reused when it is at most 50% bigger than needed
+    auto iter = s_arenaPool.lower_bound(size);
+    if (iter != s_arenaPool.end() && iter->first <= size + size / 2)
+    {
+        void* arena = iter->second;
+        size = iter->first;
+        s_arenaPoolSize -= iter->first;
+        s_arenaPool.erase(iter);
+        return arena;
+    }
+
+    // over allocate, and keep the pointer returned by malloc right before the aligned block
+    void* raw = malloc(size + PARTICLE_DATA_ALIGNMENT + sizeof(void*));
+    if (!raw)
+        return nullptr;
+    uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + PARTICLE_DATA_ALIGNMENT - 1) & ~(uintptr_t)(PARTICLE_DATA_ALIGNMENT - 1);
+    ((void**)aligned)[-1] = raw;
+    return (void*)aligned;
+}
+
+static void freeArena(void* arena)
 {
-    float n = x * x + y * y;
-    // Already normalized.
-    if (n == 1.0f)
-        return;
-    
-    n = sqrt(n);
-    // Too close to zero.
-    if (n < MATH_TOLERANCE)
-        return;
-    
-    n = 1.0f / n;
-    out->x = x * n;
-    out->y = y * n;
+    free(((void**)arena)[-1]);
 }
 
-/**
- A more effect random number getter function, get from ejoy2d.
- */
-inline static float RANDOM_M11(unsigned int *seed) {
-    *seed = *seed * 134775813 + 1;
-    union {
-        uint32_t d;                                     
-        float f;
-    } u;
-    u.d = (((uint32_t)(*seed) & 0x7fff) << 8) | 0x40000000;
-    return u.f - 3.0f;
+static void recycleArena(void* arena, size_t size)
+{
+    if (s_arenaPoolSize + size > s_arenaPoolCapacity)
+    {
+        freeArena(arena);
+        return;
+    }
+    s_arenaPool.emplace(size, arena);
+    s_arenaPoolSize += size;
 }
 
 ParticleData::ParticleData()
@@ -114,80 +183,193 @@ ParticleData::ParticleData()
     memset(this, 0, sizeof(ParticleData));
 }
 
-bool ParticleData::init(int count)
+bool ParticleData::init(int count, int modeArrays)
 {
+    CCASSERT(!_arena, "ParticleData: release() should be called before init()");
+
+    const size_t stride = getStride(count);
+    int arrays = PARTICLE_DATA_COMMON_ARRAYS;
+    if (modeArrays & MODE_A)
+        arrays += PARTICLE_DATA_MODE_ARRAYS;
+    if (modeArrays & MODE_B)
+        arrays += PARTICLE_DATA_MODE_ARRAYS;
+
+    size_t arenaSize = std::max(stride * arrays * sizeof(float), PARTICLE_DATA_ALIGNMENT);
+    _arena = allocArena(arenaSize);
+    if (!_arena)
+        return false;
+    _arenaSize = arenaSize;
+
     maxCount = count;
+    this->modeArrays = modeArrays;
+
+    float* next = (float*)_arena;
+    auto nextArray = [&next, stride]() {
+        float* array = next;
+        next += stride;
+        return array;
+    };
+
+    // common arrays first, setModeArrays() relies on it
+    posx = nextArray();
+    posy = nextArray();
+    startPosX = nextArray();
+    startPosY = nextArray();
+    colorR = nextArray();
+    colorG = nextArray();
+    colorB = nextArray();
+    colorA = nextArray();
+    deltaColorR = nextArray();
+    deltaColorG = nextArray();
+    deltaColorB = nextArray();
+    deltaColorA = nextArray();
+    size = nextArray();
+    deltaSize = nextArray();
+    rotation = nextArray();
+    deltaRotation = nextArray();
+    timeToLive = nextArray();
+    static_assert(sizeof(unsigned int) == sizeof(float) && sizeof(int) == sizeof(float), "index arrays share the float stride");
+    atlasIndex = (unsigned int*)nextArray();
+    survivors = (int*)nextArray();
+
+    if (modeArrays & MODE_A)
+    {
+        modeA.dirX = nextArray();
+        modeA.dirY = nextArray();
+        modeA.radialAccel = nextArray();
+        modeA.tangentialAccel = nextArray();
+    }
+
+    if (modeArrays & MODE_B)
+    {
+        modeB.angle = nextArray();
+        modeB.degreesPerSecond = nextArray();
+        modeB.deltaRadius = nextArray();
+        modeB.radius = nextArray();
+    }
     
-    posx= (float*)malloc(count * sizeof(float));
-    posy= (float*)malloc(count * sizeof(float));
-    startPosX= (float*)malloc(count * sizeof(float));
-    startPosY= (float*)malloc(count * sizeof(float));
-    colorR= (float*)malloc(count * sizeof(float));
-    colorG= (float*)malloc(count * sizeof(float));
-    colorB= (float*)malloc(count * sizeof(float));
-    colorA= (float*)malloc(count * sizeof(float));
-    deltaColorR= (float*)malloc(count * sizeof(float));
-    deltaColorG= (float*)malloc(count * sizeof(float));
-    deltaColorB= (float*)malloc(count * sizeof(float));
-    deltaColorA= (float*)malloc(count * sizeof(float));
-    size= (float*)malloc(count * sizeof(float));
-    deltaSize= (float*)malloc(count * sizeof(float));
-    rotation= (float*)malloc(count * sizeof(float));
-    deltaRotation= (float*)malloc(count * sizeof(float));
-    timeToLive= (float*)malloc(count * sizeof(float));
-    atlasIndex= (unsigned int*)malloc(count * sizeof(unsigned int));
-    
-    modeA.dirX= (float*)malloc(count * sizeof(float));
-    modeA.dirY= (float*)malloc(count * sizeof(float));
-    modeA.radialAccel= (float*)malloc(count * sizeof(float));
-    modeA.tangentialAccel= (float*)malloc(count * sizeof(float));
-    
-    modeB.angle= (float*)malloc(count * sizeof(float));
-    modeB.degreesPerSecond= (float*)malloc(count * sizeof(float));
-    modeB.deltaRadius= (float*)malloc(count * sizeof(float));
-    modeB.radius= (float*)malloc(count * sizeof(float));
-    
-    return posx && posy && startPosY && startPosX && colorR && colorG && colorB && colorA &&
-    deltaColorR && deltaColorG && deltaColorB && deltaColorA && size && deltaSize &&
-    rotation && deltaRotation && timeToLive && atlasIndex && modeA.dirX && modeA.dirY &&
-    modeA.radialAccel && modeA.tangentialAccel && modeB.angle && modeB.degreesPerSecond &&
-    modeB.deltaRadius && modeB.radius;
+    return true;
 }
 
 void ParticleData::release()
 {
-    CC_SAFE_FREE(posx);
-    CC_SAFE_FREE(posy);
-    CC_SAFE_FREE(startPosX);
-    CC_SAFE_FREE(startPosY);
-    CC_SAFE_FREE(colorR);
-    CC_SAFE_FREE(colorG);
-    CC_SAFE_FREE(colorB);
-    CC_SAFE_FREE(colorA);
-    CC_SAFE_FREE(deltaColorR);
-    CC_SAFE_FREE(deltaColorG);
-    CC_SAFE_FREE(deltaColorB);
-    CC_SAFE_FREE(deltaColorA);
-    CC_SAFE_FREE(size);
-    CC_SAFE_FREE(deltaSize);
-    CC_SAFE_FREE(rotation);
-    CC_SAFE_FREE(deltaRotation);
-    CC_SAFE_FREE(timeToLive);
-    CC_SAFE_FREE(atlasIndex);
-    
-    CC_SAFE_FREE(modeA.dirX);
-    CC_SAFE_FREE(modeA.dirY);
-    CC_SAFE_FREE(modeA.radialAccel);
-    CC_SAFE_FREE(modeA.tangentialAccel);
-    
-    CC_SAFE_FREE(modeB.angle);
-    CC_SAFE_FREE(modeB.degreesPerSecond);
-    CC_SAFE_FREE(modeB.deltaRadius);
-    CC_SAFE_FREE(modeB.radius);
+    if (_arena)
+    {
+        recycleArena(_arena, _arenaSize);
+    }
+    memset(this, 0, sizeof(ParticleData));
+}
+
+bool ParticleData::setModeArrays(int newModeArrays)
+{
+    if (newModeArrays == modeArrays)
+        return true;
+
+    ParticleData data;
+    if (!data.init(maxCount, newModeArrays))
+        return false;
+
+    // the common arrays come first and have the same layout in both blocks
+    const size_t commonSize = getStride(maxCount) * PARTICLE_DATA_COMMON_ARRAYS * sizeof(float);
+    memcpy(data._arena, _arena, commonSize);
+    memset((char*)data._arena + commonSize, 0, data._arenaSize - commonSize);
+
+    release();
+    *this = data;
+    return true;
+}
+
+int ParticleData::compact(int count)
+{
+    // first pass: indices of the living particles, branchless so that it vectorizes
+    int alive = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        survivors[alive] = i;
+        alive += (timeToLive[i] > 0.0f);
+    }
+    if (alive == count)
+        return count;
+
+    // the particles before the first dead one don't move
+    int first = 0;
+    while (first < alive && survivors[first] == first)
+        ++first;
+
+    // second pass: survivors[i] >= i, so each array can be compacted in place
+    const int* src = survivors;
+    auto compactArray = [src, first, alive](float* array) {
+        for (int i = first; i < alive; ++i)
+        {
+            array[i] = array[src[i]];
+        }
+    };
+
+    compactArray(posx);
+    compactArray(posy);
+    compactArray(startPosX);
+    compactArray(startPosY);
+    compactArray(colorR);
+    compactArray(colorG);
+    compactArray(colorB);
+    compactArray(colorA);
+    compactArray(deltaColorR);
+    compactArray(deltaColorG);
+    compactArray(deltaColorB);
+    compactArray(deltaColorA);
+    compactArray(size);
+    compactArray(deltaSize);
+    compactArray(rotation);
+    compactArray(deltaRotation);
+    compactArray(timeToLive);
+
+    if (modeArrays & MODE_A)
+    {
+        compactArray(modeA.dirX);
+        compactArray(modeA.dirY);
+        compactArray(modeA.radialAccel);
+        compactArray(modeA.tangentialAccel);
+    }
+
+    if (modeArrays & MODE_B)
+    {
+        compactArray(modeB.angle);
+        compactArray(modeB.degreesPerSecond);
+        compactArray(modeB.radius);
+        compactArray(modeB.deltaRadius);
+    }
+
+    return alive;
+}
+
+void ParticleData::setArenaPoolCapacity(size_t bytes)
+{
+    s_arenaPoolCapacity = bytes;
+    // drop the biggest blocks first
+    while (s_arenaPoolSize > s_arenaPoolCapacity)
+    {
+        auto iter = std::prev(s_arenaPool.end());
+        s_arenaPoolSize -= iter->first;
+        freeArena(iter->second);
+        s_arenaPool.erase(iter);
+    }
+}
+
+void ParticleData::purgeArenaPool()
+{
+    for (auto& entry : s_arenaPool)
+    {
+        freeArena(entry.second);
+    }
+    s_arenaPool.clear();
+    s_arenaPoolSize = 0;
 }
 
 Vector<ParticleSystem*> ParticleSystem::__allInstances;
+Vector<ParticleSystem*> ParticleSystem::__pendingUpdates;
+bool ParticleSystem::__parallelUpdateEnabled = false;
 float ParticleSystem::__totalParticleCountFactor = 1.0f;
+static EventListenerCustom* s_afterUpdateListener = nullptr;
 
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
@@ -199,6 +381,8 @@ ParticleSystem::ParticleSystem()
 , _batchNode(nullptr)
 , _atlasIndex(0)
 , _transformSystemDirty(false)
+, _pendingDt(0)
+, _updatePending(false)
 , _allocatedParticles(0)
 , _isActive(true)
 , _particleCount(0)
@@ -226,6 +410,16 @@ ParticleSystem::ParticleSystem()
 , _positionType(PositionType::FREE)
 , _paused(false)
 , _sourcePositionCompatible(true) // In the furture this member's default value maybe false or be removed.
+, _parallelThreshold(4 * PARTICLE_CHUNK_SIZE)
+, _offscreenCulling(true)
+, _offscreen(false)
+, _offscreenFrame(0)
+, _quadsDirty(false)
+, _offscreenUpdateInterval(0)
+, _offscreenDt(0)
+, _budgetPriority(BudgetPriority::NORMAL)
+, _random((static_cast<uint64_t>(rand()) << 32) ^ static_cast<uint64_t>(rand()))
+, _spawnedParticles(0)
 {
     modeA.gravity.setZero();
     modeA.speed = 0;
@@ -279,6 +473,85 @@ void ParticleSystem::setTotalParticleCountFactor(float factor)
     __totalParticleCountFactor = factor;
 }
 
+void ParticleSystem::setParallelUpdateEnabled(bool enabled)
+{
+    if (enabled == __parallelUpdateEnabled)
+        return;
+
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    if (enabled)
+    {
+        // the scheduler has updated every node, and so emitted the new particles, when this is dispatched
+        s_afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [](EventCustom*) {
+            ParticleSystem::flushPendingUpdates();
+        });
+    }
+    else
+    {
+        flushPendingUpdates();
+        dispatcher->removeEventListener(s_afterUpdateListener);
+        s_afterUpdateListener = nullptr;
+    }
+    __parallelUpdateEnabled = enabled;
+}
+
+bool ParticleSystem::isParallelUpdateEnabled()
+{
+    return __parallelUpdateEnabled;
+}
+
+void ParticleSystem::resetParallelUpdate()
+{
+    for (auto system : __pendingUpdates)
+    {
+        system->_updatePending = false;
+        system->_pendingDt = 0;
+    }
+    __pendingUpdates.clear();
+    // already released by EventDispatcher::removeAllEventListeners()
+    s_afterUpdateListener = nullptr;
+    __parallelUpdateEnabled = false;
+}
+
+void ParticleSystem::flushPendingUpdates()
+{
+    if (__pendingUpdates.empty())
+        return;
+
+    // also keeps alive the systems removed from the scene by finishStep()
+    Vector<ParticleSystem*> systems(std::move(__pendingUpdates));
+    std::vector<char> alive(systems.size());
+
+    // big systems are split in chunks that use all the workers, parallelFor can't be nested
+    std::vector<int> others;
+    for (ssize_t i = 0, size = systems.size(); i < size; ++i)
+    {
+        ParticleSystem* system = systems.at(i);
+        if (system->_particleCount >= system->_parallelThreshold)
+        {
+            alive[i] = system->simulateStep(system->_pendingDt);
+        }
+        else
+        {
+            others.push_back(static_cast<int>(i));
+        }
+    }
+
+    JobSystem::getInstance()->parallelFor(static_cast<int>(others.size()), [&systems, &others, &alive](int i) {
+        ParticleSystem* system = systems.at(others[i]);
+        alive[others[i]] = system->simulateStep(system->_pendingDt);
+    });
+
+    // removing children and uploading buffers have to be done on the main thread
+    for (ssize_t i = 0, size = systems.size(); i < size; ++i)
+    {
+        ParticleSystem* system = systems.at(i);
+        system->_updatePending = false;
+        system->_pendingDt = 0;
+        system->finishStep(alive[i] != 0);
+    }
+}
+
 bool ParticleSystem::init()
 {
     return initWithTotalParticles(150);
@@ -288,6 +561,10 @@ bool ParticleSystem::initWithFile(const std::string& plistFile)
 {
     bool ret = false;
     _plistFile = FileUtils::getInstance()->fullPathForFilename(plistFile);
+    if (ParticleBinary::isBinaryFile(plistFile))
+    {
+        return initWithBinaryFile(plistFile);
+    }
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(_plistFile);
 
     CCASSERT( !dict.empty(), "Particles: file not found");
@@ -307,6 +584,26 @@ bool ParticleSystem::initWithFile(const std::string& plistFile)
     return ret;
 }
 
+bool ParticleSystem::initWithBinaryFile(const std::string& filename)
+{
+    MappedFile file;
+    if (!file.open(_plistFile))
+    {
+        CCASSERT(false, "Particles: file not found");
+        return false;
+    }
+
+    string dirname;
+    if (filename.find('/') != string::npos)
+    {
+        dirname = filename.substr(0, filename.rfind('/') + 1);
+    }
+
+    ParticleConfig config = ParticleConfig();
+    return ParticleBinary::readConfig(file.getBytes(), file.getSize(), _plistFile, dirname, !_batchNode, config)
+        && initWithConfig(config);
+}
+
 bool ParticleSystem::initWithDictionary(ValueMap& dictionary)
 {
     return initWithDictionary(dictionary, "");
@@ -314,240 +611,352 @@ bool ParticleSystem::initWithDictionary(ValueMap& dictionary)
 
 bool ParticleSystem::initWithDictionary(ValueMap& dictionary, const std::string& dirname)
 {
-    bool ret = false;
-    unsigned char *buffer = nullptr;
-    unsigned char *deflated = nullptr;
     CC_SAFE_RELEASE(_image);
-    do 
+    _textureImageData.clear();
+
+    // Emitter name in particle designer 2.0
+    _configName = dictionary["configName"].asString();
+
+    ParticleConfig config = ParticleConfig();
+    if (!readConfig(dictionary, dirname, !_batchNode, config, &_textureImageData))
     {
-        int maxParticles = dictionary["maxParticles"].asInt();
-        // self, not super
-        if(this->initWithTotalParticles(maxParticles))
+        return false;
+    }
+    return initWithConfig(config);
+}
+
+bool ParticleSystem::initWithConfig(const ParticleConfig& config)
+{
+    // self, not super
+    if (!this->initWithTotalParticles(config.maxParticles))
+    {
+        return false;
+    }
+
+    _angle = config.angle;
+    _angleVar = config.angleVar;
+    _duration = config.duration;
+    _blendFunc = config.blendFunc;
+
+    _startColor = config.startColor;
+    _startColorVar = config.startColorVar;
+    _endColor = config.endColor;
+    _endColorVar = config.endColorVar;
+
+    _startSize = config.startSize;
+    _startSizeVar = config.startSizeVar;
+    _endSize = config.endSize;
+    _endSizeVar = config.endSizeVar;
+
+    if (!_sourcePositionCompatible)
+    {
+        this->setSourcePosition(config.sourcePosition);
+    }
+    else
+    {
+        this->setPosition(config.sourcePosition);
+    }
+    _posVar = config.posVar;
+
+    _startSpin = config.startSpin;
+    _startSpinVar = config.startSpinVar;
+    _endSpin = config.endSpin;
+    _endSpinVar = config.endSpinVar;
+
+    setEmitterMode(config.emitterMode);
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        modeA.gravity = config.gravity;
+        modeA.speed = config.speed;
+        modeA.speedVar = config.speedVar;
+        modeA.radialAccel = config.radialAccel;
+        modeA.radialAccelVar = config.radialAccelVar;
+        modeA.tangentialAccel = config.tangentialAccel;
+        modeA.tangentialAccelVar = config.tangentialAccelVar;
+        modeA.rotationIsDir = config.rotationIsDir;
+    }
+    else
+    {
+        modeB.startRadius = config.startRadius;
+        modeB.startRadiusVar = config.startRadiusVar;
+        modeB.endRadius = config.endRadius;
+        modeB.endRadiusVar = config.endRadiusVar;
+        modeB.rotatePerSecond = config.rotatePerSecond;
+        modeB.rotatePerSecondVar = config.rotatePerSecondVar;
+    }
+
+    _life = config.life;
+    _lifeVar = config.lifeVar;
+
+    // emission Rate
+    _emissionRate = _totalParticles / _life;
+
+    //don't get the internal texture if a batchNode is used
+    if (!_batchNode)
+    {
+        // Set a compatible default for the alpha transfer
+        _opacityModifyRGB = false;
+
+        if (config.texture)
         {
-            // Emitter name in particle designer 2.0
-            _configName = dictionary["configName"].asString();
+            setTexture(config.texture);
+        }
+        _yCoordFlipped = config.yCoordFlipped;
 
-            // angle
-            _angle = dictionary["angle"].asFloat();
-            _angleVar = dictionary["angleVariance"].asFloat();
+        if( !this->_texture)
+            CCLOGWARN("cocos2d: Warning: ParticleSystemQuad system without a texture");
+    }
+    return true;
+}
 
-            // duration
-            _duration = dictionary["duration"].asFloat();
+bool ParticleSystem::readConfig(ValueMap& dictionary, const std::string& dirname, bool loadTexture,
+                                ParticleConfig& config, std::string* textureImageData)
+{
+    config.maxParticles = dictionary["maxParticles"].asInt();
 
-            // blend function 
-            if (!_configName.empty())
-            {
-                _blendFunc.src = dictionary["blendFuncSource"].asFloat();
-            }
-            else
-            {
-                _blendFunc.src = dictionary["blendFuncSource"].asInt();
-            }
-            _blendFunc.dst = dictionary["blendFuncDestination"].asInt();
-
-            // color
-            _startColor.r = dictionary["startColorRed"].asFloat();
-            _startColor.g = dictionary["startColorGreen"].asFloat();
-            _startColor.b = dictionary["startColorBlue"].asFloat();
-            _startColor.a = dictionary["startColorAlpha"].asFloat();
-
-            _startColorVar.r = dictionary["startColorVarianceRed"].asFloat();
-            _startColorVar.g = dictionary["startColorVarianceGreen"].asFloat();
-            _startColorVar.b = dictionary["startColorVarianceBlue"].asFloat();
-            _startColorVar.a = dictionary["startColorVarianceAlpha"].asFloat();
-
-            _endColor.r = dictionary["finishColorRed"].asFloat();
-            _endColor.g = dictionary["finishColorGreen"].asFloat();
-            _endColor.b = dictionary["finishColorBlue"].asFloat();
-            _endColor.a = dictionary["finishColorAlpha"].asFloat();
-
-            _endColorVar.r = dictionary["finishColorVarianceRed"].asFloat();
-            _endColorVar.g = dictionary["finishColorVarianceGreen"].asFloat();
-            _endColorVar.b = dictionary["finishColorVarianceBlue"].asFloat();
-            _endColorVar.a = dictionary["finishColorVarianceAlpha"].asFloat();
-
-            // particle size
-            _startSize = dictionary["startParticleSize"].asFloat();
-            _startSizeVar = dictionary["startParticleSizeVariance"].asFloat();
-            _endSize = dictionary["finishParticleSize"].asFloat();
-            _endSizeVar = dictionary["finishParticleSizeVariance"].asFloat();
-
-            // position
-            float x = dictionary["sourcePositionx"].asFloat();
-            float y = dictionary["sourcePositiony"].asFloat();
-	    if(!_sourcePositionCompatible) {
-                this->setSourcePosition(Vec2(x, y));
-	    }
-            else {
-		this->setPosition(Vec2(x, y));
-	    }
-            _posVar.x = dictionary["sourcePositionVariancex"].asFloat();
-            _posVar.y = dictionary["sourcePositionVariancey"].asFloat();
-
-            // Spinning
-            _startSpin = dictionary["rotationStart"].asFloat();
-            _startSpinVar = dictionary["rotationStartVariance"].asFloat();
-            _endSpin= dictionary["rotationEnd"].asFloat();
-            _endSpinVar= dictionary["rotationEndVariance"].asFloat();
-
-            _emitterMode = (Mode) dictionary["emitterType"].asInt();
-
-            // Mode A: Gravity + tangential accel + radial accel
-            if (_emitterMode == Mode::GRAVITY)
-            {
-                // gravity
-                modeA.gravity.x = dictionary["gravityx"].asFloat();
-                modeA.gravity.y = dictionary["gravityy"].asFloat();
-
-                // speed
-                modeA.speed = dictionary["speed"].asFloat();
-                modeA.speedVar = dictionary["speedVariance"].asFloat();
-
-                // radial acceleration
-                modeA.radialAccel = dictionary["radialAcceleration"].asFloat();
-                modeA.radialAccelVar = dictionary["radialAccelVariance"].asFloat();
-
-                // tangential acceleration
-                modeA.tangentialAccel = dictionary["tangentialAcceleration"].asFloat();
-                modeA.tangentialAccelVar = dictionary["tangentialAccelVariance"].asFloat();
-                
-                // rotation is dir
-                modeA.rotationIsDir = dictionary["rotationIsDir"].asBool();
-            }
+    // Emitter name in particle designer 2.0
+    bool designer2 = !dictionary["configName"].asString().empty();
 
-            // or Mode B: radius movement
-            else if (_emitterMode == Mode::RADIUS)
-            {
-                if (!_configName.empty())
-                {
-                    modeB.startRadius = dictionary["maxRadius"].asInt();
-                }
-                else
-                {
-                    modeB.startRadius = dictionary["maxRadius"].asFloat();
-                }
-                modeB.startRadiusVar = dictionary["maxRadiusVariance"].asFloat();
-                if (!_configName.empty())
-                {
-                    modeB.endRadius = dictionary["minRadius"].asInt();
-                }
-                else
-                {
-                    modeB.endRadius = dictionary["minRadius"].asFloat();
-                }
-                
-                if (dictionary.find("minRadiusVariance") != dictionary.end())
-                {
-                    modeB.endRadiusVar = dictionary["minRadiusVariance"].asFloat();
-                }
-                else
-                {
-                    modeB.endRadiusVar = 0.0f;
-                }
-                
-                if (!_configName.empty())
-                {
-                    modeB.rotatePerSecond = dictionary["rotatePerSecond"].asInt();
-                }
-                else
-                {
-                    modeB.rotatePerSecond = dictionary["rotatePerSecond"].asFloat();
-                }
-                modeB.rotatePerSecondVar = dictionary["rotatePerSecondVariance"].asFloat();
+    // angle
+    config.angle = dictionary["angle"].asFloat();
+    config.angleVar = dictionary["angleVariance"].asFloat();
 
-            } else {
-                CCASSERT( false, "Invalid emitterType in config file");
-                CC_BREAK_IF(true);
-            }
+    // duration
+    config.duration = dictionary["duration"].asFloat();
 
-            // life span
-            _life = dictionary["particleLifespan"].asFloat();
-            _lifeVar = dictionary["particleLifespanVariance"].asFloat();
+    // blend function 
+    if (designer2)
+    {
+        config.blendFunc.src = dictionary["blendFuncSource"].asFloat();
+    }
+    else
+    {
+        config.blendFunc.src = dictionary["blendFuncSource"].asInt();
+    }
+    config.blendFunc.dst = dictionary["blendFuncDestination"].asInt();
+
+    // color
+    config.startColor.r = dictionary["startColorRed"].asFloat();
+    config.startColor.g = dictionary["startColorGreen"].asFloat();
+    config.startColor.b = dictionary["startColorBlue"].asFloat();
+    config.startColor.a = dictionary["startColorAlpha"].asFloat();
+
+    config.startColorVar.r = dictionary["startColorVarianceRed"].asFloat();
+    config.startColorVar.g = dictionary["startColorVarianceGreen"].asFloat();
+    config.startColorVar.b = dictionary["startColorVarianceBlue"].asFloat();
+    config.startColorVar.a = dictionary["startColorVarianceAlpha"].asFloat();
+
+    config.endColor.r = dictionary["finishColorRed"].asFloat();
+    config.endColor.g = dictionary["finishColorGreen"].asFloat();
+    config.endColor.b = dictionary["finishColorBlue"].asFloat();
+    config.endColor.a = dictionary["finishColorAlpha"].asFloat();
+
+    config.endColorVar.r = dictionary["finishColorVarianceRed"].asFloat();
+    config.endColorVar.g = dictionary["finishColorVarianceGreen"].asFloat();
+    config.endColorVar.b = dictionary["finishColorVarianceBlue"].asFloat();
+    config.endColorVar.a = dictionary["finishColorVarianceAlpha"].asFloat();
+
+    // particle size
+    config.startSize = dictionary["startParticleSize"].asFloat();
+    config.startSizeVar = dictionary["startParticleSizeVariance"].asFloat();
+    config.endSize = dictionary["finishParticleSize"].asFloat();
+    config.endSizeVar = dictionary["finishParticleSizeVariance"].asFloat();
+
+    // position
+    config.sourcePosition.x = dictionary["sourcePositionx"].asFloat();
+    config.sourcePosition.y = dictionary["sourcePositiony"].asFloat();
+    config.posVar.x = dictionary["sourcePositionVariancex"].asFloat();
+    config.posVar.y = dictionary["sourcePositionVariancey"].asFloat();
+
+    // Spinning
+    config.startSpin = dictionary["rotationStart"].asFloat();
+    config.startSpinVar = dictionary["rotationStartVariance"].asFloat();
+    config.endSpin = dictionary["rotationEnd"].asFloat();
+    config.endSpinVar = dictionary["rotationEndVariance"].asFloat();
 
-            // emission Rate
-            _emissionRate = _totalParticles / _life;
+    config.emitterMode = (Mode) dictionary["emitterType"].asInt();
 
-            //don't get the internal texture if a batchNode is used
-            if (!_batchNode)
+    // Mode A: Gravity + tangential accel + radial accel
+    if (config.emitterMode == Mode::GRAVITY)
+    {
+        // gravity
+        config.gravity.x = dictionary["gravityx"].asFloat();
+        config.gravity.y = dictionary["gravityy"].asFloat();
+
+        // speed
+        config.speed = dictionary["speed"].asFloat();
+        config.speedVar = dictionary["speedVariance"].asFloat();
+
+        // radial acceleration
+        config.radialAccel = dictionary["radialAcceleration"].asFloat();
+        config.radialAccelVar = dictionary["radialAccelVariance"].asFloat();
+
+        // tangential acceleration
+        config.tangentialAccel = dictionary["tangentialAcceleration"].asFloat();
+        config.tangentialAccelVar = dictionary["tangentialAccelVariance"].asFloat();
+
+        // rotation is dir
+        config.rotationIsDir = dictionary["rotationIsDir"].asBool();
+    }
+
+    // or Mode B: radius movement
+    else if (config.emitterMode == Mode::RADIUS)
+    {
+        if (designer2)
+        {
+            config.startRadius = dictionary["maxRadius"].asInt();
+        }
+        else
+        {
+            config.startRadius = dictionary["maxRadius"].asFloat();
+        }
+        config.startRadiusVar = dictionary["maxRadiusVariance"].asFloat();
+        if (designer2)
+        {
+            config.endRadius = dictionary["minRadius"].asInt();
+        }
+        else
+        {
+            config.endRadius = dictionary["minRadius"].asFloat();
+        }
+
+        if (dictionary.find("minRadiusVariance") != dictionary.end())
+        {
+            config.endRadiusVar = dictionary["minRadiusVariance"].asFloat();
+        }
+        else
+        {
+            config.endRadiusVar = 0.0f;
+        }
+
+        if (designer2)
+        {
+            config.rotatePerSecond = dictionary["rotatePerSecond"].asInt();
+        }
+        else
+        {
+            config.rotatePerSecond = dictionary["rotatePerSecond"].asFloat();
+        }
+        config.rotatePerSecondVar = dictionary["rotatePerSecondVariance"].asFloat();
+
+    } else {
+        CCASSERT( false, "Invalid emitterType in config file");
+        return false;
+    }
+
+    // life span
+    config.life = dictionary["particleLifespan"].asFloat();
+    config.lifeVar = dictionary["particleLifespanVariance"].asFloat();
+
+    config.yCoordFlipped = dictionary.find("yCoordFlipped") == dictionary.end() ? 1 : dictionary.at("yCoordFlipped").asInt();
+
+    config.texture = nullptr;
+    if (!loadTexture)
+    {
+        return true;
+    }
+
+    // texture        
+    // Try to get the texture from the cache
+    std::string textureName = dictionary["textureFileName"].asString();
+
+    size_t rPos = textureName.rfind('/');
+
+    if (rPos != string::npos)
+    {
+        string textureDir = textureName.substr(0, rPos + 1);
+
+        if (!dirname.empty() && textureDir != dirname)
+        {
+            textureName = textureName.substr(rPos+1);
+            textureName = dirname + textureName;
+        }
+    }
+    else if (!dirname.empty() && !textureName.empty())
+    {
+        textureName = dirname + textureName;
+    }
+
+    Texture2D *tex = nullptr;
+
+    if (!textureName.empty())
+    {
+        // set not pop-up message box when load image failed
+        bool notify = FileUtils::getInstance()->isPopupNotify();
+        FileUtils::getInstance()->setPopupNotify(false);
+        tex = Director::getInstance()->getTextureCache()->addImage(textureName);
+        // reset the value of UIImage notify
+        FileUtils::getInstance()->setPopupNotify(notify);
+    }
+
+    if (!tex && dictionary.find("textureImageData") != dictionary.end())
+    {
+        std::string textureData = dictionary.at("textureImageData").asString();
+        CCASSERT(!textureData.empty(), "textureData can't be empty!");
+
+        auto dataLen = textureData.size();
+        if (dataLen != 0)
+        {
+            // key by content, so every emitter of a plist, or of plists embedding the same image,
+            // finds the texture without decoding it again
+            std::string key = StringUtils::format("textureImageData:%08x:%u",
+                                                  XXH32(textureData.c_str(), (int)dataLen, 0), (unsigned int)dataLen);
+            auto textureCache = Director::getInstance()->getTextureCache();
+            tex = textureCache->getTextureForKey(key);
+            if (!tex)
             {
-                // Set a compatible default for the alpha transfer
-                _opacityModifyRGB = false;
-
-                // texture        
-                // Try to get the texture from the cache
-                std::string textureName = dictionary["textureFileName"].asString();
-                
-                size_t rPos = textureName.rfind('/');
-               
-                if (rPos != string::npos)
+                // For android, it is retained in VolatileTexture::addImage which invoked in TextureCache::addImage()
+                Image* image = decodeTextureImageData(textureData);
+                CCASSERT(image, "CCParticleSystem: error decoding textureImageData");
+                if (!image)
                 {
-                    string textureDir = textureName.substr(0, rPos + 1);
-                    
-                    if (!dirname.empty() && textureDir != dirname)
-                    {
-                        textureName = textureName.substr(rPos+1);
-                        textureName = dirname + textureName;
-                    }
-                }
-                else if (!dirname.empty() && !textureName.empty())
-                {
-                	textureName = dirname + textureName;
-                }
-                
-                Texture2D *tex = nullptr;
-                
-                if (!textureName.empty())
-                {
-                    // set not pop-up message box when load image failed
-                    bool notify = FileUtils::getInstance()->isPopupNotify();
-                    FileUtils::getInstance()->setPopupNotify(false);
-                    tex = Director::getInstance()->getTextureCache()->addImage(textureName);
-                    // reset the value of UIImage notify
-                    FileUtils::getInstance()->setPopupNotify(notify);
-                }
-                
-                if (tex)
-                {
-                    setTexture(tex);
-                }
-                else if( dictionary.find("textureImageData") != dictionary.end() )
-                {                        
-                    std::string textureData = dictionary.at("textureImageData").asString();
-                    CCASSERT(!textureData.empty(), "textureData can't be empty!");
-                    
-                    auto dataLen = textureData.size();
-                    if (dataLen != 0)
-                    {
-                        // if it fails, try to get it from the base64-gzipped data    
-                        int decodeLen = base64Decode((unsigned char*)textureData.c_str(), (unsigned int)dataLen, &buffer);
-                        CCASSERT( buffer != nullptr, "CCParticleSystem: error decoding textureImageData");
-                        CC_BREAK_IF(!buffer);
-                        
-                        ssize_t deflatedLen = ZipUtils::inflateMemory(buffer, decodeLen, &deflated);
-                        CCASSERT( deflated != nullptr, "CCParticleSystem: error ungzipping textureImageData");
-                        CC_BREAK_IF(!deflated);
-                        
-                        // For android, we should retain it in VolatileTexture::addImage which invoked in Director::getInstance()->getTextureCache()->addUIImage()
-                        _image = new (std::nothrow) Image();
-                        bool isOK = _image->initWithImageData(deflated, deflatedLen);
-                        CCASSERT(isOK, "CCParticleSystem: error init image with Data");
-                        CC_BREAK_IF(!isOK);
-                        
-                        setTexture(Director::getInstance()->getTextureCache()->addImage(_image, _plistFile + textureName));
-                    }
+                    return false;
                 }
-                
-                _yCoordFlipped = dictionary.find("yCoordFlipped") == dictionary.end() ? 1 : dictionary.at("yCoordFlipped").asInt();
 
-                if( !this->_texture)
-                    CCLOGWARN("cocos2d: Warning: ParticleSystemQuad system without a texture");
+                tex = textureCache->addImage(image, key);
+                image->release();
+            }
+
+            // decoded again only if someone asks for the image
+            if (textureImageData)
+            {
+                *textureImageData = std::move(textureData);
             }
-            ret = true;
         }
-    } while (0);
-    free(buffer);
+    }
+    config.texture = tex;
+    return true;
+}
+
+Image* ParticleSystem::decodeTextureImageData(const std::string& textureData)
+{
+    // base64 and inflate in one pass, the image then decodes into its own pixel buffer
+    unsigned char *deflated = nullptr;
+    ssize_t deflatedLen = ZipUtils::inflateBase64Memory(textureData.c_str(), (ssize_t)textureData.size(), &deflated);
+    if (!deflated)
+    {
+        CCLOG("cocos2d: ParticleSystem: error ungzipping textureImageData");
+        return nullptr;
+    }
+
+    Image* image = new (std::nothrow) Image();
+    bool isOK = image && image->initWithImageData(deflated, deflatedLen);
     free(deflated);
-    return ret;
+    if (!isOK)
+    {
+        CCLOG("cocos2d: ParticleSystem: error init image with Data");
+        CC_SAFE_RELEASE(image);
+    }
+    return image;
+}
+
+Image* ParticleSystem::getImage() const
+{
+    if (!_image && !_textureImageData.empty())
+    {
+        _image = decodeTextureImageData(_textureImageData);
+    }
+    return _image;
 }
 
 bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
@@ -556,7 +965,8 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
     
     _particleData.release();
 
-    if( !_particleData.init(_totalParticles) )
+    // the emitter starts in gravity mode, see setEmitterMode
+    if( !_particleData.init(_totalParticles, ParticleData::MODE_A) )
     {
         CCLOG("Particle system: not enough memory");
         this->release();
@@ -612,48 +1022,80 @@ void ParticleSystem::addParticles(int count)
 {
     if (_paused)
         return;
-    uint32_t RANDSEED = rand();
 
     int start = _particleCount;
     _particleCount += count;
+    uint64_t serial = _spawnedParticles;
+    _spawnedParticles += count;
     
+    Vec2 pos;
+    if (_positionType == PositionType::FREE)
+    {
+        pos = this->convertToWorldSpace(Vec2::ZERO);
+    }
+    else if (_positionType == PositionType::RELATIVE)
+    {
+        pos = _position;
+    }
+
+    // the random numbers of a particle only depend on the seed and its serial number,
+    // so the particles don't depend on how the chunks are run
+    runChunks(start, count, [this, start, serial, &pos](int /*chunk*/, int chunkStart, int chunkCount) {
+        spawnParticles(chunkStart, chunkCount, serial + (chunkStart - start), pos);
+    });
+}
+
+void ParticleSystem::spawnParticles(int start, int count, uint64_t serial, const Vec2& startPos)
+{
+    CCASSERT(count <= PARTICLE_CHUNK_SIZE, "spawnParticles: too many particles");
+    int end = start + count;
+
+    // random numbers between -1 and 1 for the particles [start, end) in random[0, count)
+    float random[PARTICLE_CHUNK_SIZE];
+    float random2[PARTICLE_CHUNK_SIZE];
+#define FILL_RANDOM(buffer, stream) _random.fillMinus1_1(stream, serial, count, buffer)
+
     //life
-    for (int i = start; i < _particleCount ; ++i)
+    FILL_RANDOM(random, SPAWN_STREAM_LIFE);
+    for (int i = start; i < end; ++i)
     {
-        float theLife = _life + _lifeVar * RANDOM_M11(&RANDSEED);
+        float theLife = _life + _lifeVar * random[i - start];
         _particleData.timeToLive[i] = MAX(0, theLife);
     }
     
     //position
-    for (int i = start; i < _particleCount; ++i)
+    FILL_RANDOM(random, SPAWN_STREAM_POS_X);
+    for (int i = start; i < end; ++i)
     {
-        _particleData.posx[i] = _sourcePosition.x + _posVar.x * RANDOM_M11(&RANDSEED);
+        _particleData.posx[i] = _sourcePosition.x + _posVar.x * random[i - start];
     }
     
-    for (int i = start; i < _particleCount; ++i)
+    FILL_RANDOM(random, SPAWN_STREAM_POS_Y);
+    for (int i = start; i < end; ++i)
     {
-        _particleData.posy[i] = _sourcePosition.y + _posVar.y * RANDOM_M11(&RANDSEED);
+        _particleData.posy[i] = _sourcePosition.y + _posVar.y * random[i - start];
     }
     
     //color
-#define SET_COLOR(c, b, v)\
-for (int i = start; i < _particleCount; ++i)\
+#define SET_COLOR(c, b, v, stream)\
+FILL_RANDOM(random, stream);\
+for (int i = start; i < end; ++i)\
 {\
-c[i] = clampf( b + v * RANDOM_M11(&RANDSEED) , 0 , 1 );\
+c[i] = clampf( b + v * random[i - start] , 0 , 1 );\
 }
     
-    SET_COLOR(_particleData.colorR, _startColor.r, _startColorVar.r);
-    SET_COLOR(_particleData.colorG, _startColor.g, _startColorVar.g);
-    SET_COLOR(_particleData.colorB, _startColor.b, _startColorVar.b);
-    SET_COLOR(_particleData.colorA, _startColor.a, _startColorVar.a);
+    SET_COLOR(_particleData.colorR, _startColor.r, _startColorVar.r, SPAWN_STREAM_COLOR_R);
+    SET_COLOR(_particleData.colorG, _startColor.g, _startColorVar.g, SPAWN_STREAM_COLOR_G);
+    SET_COLOR(_particleData.colorB, _startColor.b, _startColorVar.b, SPAWN_STREAM_COLOR_B);
+    SET_COLOR(_particleData.colorA, _startColor.a, _startColorVar.a, SPAWN_STREAM_COLOR_A);
     
-    SET_COLOR(_particleData.deltaColorR, _endColor.r, _endColorVar.r);
-    SET_COLOR(_particleData.deltaColorG, _endColor.g, _endColorVar.g);
-    SET_COLOR(_particleData.deltaColorB, _endColor.b, _endColorVar.b);
-    SET_COLOR(_particleData.deltaColorA, _endColor.a, _endColorVar.a);
+    SET_COLOR(_particleData.deltaColorR, _endColor.r, _endColorVar.r, SPAWN_STREAM_END_COLOR_R);
+    SET_COLOR(_particleData.deltaColorG, _endColor.g, _endColorVar.g, SPAWN_STREAM_END_COLOR_G);
+    SET_COLOR(_particleData.deltaColorB, _endColor.b, _endColorVar.b, SPAWN_STREAM_END_COLOR_B);
+    SET_COLOR(_particleData.deltaColorA, _endColor.a, _endColorVar.a, SPAWN_STREAM_END_COLOR_A);
     
 #define SET_DELTA_COLOR(c, dc)\
-for (int i = start; i < _particleCount; ++i)\
+for (int i = start; i < end; ++i)\
 {\
 dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
 }
@@ -664,57 +1106,52 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
     SET_DELTA_COLOR(_particleData.colorA, _particleData.deltaColorA);
     
     //size
-    for (int i = start; i < _particleCount; ++i)
+    FILL_RANDOM(random, SPAWN_STREAM_SIZE);
+    for (int i = start; i < end; ++i)
     {
-        _particleData.size[i] = _startSize + _startSizeVar * RANDOM_M11(&RANDSEED);
+        _particleData.size[i] = _startSize + _startSizeVar * random[i - start];
         _particleData.size[i] = MAX(0, _particleData.size[i]);
     }
     
     if (_endSize != START_SIZE_EQUAL_TO_END_SIZE)
     {
-        for (int i = start; i < _particleCount; ++i)
+        FILL_RANDOM(random, SPAWN_STREAM_END_SIZE);
+        for (int i = start; i < end; ++i)
         {
-            float endSize = _endSize + _endSizeVar * RANDOM_M11(&RANDSEED);
+            float endSize = _endSize + _endSizeVar * random[i - start];
             endSize = MAX(0, endSize);
             _particleData.deltaSize[i] = (endSize - _particleData.size[i]) / _particleData.timeToLive[i];
         }
     }
     else
     {
-        for (int i = start; i < _particleCount; ++i)
+        for (int i = start; i < end; ++i)
         {
             _particleData.deltaSize[i] = 0.0f;
         }
     }
     
     // rotation
-    for (int i = start; i < _particleCount; ++i)
+    FILL_RANDOM(random, SPAWN_STREAM_SPIN);
+    for (int i = start; i < end; ++i)
     {
-        _particleData.rotation[i] = _startSpin + _startSpinVar * RANDOM_M11(&RANDSEED);
+        _particleData.rotation[i] = _startSpin + _startSpinVar * random[i - start];
     }
-    for (int i = start; i < _particleCount; ++i)
+    FILL_RANDOM(random, SPAWN_STREAM_END_SPIN);
+    for (int i = start; i < end; ++i)
     {
-        float endA = _endSpin + _endSpinVar * RANDOM_M11(&RANDSEED);
+        float endA = _endSpin + _endSpinVar * random[i - start];
         _particleData.deltaRotation[i] = (endA - _particleData.rotation[i]) / _particleData.timeToLive[i];
     }
     
     // position
-    Vec2 pos;
-    if (_positionType == PositionType::FREE)
+    for (int i = start; i < end; ++i)
     {
-        pos = this->convertToWorldSpace(Vec2::ZERO);
+        _particleData.startPosX[i] = startPos.x;
     }
-    else if (_positionType == PositionType::RELATIVE)
+    for (int i = start; i < end; ++i)
     {
-        pos = _position;
-    }
-    for (int i = start; i < _particleCount; ++i)
-    {
-        _particleData.startPosX[i] = pos.x;
-    }
-    for (int i = start; i < _particleCount; ++i)
-    {
-        _particleData.startPosY[i] = pos.y;
+        _particleData.startPosY[i] = startPos.y;
     }
     
     // Mode Gravity: A
@@ -722,25 +1159,31 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
     {
         
         // radial accel
-        for (int i = start; i < _particleCount; ++i)
+        FILL_RANDOM(random, SPAWN_STREAM_RADIAL_ACCEL);
+        for (int i = start; i < end; ++i)
         {
-            _particleData.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * RANDOM_M11(&RANDSEED);
+            _particleData.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * random[i - start];
         }
         
         // tangential accel
-        for (int i = start; i < _particleCount; ++i)
+        FILL_RANDOM(random, SPAWN_STREAM_TANGENTIAL_ACCEL);
+        for (int i = start; i < end; ++i)
         {
-            _particleData.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * RANDOM_M11(&RANDSEED);
+            _particleData.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * random[i - start];
         }
         
+        // direction: angle and speed
+        FILL_RANDOM(random, SPAWN_STREAM_ANGLE);
+        FILL_RANDOM(random2, SPAWN_STREAM_SPEED);
+        
         // rotation is dir
         if( modeA.rotationIsDir )
         {
-            for (int i = start; i < _particleCount; ++i)
+            for (int i = start; i < end; ++i)
             {
-                float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * RANDOM_M11(&RANDSEED) );
+                float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * random[i - start] );
                 Vec2 v(cosf( a ), sinf( a ));
-                float s = modeA.speed + modeA.speedVar * RANDOM_M11(&RANDSEED);
+                float s = modeA.speed + modeA.speedVar * random2[i - start];
                 Vec2 dir = v * s;
                 _particleData.modeA.dirX[i] = dir.x;//v * s ;
                 _particleData.modeA.dirY[i] = dir.y;
@@ -749,11 +1192,11 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
         }
         else
         {
-            for (int i = start; i < _particleCount; ++i)
+            for (int i = start; i < end; ++i)
             {
-                float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * RANDOM_M11(&RANDSEED) );
+                float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * random[i - start] );
                 Vec2 v(cosf( a ), sinf( a ));
-                float s = modeA.speed + modeA.speedVar * RANDOM_M11(&RANDSEED);
+                float s = modeA.speed + modeA.speedVar * random2[i - start];
                 Vec2 dir = v * s;
                 _particleData.modeA.dirX[i] = dir.x;//v * s ;
                 _particleData.modeA.dirY[i] = dir.y;
@@ -767,33 +1210,37 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
     {
         //Need to check by Jacky
         // Set the default diameter of the particle from the source position
-        for (int i = start; i < _particleCount; ++i)
+        FILL_RANDOM(random, SPAWN_STREAM_RADIUS);
+        for (int i = start; i < end; ++i)
         {
-            _particleData.modeB.radius[i] = modeB.startRadius + modeB.startRadiusVar * RANDOM_M11(&RANDSEED);
+            _particleData.modeB.radius[i] = modeB.startRadius + modeB.startRadiusVar * random[i - start];
         }
 
-        for (int i = start; i < _particleCount; ++i)
+        FILL_RANDOM(random, SPAWN_STREAM_ANGLE);
+        for (int i = start; i < end; ++i)
         {
-            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _angle + _angleVar * RANDOM_M11(&RANDSEED));
+            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _angle + _angleVar * random[i - start]);
         }
         
-        for (int i = start; i < _particleCount; ++i)
+        FILL_RANDOM(random, SPAWN_STREAM_ROTATE_PER_SECOND);
+        for (int i = start; i < end; ++i)
         {
-            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * RANDOM_M11(&RANDSEED));
+            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * random[i - start]);
         }
         
         if(modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
         {
-            for (int i = start; i < _particleCount; ++i)
+            for (int i = start; i < end; ++i)
             {
                 _particleData.modeB.deltaRadius[i] = 0.0f;
             }
         }
         else
         {
-            for (int i = start; i < _particleCount; ++i)
+            FILL_RANDOM(random, SPAWN_STREAM_END_RADIUS);
+            for (int i = start; i < end; ++i)
             {
-                float endRadius = modeB.endRadius + modeB.endRadiusVar * RANDOM_M11(&RANDSEED);
+                float endRadius = modeB.endRadius + modeB.endRadiusVar * random[i - start];
                 _particleData.modeB.deltaRadius[i] = (endRadius - _particleData.modeB.radius[i]) / _particleData.timeToLive[i];
             }
         }
@@ -855,6 +1302,17 @@ void ParticleSystem::resetSystem()
     }
 }
 
+void ParticleSystem::setEmitterMode(Mode mode)
+{
+    _emitterMode = mode;
+
+    int modeArrays = (mode == Mode::GRAVITY) ? ParticleData::MODE_A : ParticleData::MODE_B;
+    if (_particleData.maxCount > 0 && !_particleData.setModeArrays(modeArrays))
+    {
+        CCLOG("Particle system: not enough memory");
+    }
+}
+
 bool ParticleSystem::isFull()
 {
     return (_particleCount == _totalParticles);
@@ -865,10 +1323,86 @@ void ParticleSystem::update(float dt)
 {
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 
+    // an offscreen system may be simulated less often, the skipped time is caught up in one step
+    _offscreenDt += dt;
+    if (_offscreen && _offscreenDt < _offscreenUpdateInterval)
+    {
+        CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+        return;
+    }
+    dt = _offscreenDt;
+    _offscreenDt = 0;
+
+    emitStep(dt);
+    
+    // the simulation may run on a worker thread, which must not compute transforms: they are cached in the nodes
+    _nodeToWorldTransform = getNodeToWorldTransform();
+
+    if (__parallelUpdateEnabled)
+    {
+        // simulated with the other systems by flushPendingUpdates()
+        if (!_updatePending)
+        {
+            _updatePending = true;
+            __pendingUpdates.pushBack(this);
+        }
+        _pendingDt += dt;
+    }
+    else
+    {
+        finishStep(simulateStep(dt));
+    }
+
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+}
+
+void ParticleSystem::prewarm(float seconds, float fixedStep)
+{
+    CCASSERT(fixedStep > 0, "ParticleSystem::prewarm: the step must be positive");
+    if (seconds <= 0 || fixedStep <= 0)
+        return;
+
+    _nodeToWorldTransform = getNodeToWorldTransform();
+
+    // the particles emitted by a pending parallel update are simulated first, flushPendingUpdates() then has nothing left to do
+    bool alive = true;
+    if (_updatePending)
+    {
+        alive = simulateParticles(_pendingDt);
+        _pendingDt = 0;
+    }
+
+    int steps = static_cast<int>(seconds / fixedStep);
+    float lastStep = seconds - steps * fixedStep;
+    for (int i = 0; i < steps && alive; ++i)
+    {
+        emitStep(fixedStep);
+        alive = simulateParticles(fixedStep);
+    }
+    if (alive && lastStep > 0)
+    {
+        emitStep(lastStep);
+        alive = simulateParticles(lastStep);
+    }
+
+    // the quads are only needed for the last step
+    if (alive)
+    {
+        updateParticleQuads();
+        _quadsDirty = false;
+        _transformSystemDirty = false;
+    }
+    finishStep(alive);
+}
+
+void ParticleSystem::emitStep(float dt)
+{
+    ParticleBudgetManager::ScopedTimer timer(ParticleBudgetManager::Phase::SIMULATE);
+    float budgetScale = ParticleBudgetManager::getCurrentScale(_budgetPriority);
     if (_isActive && _emissionRate)
     {
-        float rate = 1.0f / _emissionRate;
-        int totalParticles = static_cast<int>(_totalParticles * __totalParticleCountFactor);
+        float rate = 1.0f / (_emissionRate * budgetScale);
+        int totalParticles = static_cast<int>(_totalParticles * __totalParticleCountFactor * budgetScale);
         
         //issue #1201, prevent bursts of particles, due to too high emitCounter
         if (_particleCount < totalParticles)
@@ -890,80 +1424,70 @@ void ParticleSystem::update(float dt)
             this->stopSystem();
         }
     }
+}
+
+bool ParticleSystem::simulateStep(float dt)
+{
+    if (!simulateParticles(dt))
+    {
+        return false;
+    }
+    if (_offscreen)
+    {
+        // generated by draw() if the system comes back into view
+        _quadsDirty = true;
+    }
+    else
+    {
+        ParticleBudgetManager::ScopedTimer timer(ParticleBudgetManager::Phase::QUADS);
+        updateParticleQuads();
+        _quadsDirty = false;
+    }
+    _transformSystemDirty = false;
+    return true;
+}
+
+bool ParticleSystem::simulateParticles(float dt)
+{
+    ParticleBudgetManager::ScopedTimer timer(ParticleBudgetManager::Phase::SIMULATE);
+    runChunks(0, _particleCount, [this, dt](int /*chunk*/, int start, int count) {
+        float* timeToLive = _particleData.timeToLive + start;
+        for (int i = 0; i < count; ++i)
+        {
+            timeToLive[i] -= dt;
+        }
+    });
     
+    int aliveCount = _particleData.compact(_particleCount);
+    if (aliveCount != _particleCount)
     {
-        for (int i = 0; i < _particleCount; ++i)
+        if (_batchNode)
         {
-            _particleData.timeToLive[i] -= dt;
+            // quads are written in particle order, hide the ones that are not written anymore
+            _batchNode->disableParticles(_atlasIndex + aliveCount, _particleCount - aliveCount);
         }
-        
-        for (int i = 0; i < _particleCount; ++i)
+        _particleCount = aliveCount;
+        if( _particleCount == 0 && _isAutoRemoveOnFinish )
         {
-            if (_particleData.timeToLive[i] <= 0.0f)
-            {
-                int j = _particleCount - 1;
-                while (j > 0 && _particleData.timeToLive[j] <= 0)
-                {
-                    _particleCount--;
-                    j--;
-                }
-                _particleData.copyParticle(i, _particleCount - 1);
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    int currentIndex = _particleData.atlasIndex[i];
-                    _batchNode->disableParticle(_atlasIndex + currentIndex);
-                    //switch indexes
-                    _particleData.atlasIndex[_particleCount - 1] = currentIndex;
-                }
-                --_particleCount;
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
+            return false;
         }
-        
+    }
+    
+    bool reduceBounds = _offscreenCulling && !_batchNode;
+    if (reduceBounds)
+    {
+        _chunkBounds.resize((_particleCount + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE);
+    }
+
+    // the chunks are small enough for all the attributes of a chunk to stay in the cache
+    runChunks(0, _particleCount, [this, dt, reduceBounds](int chunk, int start, int count) {
         if (_emitterMode == Mode::GRAVITY)
         {
-            for (int i = 0 ; i < _particleCount; ++i)
-            {
-                particle_point tmp, radial = {0.0f, 0.0f}, tangential;
-                
-                // radial acceleration
-                if (_particleData.posx[i] || _particleData.posy[i])
-                {
-                    normalize_point(_particleData.posx[i], _particleData.posy[i], &radial);
-                }
-                tangential = radial;
-                radial.x *= _particleData.modeA.radialAccel[i];
-                radial.y *= _particleData.modeA.radialAccel[i];
-                
-                // tangential acceleration
-                std::swap(tangential.x, tangential.y);
-                tangential.x *= - _particleData.modeA.tangentialAccel[i];
-                tangential.y *= _particleData.modeA.tangentialAccel[i];
-                
-                // (gravity + radial + tangential) * dt
-                tmp.x = radial.x + tangential.x + modeA.gravity.x;
-                tmp.y = radial.y + tangential.y + modeA.gravity.y;
-                tmp.x *= dt;
-                tmp.y *= dt;
-                
-                _particleData.modeA.dirX[i] += tmp.x;
-                _particleData.modeA.dirY[i] += tmp.y;
-                
-                // this is cocos2d-x v3.0
-                // if (_configName.length()>0 && _yCoordFlipped != -1)
-                
-                // this is cocos2d-x v3.0
-                tmp.x = _particleData.modeA.dirX[i] * dt * _yCoordFlipped;
-                tmp.y = _particleData.modeA.dirY[i] * dt * _yCoordFlipped;
-                _particleData.posx[i] += tmp.x;
-                _particleData.posy[i] += tmp.y;
-            }
+            // (gravity + radial + tangential) * dt, then move along the direction
+            MathUtil::updateParticlesGravityMode(_particleData.posx + start, _particleData.posy + start,
+                                                 _particleData.modeA.dirX + start, _particleData.modeA.dirY + start,
+                                                 _particleData.modeA.radialAccel + start, _particleData.modeA.tangentialAccel + start,
+                                                 modeA.gravity.x, modeA.gravity.y, dt, _yCoordFlipped, count);
         }
         else
         {
@@ -973,69 +1497,201 @@ void ParticleSystem::update(float dt)
             //And every property's memory of the particle system is continuous,
             //for the purpose of improving cache hit rate, we should process only one property in one for-loop AFAP.
             //It was proved to be effective especially for low-end machine. 
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.modeB.angle[i] += _particleData.modeB.degreesPerSecond[i] * dt;
-            }
-            
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.modeB.radius[i] += _particleData.modeB.deltaRadius[i] * dt;
-            }
-            
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
-            }
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i] * _yCoordFlipped;
-            }
+            //The SIMD kernels keep that layout and process four particles per iteration.
+            MathUtil::updateParticlesRadiusMode(_particleData.posx + start, _particleData.posy + start,
+                                                _particleData.modeB.angle + start, _particleData.modeB.degreesPerSecond + start,
+                                                _particleData.modeB.radius + start, _particleData.modeB.deltaRadius + start,
+                                                dt, _yCoordFlipped, count);
         }
-        
+    
         //color r,g,b,a
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
-        }
+        MathUtil::integrate(_particleData.colorR + start, _particleData.deltaColorR + start, dt, count);
+        MathUtil::integrate(_particleData.colorG + start, _particleData.deltaColorG + start, dt, count);
+        MathUtil::integrate(_particleData.colorB + start, _particleData.deltaColorB + start, dt, count);
+        MathUtil::integrate(_particleData.colorA + start, _particleData.deltaColorA + start, dt, count);
         //size
-        for (int i = 0 ; i < _particleCount; ++i)
+        MathUtil::integrateNonNegative(_particleData.size + start, _particleData.deltaSize + start, dt, count);
+        //angle
+        MathUtil::integrate(_particleData.rotation + start, _particleData.deltaRotation + start, dt, count);
+
+        if (reduceBounds)
         {
-            _particleData.size[i] += (_particleData.deltaSize[i] * dt);
-            _particleData.size[i] = MAX(0, _particleData.size[i]);
+            ChunkBounds& bounds = _chunkBounds[chunk];
+            bounds.minX = bounds.minY = bounds.minStartX = bounds.minStartY = FLT_MAX;
+            bounds.maxX = bounds.maxY = bounds.maxStartX = bounds.maxStartY = -FLT_MAX;
+            bounds.maxSize = 0;
+            float minSize = 0;
+            MathUtil::minMax(_particleData.posx + start, count, &bounds.minX, &bounds.maxX);
+            MathUtil::minMax(_particleData.posy + start, count, &bounds.minY, &bounds.maxY);
+            MathUtil::minMax(_particleData.startPosX + start, count, &bounds.minStartX, &bounds.maxStartX);
+            MathUtil::minMax(_particleData.startPosY + start, count, &bounds.minStartY, &bounds.maxStartY);
+            MathUtil::minMax(_particleData.size + start, count, &minSize, &bounds.maxSize);
         }
-        //angle
-        for (int i = 0 ; i < _particleCount; ++i)
+    });
+
+    if (reduceBounds)
+    {
+        updateParticleBounds();
+    }
+    return true;
+}
+
+void ParticleSystem::getParticleTransform(float* transform) const
+{
+    // the batch node draws the quads in its own space
+    Vec2 pos = _batchNode ? _position : Vec2::ZERO;
+    if (_positionType == PositionType::FREE)
+    {
+        // newPos = pos + p - (p1 - worldToNode * startPos)
+        // may run on a worker thread, use the transform captured in update() instead of convertToWorldSpace
+        Vec3 p1(_nodeToWorldTransform.m[12], _nodeToWorldTransform.m[13], 0);
+        Mat4 worldToNodeTM = _nodeToWorldTransform.getInversed();
+        worldToNodeTM.transformPoint(&p1);
+        transform[0] = worldToNodeTM.m[0];
+        transform[1] = worldToNodeTM.m[1];
+        transform[2] = worldToNodeTM.m[4];
+        transform[3] = worldToNodeTM.m[5];
+        transform[4] = worldToNodeTM.m[12] - p1.x + pos.x;
+        transform[5] = worldToNodeTM.m[13] - p1.y + pos.y;
+    }
+    else if (_positionType == PositionType::RELATIVE)
+    {
+        // newPos = pos + p - (currentPosition - startPos)
+        transform[0] = 1;
+        transform[1] = 0;
+        transform[2] = 0;
+        transform[3] = 1;
+        transform[4] = pos.x - _position.x;
+        transform[5] = pos.y - _position.y;
+    }
+    else
+    {
+        // newPos = pos + p
+        transform[0] = transform[1] = transform[2] = transform[3] = 0;
+        transform[4] = pos.x;
+        transform[5] = pos.y;
+    }
+}
+
+void ParticleSystem::updateParticleBounds()
+{
+    if (_particleCount == 0)
+    {
+        _particleBounds = Rect::ZERO;
+        return;
+    }
+
+    ChunkBounds bounds = _chunkBounds[0];
+    for (size_t i = 1, count = _chunkBounds.size(); i < count; ++i)
+    {
+        const ChunkBounds& chunk = _chunkBounds[i];
+        bounds.minX = std::min(bounds.minX, chunk.minX);
+        bounds.maxX = std::max(bounds.maxX, chunk.maxX);
+        bounds.minY = std::min(bounds.minY, chunk.minY);
+        bounds.maxY = std::max(bounds.maxY, chunk.maxY);
+        bounds.minStartX = std::min(bounds.minStartX, chunk.minStartX);
+        bounds.maxStartX = std::max(bounds.maxStartX, chunk.maxStartX);
+        bounds.minStartY = std::min(bounds.minStartY, chunk.minStartY);
+        bounds.maxStartY = std::max(bounds.maxStartY, chunk.maxStartY);
+        bounds.maxSize = std::max(bounds.maxSize, chunk.maxSize);
+    }
+
+    // the centers are pos + transform * startPos, map the box of the start positions by the linear part
+    float t[6];
+    getParticleTransform(t);
+    float minX = bounds.minX + t[4] + std::min(t[0] * bounds.minStartX, t[0] * bounds.maxStartX)
+                                    + std::min(t[2] * bounds.minStartY, t[2] * bounds.maxStartY);
+    float maxX = bounds.maxX + t[4] + std::max(t[0] * bounds.minStartX, t[0] * bounds.maxStartX)
+                                    + std::max(t[2] * bounds.minStartY, t[2] * bounds.maxStartY);
+    float minY = bounds.minY + t[5] + std::min(t[1] * bounds.minStartX, t[1] * bounds.maxStartX)
+                                    + std::min(t[3] * bounds.minStartY, t[3] * bounds.maxStartY);
+    float maxY = bounds.maxY + t[5] + std::max(t[1] * bounds.minStartX, t[1] * bounds.maxStartX)
+                                    + std::max(t[3] * bounds.minStartY, t[3] * bounds.maxStartY);
+
+    // half the diagonal of the largest quad, whatever its rotation
+    float extent = bounds.maxSize * 0.7072f;
+    _particleBounds.setRect(minX - extent, minY - extent, maxX - minX + 2 * extent, maxY - minY + 2 * extent);
+}
+
+bool ParticleSystem::updateOffscreen(Renderer* renderer, const Mat4& transform)
+{
+    if (!_offscreenCulling || _batchNode)
+    {
+        _offscreen = false;
+        return true;
+    }
+
+    Mat4 boundsTransform;
+    transform.translate(_particleBounds.origin.x, _particleBounds.origin.y, 0, &boundsTransform);
+    bool visible = renderer->checkVisibility(boundsTransform, _particleBounds.size);
+
+    // a system visited by several cameras is offscreen only if all of them cull it
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (frame != _offscreenFrame)
+    {
+        _offscreenFrame = frame;
+        _offscreen = !visible;
+    }
+    else
+    {
+        _offscreen = _offscreen && !visible;
+    }
+    return visible;
+}
+
+void ParticleSystem::setOffscreenCulling(bool enabled)
+{
+    _offscreenCulling = enabled;
+    if (!enabled)
+    {
+        _offscreen = false;
+    }
+}
+
+void ParticleSystem::finishStep(bool alive)
+{
+    if (!alive)
+    {
+        this->unscheduleUpdate();
+        if (_parent)
         {
-            _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
+            _parent->removeChild(this, true);
         }
-        
-        updateParticleQuads();
-        _transformSystemDirty = false;
+        return;
     }
 
     // only update gl buffer when visible
-    if (_visible && ! _batchNode)
+    if (_visible && ! _batchNode && ! _quadsDirty)
     {
+        ParticleBudgetManager::ScopedTimer timer(ParticleBudgetManager::Phase::QUADS);
         postStep();
     }
+}
 
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+void ParticleSystem::setRandomSeed(uint64_t seed)
+{
+    _random.setKey(seed);
+    _spawnedParticles = 0;
+}
+
+void ParticleSystem::runChunks(int start, int count, const std::function<void(int, int, int)>& job)
+{
+    int chunks = (count + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE;
+    if (chunks > 1 && count >= _parallelThreshold)
+    {
+        JobSystem::getInstance()->parallelFor(chunks, [start, count, &job](int chunk) {
+            int offset = chunk * PARTICLE_CHUNK_SIZE;
+            job(chunk, start + offset, std::min(PARTICLE_CHUNK_SIZE, count - offset));
+        });
+    }
+    else
+    {
+        for (int chunk = 0; chunk < chunks; ++chunk)
+        {
+            int offset = chunk * PARTICLE_CHUNK_SIZE;
+            job(chunk, start + offset, std::min(PARTICLE_CHUNK_SIZE, count - offset));
+        }
+    }
 }
 
 void ParticleSystem::updateWithNoTime()
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "base/CCProtocols.h"
 #include "2d/CCNode.h"
 #include "base/CCValue.h"
+#include "base/ccRandom.h"
 
 NS_CC_BEGIN
 
@@ -54,6 +55,13 @@ struct particle_point
 class CC_DLL ParticleData
 {
 public:
+    /** Mode specific arrays, see init(). */
+    enum ModeArrays
+    {
+        MODE_A = 1 << 0, ///< dirX, dirY, radialAccel, tangentialAccel
+        MODE_B = 1 << 1, ///< angle, degreesPerSecond, radius, deltaRadius
+    };
+
     float* posx;
     float* posy;
     float* startPosX;
@@ -75,6 +83,8 @@ public:
     float* deltaRotation;
     float* timeToLive;
     unsigned int* atlasIndex;
+    //! scratch space of compact()
+    int* survivors;
     
     //! Mode A: gravity, direction, radial accel, tangential accel
     struct{
@@ -93,10 +103,38 @@ public:
     } modeB;
     
     unsigned int maxCount;
+    //! mode specific arrays that are allocated, a combination of ModeArrays
+    int modeArrays;
+
     ParticleData();
-    bool init(int count);
+    /** Allocates the arrays for count particles.
+     * All the arrays live in one 64 bytes aligned block, each one padded to a multiple of 16 elements,
+     * so SIMD loops can run over the padding. Mode arrays not in modeArrays are left as nullptr.
+     */
+    bool init(int count, int modeArrays = MODE_A | MODE_B);
     void release();
     unsigned int getMaxCount() { return maxCount; }
+
+    /** Reallocates the block for other mode arrays, keeping the common arrays.
+     * The newly allocated mode arrays are zero filled.
+     */
+    bool setModeArrays(int modeArrays);
+
+    /** Removes the particles whose timeToLive is not positive among the first count ones.
+     * The living particles keep their order. It runs in two passes: the indices of the living particles
+     * are collected first, then each array is compacted in one streaming loop.
+     * atlasIndex is left untouched.
+     *
+     * @return The number of living particles.
+     */
+    int compact(int count);
+
+    /** Sets how many bytes of released blocks are kept to be reused by other particle systems
+     * of a similar capacity. 0, the default, disables the pool. Must be called from the main thread.
+     */
+    static void setArenaPoolCapacity(size_t bytes);
+    /** Frees all the blocks kept by the pool. */
+    static void purgeArenaPool();
     
     void copyParticle(int p1, int p2)
     {
@@ -125,17 +163,26 @@ public:
         
         atlasIndex[p1] = atlasIndex[p2];
         
-        modeA.dirX[p1] = modeA.dirX[p2];
-        modeA.dirY[p1] = modeA.dirY[p2];
-        modeA.radialAccel[p1] = modeA.radialAccel[p2];
-        modeA.tangentialAccel[p1] = modeA.tangentialAccel[p2];
-        
-        modeB.angle[p1] = modeB.angle[p2];
-        modeB.degreesPerSecond[p1] = modeB.degreesPerSecond[p2];
-        modeB.radius[p1] = modeB.radius[p2];
-        modeB.deltaRadius[p1] = modeB.deltaRadius[p2];
+        if (modeArrays & MODE_A)
+        {
+            modeA.dirX[p1] = modeA.dirX[p2];
+            modeA.dirY[p1] = modeA.dirY[p2];
+            modeA.radialAccel[p1] = modeA.radialAccel[p2];
+            modeA.tangentialAccel[p1] = modeA.tangentialAccel[p2];
+        }
         
+        if (modeArrays & MODE_B)
+        {
+            modeB.angle[p1] = modeB.angle[p2];
+            modeB.degreesPerSecond[p1] = modeB.degreesPerSecond[p2];
+            modeB.radius[p1] = modeB.radius[p2];
+            modeB.deltaRadius[p1] = modeB.deltaRadius[p2];
+        }
     }
+
+private:
+    void* _arena;
+    size_t _arenaSize;
 };
 
 
@@ -144,6 +191,7 @@ public:
 
 class Image;
 class Texture2D;
+struct ParticleConfig;
 
 /** @class ParticleSystem
  * @brief Particle System base class.
@@ -222,6 +270,16 @@ public:
         GROUPED, /** Living particles are attached to the emitter and are translated along with it. */
 
     };
+
+    /** @enum BudgetPriority
+     Order in which ParticleBudgetManager scales down the emission of the systems.
+     */
+    enum class BudgetPriority
+    {
+        LOW, /** Ambient effects, reduced first. */
+        NORMAL,
+        HIGH, /** Hero effects, reduced last. */
+    };
     
     //* @enum
     enum {
@@ -281,6 +339,40 @@ public:
      */
     virtual void updateWithNoTime();
 
+    /** Advances the living particles by dt and updates their quads, without emitting new ones.
+     * It only touches the particle system's own data, so systems can be simulated concurrently.
+     *
+     * @return False if the system is finished and should be removed from its parent.
+     */
+    virtual bool simulateStep(float dt);
+
+    /** Fast-forwards the system by seconds, as if it had been updated every fixedStep.
+     * Only the particles are simulated at each step, the quads are generated once at the end,
+     * so that ambient effects can start full. It is usually called after resetSystem() or on enter.
+     *
+     * @param seconds The time to simulate.
+     * @param fixedStep The time step, the last step is shorter when it doesn't divide seconds.
+     */
+    void prewarm(float seconds, float fixedStep = 1.0f / 60);
+
+    /** Enables or disables simulating all the particle systems in parallel.
+     * When enabled, update() only emits the new particles; the simulation of every updated
+     * system runs on the JobSystem once the scheduler is done (Director::EVENT_AFTER_UPDATE),
+     * and the vertex buffers are uploaded on the main thread afterwards. Disabled by default.
+     *
+     * @param enabled True to enable the parallel update.
+     */
+    static void setParallelUpdateEnabled(bool enabled);
+    /** Whether or not the particle systems are simulated in parallel.
+     *
+     * @return True if the parallel update is enabled.
+     */
+    static bool isParallelUpdateEnabled();
+    /** Disables the parallel update and drops the pending systems without simulating them.
+     * Called by Director::reset(), once the event listeners are removed.
+     */
+    static void resetParallelUpdate();
+
     /** Whether or not the particle system removed self on finish.
      *
      * @return True if the particle system removed self on finish.
@@ -570,10 +662,11 @@ public:
      */
     Mode getEmitterMode() const { return _emitterMode; }
     /** Sets the mode of the emitter.
+     * Only the particle arrays of the current mode are allocated, changing it reallocates them.
      *
      * @param mode The mode of the emitter.
      */
-    void setEmitterMode(Mode mode) { _emitterMode = mode; }
+    void setEmitterMode(Mode mode);
     
     /** Gets the start size in pixels of each particle.
      *
@@ -754,7 +847,10 @@ public:
     virtual Texture2D* getTexture() const override;
     virtual void setTexture(Texture2D *texture) override;
  
-    Image* getImage() const { return _image; }
+    /** Gets the image embedded in the plist as textureImageData, decoded on the first call.
+     * Returns nullptr when the texture came from a file.
+     */
+    Image* getImage() const;
 
     /**
     *@code
@@ -780,6 +876,80 @@ public:
     
     void setSourcePositionCompatible(bool sourcePositionCompatible) { _sourcePositionCompatible = sourcePositionCompatible; }
     bool isSourcePositionCompatible() const { return _sourcePositionCompatible; }
+
+    /** Sets the number of particles from which the system is updated in parallel.
+     * The particles are split into chunks that fit in the cache; when at least this many particles
+     * are spawned or simulated at once, the chunks are processed on the JobSystem.
+     * The spawned particles do not depend on it, each chunk has its own random stream.
+     *
+     * @param threshold The number of particles, 0 to always use the JobSystem.
+     */
+    void setParallelThreshold(int threshold) { _parallelThreshold = threshold; }
+    /** Gets the number of particles from which the system is updated in parallel.
+     *
+     * @return The number of particles.
+     */
+    int getParallelThreshold() const { return _parallelThreshold; }
+
+    /** Sets the seed of the random numbers used to spawn the particles, and restarts their sequence.
+     * For a given seed, updates with the same time steps always give bit-identical particles.
+     * The seed is random by default, derived from rand().
+     *
+     * @param seed The seed.
+     */
+    void setRandomSeed(uint64_t seed);
+    /** Gets the seed of the random numbers used to spawn the particles.
+     *
+     * @return The seed.
+     */
+    uint64_t getRandomSeed() const { return _random.getKey(); }
+
+    /** Enables or disables offscreen culling, enabled by default.
+     * The bounds of the particles are reduced after each simulation step; while they are outside
+     * the cameras visiting the system, its quads are neither generated, uploaded nor drawn.
+     * Systems in a ParticleBatchNode are never culled.
+     *
+     * @param enabled True to cull the system when offscreen.
+     */
+    void setOffscreenCulling(bool enabled);
+    /** Whether or not the system is culled when offscreen.
+     *
+     * @return True if offscreen culling is enabled.
+     */
+    bool isOffscreenCulling() const { return _offscreenCulling; }
+    /** Sets how often a culled system is simulated, 0 (the default) to simulate it every frame.
+     * The skipped time is emitted and simulated in a single step, which is cheaper but less accurate.
+     *
+     * @param interval The time between two simulation steps while offscreen, in seconds.
+     */
+    void setOffscreenUpdateInterval(float interval) { _offscreenUpdateInterval = interval; }
+    /** Gets how often a culled system is simulated.
+     *
+     * @return The time between two simulation steps while offscreen, in seconds.
+     */
+    float getOffscreenUpdateInterval() const { return _offscreenUpdateInterval; }
+    /** Whether or not the system was outside all the cameras that visited it in the last frame.
+     *
+     * @return True if the system is culled.
+     */
+    bool isOffscreen() const { return _offscreen; }
+    /** Gets a conservative bounding box of the particles in node space, as of the last simulation step.
+     * It is only maintained while offscreen culling is enabled.
+     *
+     * @return The bounding box.
+     */
+    const Rect& getParticleBounds() const { return _particleBounds; }
+
+    /** Sets the priority class of the system in the particle budget, NORMAL by default.
+     *
+     * @param priority The priority, see ParticleBudgetManager.
+     */
+    void setBudgetPriority(BudgetPriority priority) { _budgetPriority = priority; }
+    /** Gets the priority class of the system in the particle budget.
+     *
+     * @return The priority.
+     */
+    BudgetPriority getBudgetPriority() const { return _budgetPriority; }
     
 CC_CONSTRUCTOR_ACCESS:
     /**
@@ -800,6 +970,11 @@ CC_CONSTRUCTOR_ACCESS:
      @since v0.99.3
      */
     bool initWithFile(const std::string& plistFile);
+
+    /** initializes a ParticleSystem from a compiled particle file, see ParticleBinary.
+     initWithFile() calls it for the files with the ParticleBinary::FILE_EXTENSION extension.
+     */
+    bool initWithBinaryFile(const std::string& filename);
     
     /** initializes a QuadParticleSystem from a Dictionary.
      @since v0.99.3
@@ -810,6 +985,11 @@ CC_CONSTRUCTOR_ACCESS:
      @since v2.1
      */
     bool initWithDictionary(ValueMap& dictionary, const std::string& dirname);
+
+    /** initializes a particle system from a parsed config, as cached by ParticleTemplateCache.
+     The config's texture is used as is, it is not loaded.
+     */
+    bool initWithConfig(const ParticleConfig& config);
     
     //! Initializes a system with a fixed number of particles
     virtual bool initWithTotalParticles(int numberOfParticles);
@@ -827,9 +1007,34 @@ CC_CONSTRUCTOR_ACCESS:
 
 protected:
     virtual void updateBlendFunc();
+    void finishStep(bool alive);
+    /** Emits the new particles of a dt long step and advances the emitter's clock. */
+    void emitStep(float dt);
+    /** simulateStep() without the quads update. */
+    bool simulateParticles(float dt);
+    /** Gets the affine transform mapping the start position of a particle to the center of its quad, see fillParticleQuads(). */
+    void getParticleTransform(float* transform) const;
+    /** Merges the bounds of the chunks into _particleBounds. */
+    void updateParticleBounds();
+    /** Updates _offscreen with the bounds seen through the visiting camera, returns whether the system has to be drawn. */
+    bool updateOffscreen(Renderer* renderer, const Mat4& transform);
+    /** Calls job(chunk, start, count) for the chunks of [start, start + count), in parallel from the parallel threshold. */
+    void runChunks(int start, int count, const std::function<void(int, int, int)>& job);
+    /** Initializes the particles [start, start + count), the first one being the serial-th particle spawned. */
+    void spawnParticles(int start, int count, uint64_t serial, const Vec2& startPos);
+    static void flushPendingUpdates();
+    /** Decodes base64 gzipped image data, as stored in textureImageData. Returns an image the caller has to release. */
+    static Image* decodeTextureImageData(const std::string& textureData);
+    /** Reads the emitter parameters of a plist dictionary. The texture is found or loaded only if loadTexture,
+     and the embedded image data, if any, is moved to textureImageData when it is not nullptr.
+     */
+    static bool readConfig(ValueMap& dictionary, const std::string& dirname, bool loadTexture,
+                           ParticleConfig& config, std::string* textureImageData);
     
 private:
     friend class EngineDataManager;
+    friend class ParticleTemplateCache;
+    friend class ParticleBinary;
     /** Internal use only, it's used by EngineDataManager class for Android platform */
     static void setTotalParticleCountFactor(float factor);
     
@@ -915,6 +1120,11 @@ protected:
 
     //true if scaled or rotated
     bool _transformSystemDirty;
+    // node to world transform captured in update(), read by updateParticleQuads()
+    Mat4 _nodeToWorldTransform;
+    // time to simulate at the end of the frame, when the parallel update is enabled
+    float _pendingDt;
+    bool _updatePending;
     // Number of allocated particles
     int _allocatedParticles;
 
@@ -977,8 +1187,10 @@ protected:
     int _totalParticles;
     /** conforms to CocosNodeTexture protocol */
     Texture2D* _texture;
-    /** conforms to CocosNodeTexture protocol */
-    Image *_image;
+    /** image decoded from _textureImageData, created lazily by getImage() */
+    mutable Image *_image;
+    /** base64 gzipped image of the plist, kept so that getImage() can decode it */
+    std::string _textureImageData;
     /** conforms to CocosNodeTexture protocol */
     BlendFunc _blendFunc;
     /** does the alpha value modify color */
@@ -998,12 +1210,100 @@ protected:
     /** is sourcePosition compatible */
     bool _sourcePositionCompatible;
 
+    /** number of particles from which chunks are processed in parallel */
+    int _parallelThreshold;
+
+    /** bounds of the particles of a chunk, reduced after the simulation */
+    struct ChunkBounds
+    {
+        float minX, maxX, minY, maxY;
+        float minStartX, maxStartX, minStartY, maxStartY;
+        float maxSize;
+    };
+    std::vector<ChunkBounds> _chunkBounds;
+    Rect _particleBounds;
+    bool _offscreenCulling;
+    /** whether the system was culled by every camera of the last visited frame */
+    bool _offscreen;
+    unsigned int _offscreenFrame;
+    /** the quads are out of date, simulateStep() skipped them while the system was offscreen */
+    bool _quadsDirty;
+    float _offscreenUpdateInterval;
+    float _offscreenDt;
+
+    BudgetPriority _budgetPriority;
+
+    /** random numbers of the spawned particles */
+    CounterRandom _random;
+    /** number of particles spawned since the seed was set, serial number of the next one */
+    uint64_t _spawnedParticles;
+
     static Vector<ParticleSystem*> __allInstances;
+    static Vector<ParticleSystem*> __pendingUpdates;
+    static bool __parallelUpdateEnabled;
     
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ParticleSystem);
 };
 
+/** @struct ParticleConfig
+ * The emitter parameters of a particle plist, with the texture already resolved.
+ * It is plain data, so that systems can be created from it without parsing the plist again.
+ */
+struct CC_DLL ParticleConfig
+{
+    int maxParticles;
+    float angle;
+    float angleVar;
+    float duration;
+    BlendFunc blendFunc;
+
+    Color4F startColor;
+    Color4F startColorVar;
+    Color4F endColor;
+    Color4F endColorVar;
+
+    float startSize;
+    float startSizeVar;
+    float endSize;
+    float endSizeVar;
+
+    Vec2 sourcePosition;
+    Vec2 posVar;
+
+    float startSpin;
+    float startSpinVar;
+    float endSpin;
+    float endSpinVar;
+
+    ParticleSystem::Mode emitterMode;
+
+    // Mode A
+    Vec2 gravity;
+    float speed;
+    float speedVar;
+    float radialAccel;
+    float radialAccelVar;
+    float tangentialAccel;
+    float tangentialAccelVar;
+    bool rotationIsDir;
+
+    // Mode B
+    float startRadius;
+    float startRadiusVar;
+    float endRadius;
+    float endRadiusVar;
+    float rotatePerSecond;
+    float rotatePerSecondVar;
+
+    float life;
+    float lifeVar;
+    int yCoordFlipped;
+
+    /** not retained, the owner of the config keeps it alive */
+    Texture2D* texture;
+};
+
 // end of _2d group
 /// @}
 
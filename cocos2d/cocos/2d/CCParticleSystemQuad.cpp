@@ -34,23 +34,41 @@ THE SOFTWARE.
 
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCParticleBatchNode.h"
+#include "2d/CCParticleTemplateCache.h"
+#include "2d/CCParticleBudgetManager.h"
 #include "renderer/CCTextureAtlas.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCQuadIndexBuffer.h"
+#include "renderer/CCGLProgramCache.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
 #include "base/CCConfiguration.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/ccUTF8.h"
+#include "math/MathUtil.h"
+
+// glMapBufferRange() is only exposed where the GL entry points come from glew
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) && defined(GL_MAP_INVALIDATE_RANGE_BIT)
+#define CC_PARTICLE_MAP_BUFFER_RANGE 1
+#else
+#define CC_PARTICLE_MAP_BUFFER_RANGE 0
+#endif
 
 NS_CC_BEGIN
 
+size_t ParticleSystemQuad::__uploadedBytes = 0;
+int ParticleSystemQuad::__directDrawThreshold = 2048;
+
 ParticleSystemQuad::ParticleSystemQuad()
 :_quads(nullptr)
-,_indices(nullptr)
+,_quadIndices(nullptr)
 ,_VAOname(0)
+,_renderMode(RenderMode::AUTO)
 {
+    // QuadCommand acquires the shared index buffer lazily
+    setVisitThreadSafe(false);
     memset(_buffersVBO, 0, sizeof(_buffersVBO));
 }
 
@@ -59,14 +77,9 @@ ParticleSystemQuad::~ParticleSystemQuad()
     if (nullptr == _batchNode)
     {
         CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
-        glDeleteBuffers(2, &_buffersVBO[0]);
-        if (Configuration::getInstance()->supportsShareableVAO())
-        {
-            glDeleteVertexArrays(1, &_VAOname);
-            GL::bindVAO(0);
-        }
+        releaseVBO();
     }
+    CC_SAFE_RELEASE(_quadIndices);
 }
 
 // implementation ParticleSystemQuad
@@ -106,6 +119,26 @@ ParticleSystemQuad * ParticleSystemQuad::create(ValueMap &dictionary)
     return ret;
 }
 
+ParticleSystemQuad * ParticleSystemQuad::create(ParticleTemplate* particleTemplate)
+{
+    CCASSERT(particleTemplate, "Invalid particle template");
+    ParticleSystemQuad *ret = new (std::nothrow) ParticleSystemQuad();
+    if (ret && ret->initWithConfig(particleTemplate->getConfig()))
+    {
+        ret->_plistFile = particleTemplate->getFile();
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return ret;
+}
+
+ParticleSystemQuad * ParticleSystemQuad::createWithTemplate(const std::string& filename)
+{
+    auto particleTemplate = ParticleTemplateCache::getInstance()->getTemplate(filename);
+    return particleTemplate ? create(particleTemplate) : nullptr;
+}
+
 //implementation ParticleSystemQuad
 // overriding the init method
 bool ParticleSystemQuad::initWithTotalParticles(int numberOfParticles)
@@ -119,16 +152,7 @@ bool ParticleSystemQuad::initWithTotalParticles(int numberOfParticles)
             return false;
         }
 
-        initIndices();
-        if (Configuration::getInstance()->supportsShareableVAO())
-        {
-            setupVBOandVAO();
-        }
-        else
-        {
-            setupVBO();
-        }
-
+        // the VBO is only created once the system draws directly, see postStep()
         setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -243,228 +267,235 @@ void ParticleSystemQuad::setDisplayFrame(SpriteFrame *spriteFrame)
     this->setTextureWithRect(spriteFrame->getTexture(), spriteFrame->getRect());
 }
 
-void ParticleSystemQuad::initIndices()
-{
-    for(int i = 0; i < _totalParticles; ++i)
-    {
-        const unsigned int i6 = i*6;
-        const unsigned int i4 = i*4;
-        _indices[i6+0] = (GLushort) i4+0;
-        _indices[i6+1] = (GLushort) i4+1;
-        _indices[i6+2] = (GLushort) i4+2;
-
-        _indices[i6+5] = (GLushort) i4+1;
-        _indices[i6+4] = (GLushort) i4+2;
-        _indices[i6+3] = (GLushort) i4+3;
-    }
-}
-
-inline void updatePosWithParticle(V3F_C4B_T2F_Quad *quad, const Vec2& newPosition,float size,float rotation)
-{
-    // vertices
-    GLfloat size_2 = size/2;
-    GLfloat x1 = -size_2;
-    GLfloat y1 = -size_2;
-    
-    GLfloat x2 = size_2;
-    GLfloat y2 = size_2;
-    GLfloat x = newPosition.x;
-    GLfloat y = newPosition.y;
-    
-    GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(rotation);
-    GLfloat cr = cosf(r);
-    GLfloat sr = sinf(r);
-    GLfloat ax = x1 * cr - y1 * sr + x;
-    GLfloat ay = x1 * sr + y1 * cr + y;
-    GLfloat bx = x2 * cr - y1 * sr + x;
-    GLfloat by = x2 * sr + y1 * cr + y;
-    GLfloat cx = x2 * cr - y2 * sr + x;
-    GLfloat cy = x2 * sr + y2 * cr + y;
-    GLfloat dx = x1 * cr - y2 * sr + x;
-    GLfloat dy = x1 * sr + y2 * cr + y;
-    
-    // bottom-left
-    quad->bl.vertices.x = ax;
-    quad->bl.vertices.y = ay;
-    
-    // bottom-right vertex:
-    quad->br.vertices.x = bx;
-    quad->br.vertices.y = by;
-    
-    // top-left vertex:
-    quad->tl.vertices.x = dx;
-    quad->tl.vertices.y = dy;
-    
-    // top-right vertex:
-    quad->tr.vertices.x = cx;
-    quad->tr.vertices.y = cy;
-}
-
 void ParticleSystemQuad::updateParticleQuads()
 {
     if (_particleCount <= 0) {
         return;
     }
  
-    Vec2 currentPosition;
-    if (_positionType == PositionType::FREE)
-    {
-        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
-    }
-    else if (_positionType == PositionType::RELATIVE)
-    {
-        currentPosition = _position;
-    }
-    
     V3F_C4B_T2F_Quad *startQuad;
-    Vec2 pos = Vec2::ZERO;
     if (_batchNode)
     {
         V3F_C4B_T2F_Quad *batchQuads = _batchNode->getTextureAtlas()->getQuads();
         startQuad = &(batchQuads[_atlasIndex]);
-        pos = _position;
     }
     else
     {
         startQuad = &(_quads[0]);
     }
     
-    if( _positionType == PositionType::FREE )
-    {
-        Vec3 p1(currentPosition.x, currentPosition.y, 0);
-        Mat4 worldToNodeTM = getWorldToNodeTransform();
-        worldToNodeTM.transformPoint(&p1);
-        Vec3 p2;
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
+    // center of a particle: its position plus its start position mapped by transform
+    float transform[6];
+    getParticleTransform(transform);
+
+    runChunks(0, _particleCount, [&](int /*chunk*/, int start, int count) {
+        // positions and colors of the four vertices in one pass
+        MathUtil::fillParticleQuads(startQuad + start, _particleData.posx + start, _particleData.posy + start,
+                                    _particleData.startPosX + start, _particleData.startPosY + start, transform,
+                                    _particleData.size + start, _particleData.rotation + start,
+                                    _particleData.colorR + start, _particleData.colorG + start,
+                                    _particleData.colorB + start, _particleData.colorA + start,
+                                    _opacityModifyRGB, count);
+    });
+}
+
+void ParticleSystemQuad::postStep()
+{
+    if (!isDirectDraw())
+    {
+        // the renderer uploads the quads of a QuadCommand itself, a VBO here would only upload them twice
+        releaseVBO();
+        return;
+    }
+
+    if (!_buffersVBO[0])
+    {
+        // created with the current quads
+        if (Configuration::getInstance()->supportsShareableVAO())
         {
-            p2.set(*startX, *startY, 0);
-            worldToNodeTM.transformPoint(&p2);
-            newPos.set(*x,*y);
-            p2 = p1 - p2;
-            newPos.x -= p2.x - pos.x;
-            newPos.y -= p2.y - pos.y;
-            updatePosWithParticle(quadStart, newPos, *s, *r);
+            setupVBOandVAO();
         }
-    }
-    else if( _positionType == PositionType::RELATIVE )
-    {
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
+        else
         {
-            newPos.set(*x, *y);
-            newPos.x = *x - (currentPosition.x - *startX);
-            newPos.y = *y - (currentPosition.y - *startY);
-            newPos += pos;
-            updatePosWithParticle(quadStart, newPos, *s, *r);
+            setupVBO();
         }
+        __uploadedBytes += sizeof(_quads[0]) * _totalParticles;
+        return;
     }
-    else
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+
+    // Orphan the storage so the driver can hand out a fresh block instead of stalling on the one
+    // still read by the GPU, then stream only the live quads into it.
+    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, nullptr, GL_STREAM_DRAW);
+
+    GLsizeiptr size = sizeof(_quads[0]) * _particleCount;
+    if (size > 0)
     {
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
+        bool uploaded = false;
+#if CC_PARTICLE_MAP_BUFFER_RANGE
+        if (Configuration::getInstance()->supportsMapBufferRange())
         {
-            newPos.set(*x + pos.x, *y + pos.y);
-            updatePosWithParticle(quadStart, newPos, *s, *r);
+            // the storage was just orphaned, so nothing has to be synchronized
+            void *buf = glMapBufferRange(GL_ARRAY_BUFFER, 0, size,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (buf)
+            {
+                memcpy(buf, _quads, size);
+                uploaded = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+            }
         }
-    }
-    
-    //set color
-    if(_opacityModifyRGB)
-    {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
-        
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
+#endif
+        if (!uploaded)
         {
-            GLubyte colorR = *r * *a * 255;
-            GLubyte colorG = *g * *a * 255;
-            GLubyte colorB = *b * *a * 255;
-            GLubyte colorA = *a * 255;
-            quad->bl.colors.set(colorR, colorG, colorB, colorA);
-            quad->br.colors.set(colorR, colorG, colorB, colorA);
-            quad->tl.colors.set(colorR, colorG, colorB, colorA);
-            quad->tr.colors.set(colorR, colorG, colorB, colorA);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, _quads);
         }
+        __uploadedBytes += size;
     }
-    else
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    CHECK_GL_ERROR_DEBUG();
+}
+
+size_t ParticleSystemQuad::getUploadedBytes()
+{
+    return __uploadedBytes;
+}
+
+void ParticleSystemQuad::resetUploadedBytes()
+{
+    __uploadedBytes = 0;
+}
+
+bool ParticleSystemQuad::isDirectDraw() const
+{
+    if (_batchNode)
+        return false;
+
+    switch (_renderMode)
     {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
-        
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
-        {
-            GLubyte colorR = *r * 255;
-            GLubyte colorG = *g * 255;
-            GLubyte colorB = *b * 255;
-            GLubyte colorA = *a * 255;
-            quad->bl.colors.set(colorR, colorG, colorB, colorA);
-            quad->br.colors.set(colorR, colorG, colorB, colorA);
-            quad->tl.colors.set(colorR, colorG, colorB, colorA);
-            quad->tr.colors.set(colorR, colorG, colorB, colorA);
-        }
+        case RenderMode::DIRECT:
+            return true;
+        case RenderMode::BATCHED:
+            return false;
+        default:
+            // the batched path is limited by the 16 bit indices, whatever the shader
+            if (_totalParticles > QuadIndexBuffer::MAX_SHORT_QUADS)
+                return true;
+            // a custom shader may rely on the quads being in world space
+            return _totalParticles >= __directDrawThreshold
+                && getGLProgram() == GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
     }
 }
 
-void ParticleSystemQuad::postStep()
+GLProgramState* ParticleSystemQuad::getDirectDrawProgramState() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    
-    // Option 1: Sub Data
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_quads[0])*_totalParticles, _quads);
-    
-    // Option 2: Data
-    //  glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * particleCount, quads_, GL_DYNAMIC_DRAW);
-    
-    // Option 3: Orphaning + glMapBuffer
-    // glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0])*_totalParticles, nullptr, GL_STREAM_DRAW);
-    // void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-    // memcpy(buf, _quads, sizeof(_quads[0])*_totalParticles);
-    // glUnmapBuffer(GL_ARRAY_BUFFER);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    CHECK_GL_ERROR_DEBUG();
+    // the quads are in node space, the default shader expects them transformed by the renderer
+    if (getGLProgram() == GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP))
+    {
+        return GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
+    }
+    return getGLProgramState();
 }
 
 // overriding draw method
 void ParticleSystemQuad::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
-    //quad command
-    if(_particleCount > 0)
+    if(_particleCount > 0 && updateOffscreen(renderer, transform))
     {
-        _quadCommand.init(_globalZOrder, _texture, getGLProgramState(), _blendFunc, _quads, _particleCount, transform, flags);
-        renderer->addCommand(&_quadCommand);
+        if (_quadsDirty)
+        {
+            // back into view, the quads were skipped while offscreen
+            ParticleBudgetManager::ScopedTimer timer(ParticleBudgetManager::Phase::QUADS);
+            updateParticleQuads();
+            _quadsDirty = false;
+            postStep();
+        }
+
+        ParticleBudgetManager::ScopedTimer timer(ParticleBudgetManager::Phase::DRAW);
+
+        if (isDirectDraw())
+        {
+            _directDrawCommand.init(_globalZOrder, transform, flags);
+            _directDrawCommand.func = CC_CALLBACK_0(ParticleSystemQuad::onDraw, this, transform, flags);
+            renderer->addCommand(&_directDrawCommand);
+        }
+        else
+        {
+            //quad command
+            _quadCommand.init(_globalZOrder, _texture, getGLProgramState(), _blendFunc, _quads, _particleCount, transform, flags);
+            renderer->addCommand(&_quadCommand);
+        }
     }
 }
 
+void ParticleSystemQuad::onDraw(const Mat4& transform, uint32_t /*flags*/)
+{
+    ParticleBudgetManager::ScopedTimer timer(ParticleBudgetManager::Phase::DRAW);
+    auto conf = Configuration::getInstance();
+    if (!_buffersVBO[0])
+    {
+        // switched to direct drawing since the last update, or the renderer was recreated
+        if (conf->supportsShareableVAO())
+        {
+            setupVBOandVAO();
+        }
+        else
+        {
+            setupVBO();
+        }
+    }
+
+    // before binding the VAO: it may upload the indices
+    GLuint indicesVBO = _quadIndices->getVBO();
+    ssize_t quadCount = std::min((ssize_t)_particleCount, _quadIndices->getCapacity());
+
+    getDirectDrawProgramState()->apply(transform);
+    GL::bindTexture2D(_texture);
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+
+    if (conf->supportsShareableVAO())
+    {
+        GL::bindVAO(_VAOname);
+#if CC_REBIND_INDICES_BUFFER
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesVBO);
+#endif
+    }
+    else
+    {
+        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+
+        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+        // vertices
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(_quads[0].bl), (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
+        // colors
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(_quads[0].bl), (GLvoid*) offsetof(V3F_C4B_T2F, colors));
+        // tex coords
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(_quads[0].bl), (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesVBO);
+    }
+
+    glDrawElements(GL_TRIANGLES, (GLsizei) quadCount*6, _quadIndices->getIndexType(), (GLvoid*) 0);
+
+    if (conf->supportsShareableVAO())
+    {
+        GL::bindVAO(0);
+#if CC_REBIND_INDICES_BUFFER
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#endif
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, quadCount*6);
+    CHECK_GL_ERROR_DEBUG();
+}
+
 void ParticleSystemQuad::setTotalParticles(int tp)
 {
     // If we are setting the total number of particles to a number higher
@@ -473,35 +504,28 @@ void ParticleSystemQuad::setTotalParticles(int tp)
     {
         // Allocate new memory
         size_t quadsSize = sizeof(_quads[0]) * tp * 1;
-        size_t indicesSize = sizeof(_indices[0]) * tp * 6 * 1;
 
+        int modeArrays = _particleData.modeArrays;
         _particleData.release();
-        if (!_particleData.init(tp))
+        if (!_particleData.init(tp, modeArrays))
         {
             CCLOG("Particle system: not enough memory");
             return;
         }
         V3F_C4B_T2F_Quad* quadsNew = (V3F_C4B_T2F_Quad*)realloc(_quads, quadsSize);
-        GLushort* indicesNew = (GLushort*)realloc(_indices, indicesSize);
 
-        if (quadsNew && indicesNew)
+        if (quadsNew)
         {
             // Assign pointers
             _quads = quadsNew;
-            _indices = indicesNew;
 
             // Clear the memory
             memset(_quads, 0, quadsSize);
-            memset(_indices, 0, indicesSize);
             
             _allocatedParticles = tp;
         }
         else
         {
-            // Out of memory, failed to resize some array
-            if (quadsNew) _quads = quadsNew;
-            if (indicesNew) _indices = indicesNew;
-
             CCLOG("Particle system: out of memory");
             return;
         }
@@ -517,15 +541,12 @@ void ParticleSystemQuad::setTotalParticles(int tp)
             }
         }
 
-        initIndices();
-        if (Configuration::getInstance()->supportsShareableVAO())
+        if (_quadIndices)
         {
-            setupVBOandVAO();
-        }
-        else
-        {
-            setupVBO();
+            _quadIndices->reserve(tp);
         }
+        // recreated with the new size when drawing directly
+        releaseVBO();
         
         // fixed http://www.cocos2d-x.org/issues/3990
         // Updates texture coords.
@@ -545,7 +566,7 @@ void ParticleSystemQuad::setTotalParticles(int tp)
 
 void ParticleSystemQuad::setupVBOandVAO()
 {
-    glDeleteBuffers(2, &_buffersVBO[0]);
+    glDeleteBuffers(1, &_buffersVBO[0]);
 
     // clean VAO
     if (_VAOname)
@@ -554,16 +575,19 @@ void ParticleSystemQuad::setupVBOandVAO()
         GL::bindVAO(0);
         _VAOname = 0;
     }
+
+    // may upload the indices, so fetch it before binding the VAO
+    _buffersVBO[1] = _quadIndices ? _quadIndices->getVBO() : 0;
     
     glGenVertexArrays(1, &_VAOname);
     GL::bindVAO(_VAOname);
 
 #define kQuadSize sizeof(_quads[0].bl)
 
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_buffersVBO[0]);
 
     glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_STREAM_DRAW);
 
     // vertices
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
@@ -578,7 +602,6 @@ void ParticleSystemQuad::setupVBOandVAO()
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _totalParticles * 6, _indices, GL_STATIC_DRAW);
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
@@ -590,17 +613,15 @@ void ParticleSystemQuad::setupVBOandVAO()
 
 void ParticleSystemQuad::setupVBO()
 {
-    glDeleteBuffers(2, &_buffersVBO[0]);
+    glDeleteBuffers(1, &_buffersVBO[0]);
     
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_buffersVBO[0]);
 
     glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_STREAM_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _totalParticles * 6, _indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    _buffersVBO[1] = _quadIndices ? _quadIndices->getVBO() : 0;
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -609,15 +630,23 @@ void ParticleSystemQuad::listenRendererRecreated(EventCustom* /*event*/)
 {
     //when comes to foreground in android, _buffersVBO and _VAOname is a wild handle
     //before recreating, we need to reset them to 0
+    //they are recreated by the next direct draw
     memset(_buffersVBO, 0, sizeof(_buffersVBO));
-    if (Configuration::getInstance()->supportsShareableVAO())
+    _VAOname = 0;
+}
+
+void ParticleSystemQuad::releaseVBO()
+{
+    if (_buffersVBO[0])
     {
-        _VAOname = 0;
-        setupVBOandVAO();
+        glDeleteBuffers(1, &_buffersVBO[0]);
+        memset(_buffersVBO, 0, sizeof(_buffersVBO));
     }
-    else
+    if (_VAOname)
     {
-        setupVBO();
+        glDeleteVertexArrays(1, &_VAOname);
+        GL::bindVAO(0);
+        _VAOname = 0;
     }
 }
 
@@ -626,22 +655,26 @@ bool ParticleSystemQuad::allocMemory()
     CCASSERT( !_batchNode, "Memory should not be alloced when not using batchNode");
 
     CC_SAFE_FREE(_quads);
-    CC_SAFE_FREE(_indices);
 
     _quads = (V3F_C4B_T2F_Quad*)malloc(_totalParticles * sizeof(V3F_C4B_T2F_Quad));
-    _indices = (GLushort*)malloc(_totalParticles * 6 * sizeof(GLushort));
     
-    if( !_quads || !_indices) 
+    if( !_quads ) 
     {
         CCLOG("cocos2d: Particle system: not enough memory");
-        CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
 
         return false;
     }
 
     memset(_quads, 0, _totalParticles * sizeof(V3F_C4B_T2F_Quad));
-    memset(_indices, 0, _totalParticles * 6 * sizeof(GLushort));
+
+    if (_quadIndices)
+    {
+        _quadIndices->reserve(_totalParticles);
+    }
+    else
+    {
+        _quadIndices = QuadIndexBuffer::acquire(_totalParticles);
+    }
 
     return true;
 }
@@ -658,16 +691,7 @@ void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
         if( ! batchNode ) 
         {
             allocMemory();
-            initIndices();
             setTexture(oldBatch->getTexture());
-            if (Configuration::getInstance()->supportsShareableVAO())
-            {
-                setupVBOandVAO();
-            }
-            else
-            {
-                setupVBO();
-            }
         }
         // OLD: was it self render ? cleanup
         else if( !oldBatch )
@@ -678,16 +702,9 @@ void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
             memcpy( quad, _quads, _totalParticles * sizeof(_quads[0]) );
 
             CC_SAFE_FREE(_quads);
-            CC_SAFE_FREE(_indices);
+            CC_SAFE_RELEASE_NULL(_quadIndices);
 
-            glDeleteBuffers(2, &_buffersVBO[0]);
-            memset(_buffersVBO, 0, sizeof(_buffersVBO));
-            if (Configuration::getInstance()->supportsShareableVAO())
-            {
-                glDeleteVertexArrays(1, &_VAOname);
-                GL::bindVAO(0);
-                _VAOname = 0;
-            }
+            releaseVBO();
         }
     }
 }
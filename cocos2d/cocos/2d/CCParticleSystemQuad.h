@@ -31,11 +31,14 @@ THE SOFTWARE.
 
 #include "2d/CCParticleSystem.h"
 #include "renderer/CCQuadCommand.h"
+#include "renderer/CCCustomCommand.h"
 
 NS_CC_BEGIN
 
 class SpriteFrame;
 class EventCustom;
+class QuadIndexBuffer;
+class ParticleTemplate;
 
 /**
  * @addtogroup _2d
@@ -59,6 +62,16 @@ Special features and Limitations:
 class CC_DLL ParticleSystemQuad : public ParticleSystem
 {
 public:
+    /** How the quads reach the GPU. */
+    enum class RenderMode
+    {
+        /** DIRECT from the direct draw threshold on, BATCHED below it. */
+        AUTO,
+        /** The quads go through a QuadCommand and are batched by the renderer, which transforms and uploads them. */
+        BATCHED,
+        /** The quads are uploaded to a VBO of the system and drawn with the model-view as a uniform. */
+        DIRECT,
+    };
 
     /** Creates a Particle Emitter.
      *
@@ -84,6 +97,18 @@ public:
      * @return An autoreleased ParticleSystemQuad object.
      */
     static ParticleSystemQuad * create(ValueMap &dictionary);
+    /** Creates a Particle Emitter from a template, without reading its plist.
+     *
+     * @param particleTemplate A template of the ParticleTemplateCache.
+     * @return An autoreleased ParticleSystemQuad object.
+     */
+    static ParticleSystemQuad * create(ParticleTemplate* particleTemplate);
+    /** Creates a Particle Emitter from the cached template of a plist file, reading the plist on a cache miss.
+     *
+     * @param filename Particle plist file name.
+     * @return An autoreleased ParticleSystemQuad object.
+     */
+    static ParticleSystemQuad * createWithTemplate(const std::string& filename);
 
     /** Sets a new SpriteFrame as particle.
     WARNING: this method is experimental. Use setTextureWithRect instead.
@@ -144,6 +169,50 @@ public:
     virtual void setTotalParticles(int tp) override;
 
     virtual std::string getDescription() const override;
+
+    /** Sets how the quads are drawn, AUTO by default.
+     * DIRECT replaces the default no-MVP shader with its MVP version, a custom shader has to apply the model-view itself.
+     * AUTO systems of more than QuadIndexBuffer::MAX_SHORT_QUADS particles draw directly even with a custom shader.
+     * @js NA
+     * @lua NA
+     */
+    void setRenderMode(RenderMode mode) { _renderMode = mode; }
+    /** Gets how the quads are drawn.
+     * @js NA
+     * @lua NA
+     */
+    RenderMode getRenderMode() const { return _renderMode; }
+    /** Whether the system currently draws from its own VBO, resolving AUTO.
+     * @js NA
+     * @lua NA
+     */
+    bool isDirectDraw() const;
+
+    /** Sets the total particles from which AUTO systems using the default shader draw directly.
+     * Systems too large for a renderer batch always do, with any shader.
+     * @js NA
+     * @lua NA
+     */
+    static void setDirectDrawThreshold(int threshold) { __directDrawThreshold = threshold; }
+    /** Gets the total particles from which AUTO systems draw directly.
+     * @js NA
+     * @lua NA
+     */
+    static int getDirectDrawThreshold() { return __directDrawThreshold; }
+
+    /** Gets the number of vertex bytes sent to the GPU by all the particle systems since the last reset.
+     *
+     * Only the live quads are uploaded, so this follows the particle count rather than the capacity.
+     * @js NA
+     * @lua NA
+     */
+    static size_t getUploadedBytes();
+
+    /** Resets the counter returned by getUploadedBytes().
+     * @js NA
+     * @lua NA
+     */
+    static void resetUploadedBytes();
     
 CC_CONSTRUCTOR_ACCESS:
     /**
@@ -166,9 +235,6 @@ CC_CONSTRUCTOR_ACCESS:
 
 
 protected:
-    /** initializes the indices for the vertices*/
-    void initIndices();
-    
     /** initializes the texture with a rectangle measured Points */
     void initTexCoordsWithRect(const Rect& rect);
     
@@ -177,14 +243,22 @@ protected:
 
     void setupVBOandVAO();
     void setupVBO();
+    void releaseVBO();
     bool allocMemory();
+    GLProgramState* getDirectDrawProgramState() const;
+    void onDraw(const Mat4& transform, uint32_t flags);
 
     V3F_C4B_T2F_Quad    *_quads;        // quads to be rendered
-    GLushort            *_indices;      // indices
+    QuadIndexBuffer     *_quadIndices;  // indices, shared with the other quad renderers
     GLuint              _VAOname;
-    GLuint              _buffersVBO[2]; //0: vertex  1: indices
+    GLuint              _buffersVBO[2]; //0: vertex  1: indices, owned by _quadIndices
 
     QuadCommand _quadCommand;           // quad command
+    CustomCommand _directDrawCommand;   // draws _buffersVBO
+    RenderMode _renderMode;
+
+    static size_t __uploadedBytes;
+    static int __directDrawThreshold;
     
 
 
@@ -0,0 +1,180 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "2d/CCParticleTemplateCache.h"
+#include "2d/CCParticleBinary.h"
+#include "renderer/CCTexture2D.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
+
+NS_CC_BEGIN
+
+ParticleTemplate::ParticleTemplate(const std::string& file, const ParticleConfig& config)
+: _file(file)
+, _config(config)
+{
+    CC_SAFE_RETAIN(_config.texture);
+}
+
+ParticleTemplate::~ParticleTemplate()
+{
+    CC_SAFE_RELEASE(_config.texture);
+}
+
+static ParticleTemplateCache* s_particleTemplateCache = nullptr;
+
+ParticleTemplateCache* ParticleTemplateCache::getInstance()
+{
+    if (s_particleTemplateCache == nullptr)
+    {
+        s_particleTemplateCache = new (std::nothrow) ParticleTemplateCache;
+    }
+    return s_particleTemplateCache;
+}
+
+void ParticleTemplateCache::destroyInstance()
+{
+    delete s_particleTemplateCache;
+    s_particleTemplateCache = nullptr;
+}
+
+ParticleTemplateCache::ParticleTemplateCache()
+: _capacity(64)
+{
+}
+
+ParticleTemplateCache::~ParticleTemplateCache()
+{
+    removeAllTemplates();
+}
+
+ParticleTemplate* ParticleTemplateCache::getTemplate(const std::string& plistFile)
+{
+    auto it = _templates.find(plistFile);
+    if (it != _templates.end())
+    {
+        _usage.splice(_usage.begin(), _usage, it->second);
+        return it->second->second;
+    }
+
+    auto particleTemplate = loadTemplate(plistFile);
+    if (!particleTemplate)
+    {
+        return nullptr;
+    }
+
+    // not cached, only kept alive until the end of the frame
+    if (_capacity == 0)
+    {
+        particleTemplate->autorelease();
+        return particleTemplate;
+    }
+
+    // make room first, the new template must not be the one evicted
+    evict(_capacity - 1);
+    _usage.emplace_front(plistFile, particleTemplate);
+    _templates[plistFile] = _usage.begin();
+    return particleTemplate;
+}
+
+void ParticleTemplateCache::prewarm(const std::vector<std::string>& plistFiles)
+{
+    for (const auto& plistFile : plistFiles)
+    {
+        getTemplate(plistFile);
+    }
+}
+
+void ParticleTemplateCache::removeTemplate(const std::string& plistFile)
+{
+    auto it = _templates.find(plistFile);
+    if (it != _templates.end())
+    {
+        it->second->second->release();
+        _usage.erase(it->second);
+        _templates.erase(it);
+    }
+}
+
+void ParticleTemplateCache::removeAllTemplates()
+{
+    evict(0);
+}
+
+void ParticleTemplateCache::setCapacity(size_t capacity)
+{
+    _capacity = capacity;
+    evict(_capacity);
+}
+
+void ParticleTemplateCache::evict(size_t capacity)
+{
+    while (_usage.size() > capacity)
+    {
+        auto& last = _usage.back();
+        last.second->release();
+        _templates.erase(last.first);
+        _usage.pop_back();
+    }
+}
+
+ParticleTemplate* ParticleTemplateCache::loadTemplate(const std::string& plistFile)
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string fullPath = fileUtils->fullPathForFilename(plistFile);
+
+    // same as ParticleSystem::initWithFile, textures are relative to the directory of the plist
+    std::string dirname;
+    if (plistFile.find('/') != std::string::npos)
+    {
+        dirname = plistFile.substr(0, plistFile.rfind('/') + 1);
+    }
+
+    ParticleConfig config = ParticleConfig();
+    if (ParticleBinary::isBinaryFile(plistFile))
+    {
+        MappedFile file;
+        if (!file.open(fullPath) || !ParticleBinary::readConfig(file.getBytes(), file.getSize(), fullPath, dirname, true, config))
+        {
+            CCLOG("cocos2d: ParticleTemplateCache: can't read %s", plistFile.c_str());
+            return nullptr;
+        }
+        return new (std::nothrow) ParticleTemplate(fullPath, config);
+    }
+
+    ValueMap dict = fileUtils->getValueMapFromFile(fullPath);
+    if (dict.empty())
+    {
+        CCLOG("cocos2d: ParticleTemplateCache: can't read %s", plistFile.c_str());
+        return nullptr;
+    }
+    if (!ParticleSystem::readConfig(dict, dirname, true, config, nullptr))
+    {
+        return nullptr;
+    }
+    return new (std::nothrow) ParticleTemplate(fullPath, config);
+}
+
+NS_CC_END
@@ -0,0 +1,130 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCPARTICLETEMPLATECACHE_H_
+#define __CCPARTICLETEMPLATECACHE_H_
+
+#include "2d/CCParticleSystem.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class ParticleTemplate
+ * @brief The parsed config of a particle plist, shared by the systems created from it.
+ *
+ * A template is immutable and retains its texture. Holding a template keeps it valid
+ * after the cache evicted it.
+ * @js NA
+ */
+class CC_DLL ParticleTemplate : public Ref
+{
+public:
+    /** Gets the emitter parameters. */
+    const ParticleConfig& getConfig() const { return _config; }
+    /** Gets the full path of the plist the template was read from. */
+    const std::string& getFile() const { return _file; }
+
+CC_CONSTRUCTOR_ACCESS:
+    ParticleTemplate(const std::string& file, const ParticleConfig& config);
+    virtual ~ParticleTemplate();
+
+protected:
+    std::string _file;
+    ParticleConfig _config;
+};
+
+/** @class ParticleTemplateCache
+ * @brief Singleton that parses each particle plist once.
+ *
+ * ParticleSystemQuad::create(ParticleTemplate*) creates a system from a template
+ * without reading the plist, looking up its keys or decoding its texture.
+ * The least recently used templates are evicted when there are more than the capacity.
+ * @js NA
+ */
+class CC_DLL ParticleTemplateCache
+{
+public:
+    /** Returns the shared instance of the cache. */
+    static ParticleTemplateCache* getInstance();
+
+    /** Purges the cache, releasing every template. */
+    static void destroyInstance();
+
+    /** Gets the template of a plist, reading the plist if it is not cached.
+     *
+     * @param plistFile Particle plist file name.
+     * @return The template, nullptr if the plist could not be read. Retain it to keep it past an eviction.
+     */
+    ParticleTemplate* getTemplate(const std::string& plistFile);
+
+    /** Reads the plists that are not cached yet, for example while a scene is loading.
+     *
+     * @param plistFiles Particle plist file names.
+     */
+    void prewarm(const std::vector<std::string>& plistFiles);
+
+    /** Removes the template of a plist. */
+    void removeTemplate(const std::string& plistFile);
+
+    /** Removes every template. */
+    void removeAllTemplates();
+
+    /** Sets how many templates are kept, evicting the least recently used ones. Default is 64, 0 disables the cache. */
+    void setCapacity(size_t capacity);
+    /** Gets how many templates are kept. */
+    size_t getCapacity() const { return _capacity; }
+
+    /** Gets the number of cached templates. */
+    size_t getTemplateCount() const { return _templates.size(); }
+
+CC_CONSTRUCTOR_ACCESS:
+    ParticleTemplateCache();
+    ~ParticleTemplateCache();
+
+protected:
+    ParticleTemplate* loadTemplate(const std::string& plistFile);
+    void evict(size_t capacity);
+
+    typedef std::list<std::pair<std::string, ParticleTemplate*>> UsageList;
+    /** most recently used first */
+    UsageList _usage;
+    std::unordered_map<std::string, UsageList::iterator> _templates;
+    size_t _capacity;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CCPARTICLETEMPLATECACHE_H_
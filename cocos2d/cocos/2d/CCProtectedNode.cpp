@@ -36,6 +36,7 @@ NS_CC_BEGIN
 
 ProtectedNode::ProtectedNode() : _reorderProtectedChildDirty(false)
 {
+    setVisitThreadSafe(false);
 }
 
 ProtectedNode::~ProtectedNode()
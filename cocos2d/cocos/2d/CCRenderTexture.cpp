@@ -65,6 +65,7 @@ RenderTexture::RenderTexture()
 , _sprite(nullptr)
 , _saveFileCallback(nullptr)
 {
+    setVisitThreadSafe(false);
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     // Listen this event to save render texture before come to background.
     // Then it can be restored after coming to foreground on Android.
@@ -127,6 +127,7 @@ bool SpriteBatchNode::initWithFile(const std::string& fileImage, ssize_t capacit
 SpriteBatchNode::SpriteBatchNode()
 : _textureAtlas(nullptr)
 {
+    setVisitThreadSafe(false);
 }
 
 SpriteBatchNode::~SpriteBatchNode()
@@ -50,6 +50,7 @@ TransitionScene::TransitionScene()
 , _isInSceneOnTop(false)
 , _isSendCleanupToScene(false)
 {
+    setVisitThreadSafe(false);
 }
 
 TransitionScene::~TransitionScene()
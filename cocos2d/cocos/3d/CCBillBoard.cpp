@@ -36,6 +36,7 @@ BillBoard::BillBoard()
 : _mode(Mode::VIEW_POINT_ORIENTED)
 , _modeDirty(false)
 {
+    setVisitThreadSafe(false);
     Node::setAnchorPoint(Vec2(0.5f,0.5f));
 }
 
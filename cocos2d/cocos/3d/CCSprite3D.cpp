@@ -265,6 +265,7 @@ Sprite3D::Sprite3D()
 , _forceDepthWrite(false)
 , _usingAutogeneratedGLProgram(true)
 {
+    setVisitThreadSafe(false);
 }
 
 Sprite3D::~Sprite3D()
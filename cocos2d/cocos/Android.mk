@@ -65,9 +65,12 @@ cocos2d.cpp \
 2d/CCNodeGrid.cpp \
 2d/CCParallaxNode.cpp \
 2d/CCParticleBatchNode.cpp \
+2d/CCParticleBinary.cpp \
+2d/CCParticleBudgetManager.cpp \
 2d/CCParticleExamples.cpp \
 2d/CCParticleSystem.cpp \
 2d/CCParticleSystemQuad.cpp \
+2d/CCParticleTemplateCache.cpp \
 2d/CCProgressTimer.cpp \
 2d/CCProtectedNode.cpp \
 2d/CCRenderTexture.cpp \
@@ -91,8 +94,11 @@ cocos2d.cpp \
 3d/CCPlane.cpp \
 platform/CCDataManager.cpp \
 platform/CCFileUtils.cpp \
+platform/CCFileIndex.cpp \
+platform/CCAssetPack.cpp \
 platform/CCGLView.cpp \
 platform/CCImage.cpp \
+platform/CCMappedFile.cpp \
 platform/CCSAXParser.cpp \
 platform/CCThread.cpp \
 $(MATHNEONFILE) \
@@ -108,6 +114,7 @@ math/Vec4.cpp \
 base/CCNinePatchImageParser.cpp \
 base/CCStencilStateManager.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCJobSystem.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
@@ -174,6 +181,7 @@ renderer/CCPass.cpp \
 renderer/CCPrimitive.cpp \
 renderer/CCPrimitiveCommand.cpp \
 renderer/CCQuadCommand.cpp \
+renderer/CCQuadIndexBuffer.cpp \
 renderer/CCRenderCommand.cpp \
 renderer/CCRenderState.cpp \
 renderer/CCRenderer.cpp \
@@ -51,6 +51,8 @@ Configuration::Configuration()
 , _supportsDiscardFramebuffer(false)
 , _supportsShareableVAO(false)
 , _supportsOESMapBuffer(false)
+, _supportsMapBufferRange(false)
+, _supportsSyncObjects(false)
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
 , _maxSamplesAllowed(0)
@@ -161,6 +163,12 @@ void Configuration::gatherGPUInfo()
     _supportsOESMapBuffer = checkForGLExtension("GL_OES_mapbuffer");
     _valueDict["gl.supports_OES_map_buffer"] = Value(_supportsOESMapBuffer);
 
+    _supportsMapBufferRange = checkForGLExtension("_map_buffer_range");
+    _valueDict["gl.supports_map_buffer_range"] = Value(_supportsMapBufferRange);
+
+    _supportsSyncObjects = checkForGLExtension("GL_ARB_sync");
+    _valueDict["gl.supports_sync_objects"] = Value(_supportsSyncObjects);
+
     _supportsOESDepth24 = checkForGLExtension("GL_OES_depth24");
     _valueDict["gl.supports_OES_depth24"] = Value(_supportsOESDepth24);
 
@@ -295,6 +303,16 @@ bool Configuration::supportsMapBuffer() const
 #endif
 }
 
+bool Configuration::supportsMapBufferRange() const
+{
+    return _supportsMapBufferRange;
+}
+
+bool Configuration::supportsSyncObjects() const
+{
+    return _supportsSyncObjects;
+}
+
 bool Configuration::supportsOESDepth24() const
 {
     return _supportsOESDepth24;
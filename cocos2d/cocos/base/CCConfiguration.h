@@ -171,6 +171,22 @@ public:
      */
     bool supportsMapBuffer() const;
 
+    /** Whether or not glMapBufferRange() is supported.
+     *
+     * Checks for the extension `GL_ARB_map_buffer_range` or `GL_EXT_map_buffer_range`.
+     *
+     * @return Whether or not `glMapBufferRange()` is supported.
+     */
+    bool supportsMapBufferRange() const;
+
+    /** Whether or not fence sync objects are supported.
+     *
+     * Checks for the extension `GL_ARB_sync`.
+     *
+     * @return Whether or not `glFenceSync()` is supported.
+     */
+    bool supportsSyncObjects() const;
+
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -268,6 +284,8 @@ protected:
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
     bool            _supportsOESMapBuffer;
+    bool            _supportsMapBufferRange;
+    bool            _supportsSyncObjects;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
     
@@ -40,6 +40,9 @@ THE SOFTWARE.
 #include "2d/CCFontFNT.h"
 #include "2d/CCFontAtlasCache.h"
 #include "2d/CCAnimationCache.h"
+#include "2d/CCParticleSystem.h"
+#include "2d/CCParticleTemplateCache.h"
+#include "2d/CCParticleBudgetManager.h"
 #include "2d/CCTransition.h"
 #include "2d/CCFontFreeType.h"
 #include "2d/CCLabelAtlas.h"
@@ -61,6 +64,7 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 
@@ -1038,6 +1042,9 @@ void Director::reset()
     // cleanup scheduler
     getScheduler()->unscheduleAll();
     
+    // removes its own listener, which must still be alive
+    ParticleBudgetManager::destroyInstance();
+
     // Remove all events
     if (_eventDispatcher)
     {
@@ -1102,11 +1109,14 @@ void Director::reset()
 #pragma warning (pop)
 #endif
     AnimationCache::destroyInstance();
+    ParticleTemplateCache::destroyInstance();
     SpriteFrameCache::destroyInstance();
     GLProgramCache::destroyInstance();
     GLProgramStateCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destroyInstance();
+    ParticleSystem::resetParallelUpdate();
+    JobSystem::destroyInstance();
     
     // cocos2d-x specific data structures
     UserDefault::destroyInstance();
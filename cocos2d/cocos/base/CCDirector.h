@@ -174,6 +174,13 @@ public:
     bool isDisplayStats() { return _displayStats; }
     /** Display the FPS on the bottom-left corner of the screen. */
     void setDisplayStats(bool displayStats) { _displayStats = displayStats; }
+
+    /** Whether or not independent subtrees of the scene are visited on the JobSystem threads. */
+    bool isParallelVisitEnabled() const { return _parallelVisit; }
+    /** Visits independent subtrees of the scene on the JobSystem threads.
+     * Nodes that are not thread safe opt out with Node::setVisitThreadSafe(false). Default is false.
+     */
+    void setParallelVisitEnabled(bool enabled) { _parallelVisit = enabled; }
     
     /** Get seconds per frame. */
     float getSecondsPerFrame() { return _secondsPerFrame; }
@@ -662,6 +669,7 @@ protected:
     float _oldAnimationInterval = 0.0f;
     
     bool _displayStats = false;
+    bool _parallelVisit = false;
     float _accumDt = 0.0f;
     float _frameRate = 0.0f;
     
@@ -0,0 +1,154 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCJobSystem.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+static JobSystem* s_jobSystem = nullptr;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (s_jobSystem == nullptr)
+    {
+        s_jobSystem = new (std::nothrow) JobSystem;
+    }
+    return s_jobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    delete s_jobSystem;
+    s_jobSystem = nullptr;
+}
+
+JobSystem::JobSystem()
+: _stop(false)
+, _busy(false)
+, _job(nullptr)
+, _count(0)
+, _grain(1)
+, _next(0)
+, _generation(0)
+, _finishedWorkers(0)
+{
+    // the thread calling parallelFor works too
+    unsigned int cores = std::thread::hardware_concurrency();
+    unsigned int workers = cores > 1 ? cores - 1 : 0;
+    for (unsigned int i = 0; i < workers; ++i)
+    {
+        _threads.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _workAvailable.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void JobSystem::parallelFor(int count, const std::function<void(int)>& job, int grain)
+{
+    if (count <= 0)
+        return;
+
+    bool expected = false;
+    if (_threads.empty() || count <= grain || !_busy.compare_exchange_strong(expected, true))
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _job = &job;
+        _count = count;
+        _grain = grain > 0 ? grain : 1;
+        _next = 0;
+        _finishedWorkers = 0;
+        ++_generation;
+    }
+    _workAvailable.notify_all();
+
+    runJobs();
+
+    // fence: every worker has to acknowledge the batch before it can be reused
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _workDone.wait(lock, [this]{ return _finishedWorkers == _threads.size(); });
+        _job = nullptr;
+    }
+    _busy = false;
+}
+
+void JobSystem::runJobs()
+{
+    for (;;)
+    {
+        int begin = _next.fetch_add(_grain);
+        if (begin >= _count)
+            return;
+        int end = std::min(begin + _grain, _count);
+        for (int i = begin; i < end; ++i)
+        {
+            (*_job)(i);
+        }
+    }
+}
+
+void JobSystem::workerLoop()
+{
+    unsigned int generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _workAvailable.wait(lock, [this, generation]{ return _stop || _generation != generation; });
+            if (_stop)
+                return;
+            generation = _generation;
+        }
+
+        runJobs();
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_finishedWorkers;
+        }
+        _workDone.notify_one();
+    }
+}
+
+NS_CC_END
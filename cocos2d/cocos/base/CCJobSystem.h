@@ -0,0 +1,109 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCJOBSYSTEM_H_
+#define __CCJOBSYSTEM_H_
+
+#include "platform/CCPlatformMacros.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class JobSystem
+ * @brief A pool of worker threads running data parallel jobs within a frame.
+ *
+ * Unlike AsyncTaskPool, whose tasks complete in a later frame, parallelFor() blocks
+ * the calling thread until every job has run, so it can be used as a fence inside the main loop.
+ * The calling thread takes part in the work.
+ * @js NA
+ */
+class CC_DLL JobSystem
+{
+public:
+    /**
+     * Returns the shared instance of the job system.
+     */
+    static JobSystem* getInstance();
+
+    /**
+     * Destroys the job system, joining its threads.
+     */
+    static void destroyInstance();
+
+    /**
+     * Gets the number of worker threads, not counting the thread calling parallelFor().
+     */
+    unsigned int getWorkerCount() const { return (unsigned int)_threads.size(); }
+
+    /**
+     * Runs job(i) for every i in [0, count) and returns when all of them are done.
+     *
+     * Indices are handed out in groups of grain to the workers and the calling thread.
+     * A parallelFor() issued while another one is running, for example from inside a job,
+     * is run serially on the calling thread.
+     *
+     * @param count number of jobs.
+     * @param job the job, called with the index of the job.
+     * @param grain number of consecutive indices taken at once.
+     * @lua NA
+     */
+    void parallelFor(int count, const std::function<void(int)>& job, int grain = 1);
+
+CC_CONSTRUCTOR_ACCESS:
+    JobSystem();
+    ~JobSystem();
+
+protected:
+    void workerLoop();
+    void runJobs();
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _workDone;
+    bool _stop;
+
+    // current batch, only valid while _busy
+    std::atomic<bool> _busy;
+    const std::function<void(int)>* _job;
+    int _count;
+    int _grain;
+    std::atomic<int> _next;
+    unsigned int _generation;
+    unsigned int _finishedWorkers;
+};
+
+NS_CC_END
+/** @} */
+#endif //__CCJOBSYSTEM_H_
@@ -248,6 +248,183 @@ ssize_t ZipUtils::inflateMemory(unsigned char *in, ssize_t inLength, unsigned ch
     return inflateMemoryWithHint(in, inLength, out, 256 * 1024);
 }
 
+static const unsigned char BASE64_INVALID = 0xff;
+static const unsigned char BASE64_PAD = 0xfe;
+
+static unsigned char base64Value(char c)
+{
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    if (c == '=') return BASE64_PAD;
+    // white space and line breaks are skipped, like base64Decode() does
+    return BASE64_INVALID;
+}
+
+// decodes a group of 4 values, returns the number of bytes written
+static int decodeBase64Group(const unsigned char *values, unsigned char *out)
+{
+    unsigned int bits = 0;
+    int count = 0;
+    for (; count < 4 && values[count] != BASE64_PAD; ++count)
+    {
+        bits |= values[count] << (18 - count * 6);
+    }
+    if (count < 2)
+        return 0;
+    out[0] = (unsigned char)(bits >> 16);
+    if (count > 2) out[1] = (unsigned char)(bits >> 8);
+    if (count > 3) out[2] = (unsigned char)bits;
+    return count - 1;
+}
+
+// size of the inflated gzip data, read from the ISIZE field at the end of the stream, 0 if unknown
+static ssize_t gzipInflatedSize(const char *in, ssize_t inLength)
+{
+    // first group: the gzip magic number
+    unsigned char values[12];
+    int found = 0;
+    for (ssize_t i = 0; i < inLength && found < 4; ++i)
+    {
+        unsigned char v = base64Value(in[i]);
+        if (v != BASE64_INVALID)
+            values[found++] = v;
+    }
+    unsigned char head[3];
+    if (found < 4 || decodeBase64Group(values, head) < 2 || head[0] != 0x1f || head[1] != 0x8b)
+        return 0;
+
+    // last 3 groups hold at least the 4 bytes of ISIZE, even with padding
+    found = 0;
+    for (ssize_t i = inLength - 1; i >= 0 && found < 12; --i)
+    {
+        unsigned char v = base64Value(in[i]);
+        if (v != BASE64_INVALID)
+            values[11 - found++] = v;
+    }
+    if (found < 12)
+        return 0;
+
+    unsigned char tail[9];
+    int tailLength = 0;
+    for (int group = 0; group < 3; ++group)
+    {
+        tailLength += decodeBase64Group(values + group * 4, tail + tailLength);
+    }
+    if (tailLength < 4)
+        return 0;
+
+    const unsigned char *size = tail + tailLength - 4;
+    return (ssize_t)size[0] | ((ssize_t)size[1] << 8) | ((ssize_t)size[2] << 16) | ((ssize_t)size[3] << 24);
+}
+
+ssize_t ZipUtils::inflateBase64Memory(const char *in, ssize_t inLength, unsigned char **out)
+{
+    CCASSERT(out, "out can't be nullptr.");
+
+    ssize_t bufferSize = gzipInflatedSize(in, inLength);
+    // one spare byte so that the last inflate() call still has room and reports the end of the stream
+    bufferSize = bufferSize > 0 ? bufferSize + 1 : 256 * 1024;
+    *out = (unsigned char*)malloc(bufferSize);
+    if (! *out)
+        return 0;
+
+    z_stream d_stream; /* decompression stream */
+    d_stream.zalloc = (alloc_func)0;
+    d_stream.zfree = (free_func)0;
+    d_stream.opaque = (voidpf)0;
+    d_stream.next_in = Z_NULL;
+    d_stream.avail_in = 0;
+    d_stream.next_out = *out;
+    d_stream.avail_out = static_cast<unsigned int>(bufferSize);
+
+    int err = inflateInit2(&d_stream, 15 + 32);
+    if (err != Z_OK)
+    {
+        free(*out);
+        *out = nullptr;
+        return 0;
+    }
+
+    unsigned char block[4096];
+    unsigned char values[4];
+    int valueCount = 0;
+    ssize_t pos = 0;
+    bool inputDone = false;
+
+    while (err != Z_STREAM_END)
+    {
+        // decode the next block of input
+        if (d_stream.avail_in == 0 && !inputDone)
+        {
+            unsigned int blockLength = 0;
+            while (pos < inLength && blockLength + 3 <= sizeof(block))
+            {
+                unsigned char v = base64Value(in[pos++]);
+                if (v == BASE64_INVALID)
+                    continue;
+                values[valueCount++] = v;
+                if (valueCount == 4 || v == BASE64_PAD)
+                {
+                    while (valueCount < 4) values[valueCount++] = BASE64_PAD;
+                    blockLength += decodeBase64Group(values, block + blockLength);
+                    valueCount = 0;
+                    if (v == BASE64_PAD)
+                    {
+                        pos = inLength;
+                    }
+                }
+            }
+            inputDone = pos >= inLength;
+            if (inputDone && valueCount > 0)
+            {
+                // unpadded last group
+                while (valueCount < 4) values[valueCount++] = BASE64_PAD;
+                blockLength += decodeBase64Group(values, block + blockLength);
+                valueCount = 0;
+            }
+            d_stream.next_in = block;
+            d_stream.avail_in = blockLength;
+        }
+
+        // grow the destination if the size was unknown or wrong
+        if (d_stream.avail_out == 0)
+        {
+            unsigned char *grown = (unsigned char*)realloc(*out, bufferSize * BUFFER_INC_FACTOR);
+            if (! grown)
+            {
+                CCLOG("cocos2d: ZipUtils: realloc failed");
+                err = Z_MEM_ERROR;
+                break;
+            }
+            *out = grown;
+            d_stream.next_out = *out + bufferSize;
+            d_stream.avail_out = static_cast<unsigned int>(bufferSize * (BUFFER_INC_FACTOR - 1));
+            bufferSize *= BUFFER_INC_FACTOR;
+        }
+
+        err = inflate(&d_stream, Z_NO_FLUSH);
+        if (err == Z_NEED_DICT || err == Z_DATA_ERROR || err == Z_MEM_ERROR)
+            break;
+        if (err == Z_BUF_ERROR && d_stream.avail_in == 0 && inputDone)
+            break;
+    }
+
+    ssize_t outLength = bufferSize - d_stream.avail_out;
+    inflateEnd(&d_stream);
+
+    if (err != Z_STREAM_END)
+    {
+        CCLOG("cocos2d: ZipUtils: Incorrect base64 or zlib compressed data!");
+        free(*out);
+        *out = nullptr;
+        return 0;
+    }
+    return outLength;
+}
+
 int ZipUtils::inflateGZipFile(const char *path, unsigned char **out)
 {
     int len;
@@ -92,6 +92,16 @@ typedef struct unz_file_info_s unz_file_info;
         CC_DEPRECATED_ATTRIBUTE static ssize_t ccInflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t outLengthHint) { return inflateMemoryWithHint(in, inLength, out, outLengthHint); }
         static ssize_t inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t outLengthHint);
 
+        /** 
+        * Inflates base64 encoded zlib or gzip deflated memory. The inflated memory is expected to be freed by the caller.
+        *
+        * The text is decoded in small blocks fed straight to zlib, so the decoded bytes are never held as a whole.
+        * For gzip data the destination is allocated once, with the size stored in the gzip trailer.
+        *
+        * @return The length of the inflated buffer, 0 on error.
+        */
+        static ssize_t inflateBase64Memory(const char *in, ssize_t inLength, unsigned char **out);
+
         /** 
          * Inflates a GZip file into memory.
          *
@@ -31,3 +31,140 @@ std::mt19937 &cocos2d::RandomHelper::getEngine() {
     static std::mt19937 engine(seed_gen());
     return engine;
 }
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+NS_CC_BEGIN
+
+// Philox4x32 constants, from Random123 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+static const int PHILOX_ROUNDS = 10;
+
+// maps 23 random bits to [2, 4), then to [-1, 1)
+static inline float toMinus1_1(uint32_t x)
+{
+    union {
+        uint32_t d;
+        float f;
+    } u;
+    u.d = (x >> 9) | 0x40000000;
+    return u.f - 3.0f;
+}
+
+void CounterRandom::generate(uint32_t stream, uint64_t block, uint32_t out[4]) const
+{
+    uint32_t c0 = static_cast<uint32_t>(block);
+    uint32_t c1 = static_cast<uint32_t>(block >> 32);
+    uint32_t c2 = stream;
+    uint32_t c3 = 0;
+    uint32_t k0 = static_cast<uint32_t>(_key);
+    uint32_t k1 = static_cast<uint32_t>(_key >> 32);
+
+    for (int round = 0; round < PHILOX_ROUNDS; ++round)
+    {
+        uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+        c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        c1 = static_cast<uint32_t>(p1);
+        c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c3 = static_cast<uint32_t>(p0);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+#ifdef __SSE2__
+// lo and hi 32 bits of the products of the 4 lanes of a by m
+static inline void mulhilo(__m128i a, __m128i m, __m128i* lo, __m128i* hi)
+{
+    __m128i p02 = _mm_mul_epu32(a, m);
+    __m128i p13 = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+    p02 = _mm_shuffle_epi32(p02, _MM_SHUFFLE(3, 1, 2, 0));
+    p13 = _mm_shuffle_epi32(p13, _MM_SHUFFLE(3, 1, 2, 0));
+    *lo = _mm_unpacklo_epi32(p02, p13);
+    *hi = _mm_unpackhi_epi32(p02, p13);
+}
+
+static inline __m128 toMinus1_1(__m128i x)
+{
+    __m128i bits = _mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x40000000));
+    return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(3.0f));
+}
+#endif
+
+void CounterRandom::fillMinus1_1(uint32_t stream, uint64_t first, int count, float* out) const
+{
+    uint32_t block[4];
+    int i = 0;
+
+    // leading numbers, until first + i is the beginning of a block
+    if (count > 0 && (first & 3) != 0)
+    {
+        generate(stream, first >> 2, block);
+        for (int word = static_cast<int>(first & 3); word < 4 && i < count; ++word, ++i)
+        {
+            out[i] = toMinus1_1(block[word]);
+        }
+    }
+
+#ifdef __SSE2__
+    // 4 blocks at once, one per lane
+    const __m128i m0 = _mm_set1_epi32(PHILOX_M0);
+    const __m128i m1 = _mm_set1_epi32(PHILOX_M1);
+    for (; i + 16 <= count; i += 16)
+    {
+        uint64_t b = (first + i) >> 2;
+        __m128i c0 = _mm_set_epi32(static_cast<int>(b + 3), static_cast<int>(b + 2), static_cast<int>(b + 1), static_cast<int>(b));
+        __m128i c1 = _mm_set_epi32(static_cast<int>((b + 3) >> 32), static_cast<int>((b + 2) >> 32),
+                                   static_cast<int>((b + 1) >> 32), static_cast<int>(b >> 32));
+        __m128i c2 = _mm_set1_epi32(static_cast<int>(stream));
+        __m128i c3 = _mm_setzero_si128();
+        uint32_t k0 = static_cast<uint32_t>(_key);
+        uint32_t k1 = static_cast<uint32_t>(_key >> 32);
+
+        for (int round = 0; round < PHILOX_ROUNDS; ++round)
+        {
+            __m128i lo0, hi0, lo1, hi1;
+            mulhilo(c0, m0, &lo0, &hi0);
+            mulhilo(c2, m1, &lo1, &hi1);
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+            c1 = lo1;
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+            c3 = lo0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        // lanes hold blocks, the output is block after block: transpose
+        __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+        __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+        __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+        __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+        _mm_storeu_ps(out + i, toMinus1_1(_mm_unpacklo_epi64(t0, t1)));
+        _mm_storeu_ps(out + i + 4, toMinus1_1(_mm_unpackhi_epi64(t0, t1)));
+        _mm_storeu_ps(out + i + 8, toMinus1_1(_mm_unpacklo_epi64(t2, t3)));
+        _mm_storeu_ps(out + i + 12, toMinus1_1(_mm_unpackhi_epi64(t2, t3)));
+    }
+#endif
+
+    for (; i < count; i += 4)
+    {
+        generate(stream, (first + i) >> 2, block);
+        for (int word = 0; word < 4 && i + word < count; ++word)
+        {
+            out[i + word] = toMinus1_1(block[word]);
+        }
+    }
+}
+
+NS_CC_END
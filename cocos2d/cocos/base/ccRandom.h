@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include <random>
 #include <cstdlib>
+#include <cstdint>
 
 #include "platform/CCPlatformMacros.h"
 
@@ -62,6 +63,36 @@ private:
     static std::mt19937 &getEngine();
 };
 
+/**
+ * @class CounterRandom
+ * @brief A counter-based random number generator (Philox4x32-10).
+ *
+ * Number n of a stream only depends on the key, the stream and n, there is no state to update.
+ * A sequence can be split between threads or SIMD lanes, or replayed from any point,
+ * and always gives the same numbers for the same key.
+ */
+class CC_DLL CounterRandom {
+public:
+    explicit CounterRandom(uint64_t key = 0) : _key(key) {}
+
+    void setKey(uint64_t key) { _key = key; }
+    uint64_t getKey() const { return _key; }
+
+    /**
+     * Generates numbers 4 * block to 4 * block + 3 of a stream.
+     */
+    void generate(uint32_t stream, uint64_t block, uint32_t out[4]) const;
+
+    /**
+     * Writes numbers first to first + count - 1 of a stream as floats between -1 and 1 (excluded).
+     * Uses SSE2 when available, the results are the same.
+     */
+    void fillMinus1_1(uint32_t stream, uint64_t first, int count, float* out) const;
+
+private:
+    uint64_t _key;
+};
+
 /**
  * Returns a random value between `min` and `max`.
  */
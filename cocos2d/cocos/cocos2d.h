@@ -40,6 +40,7 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -129,9 +130,12 @@ THE SOFTWARE.
 #include "2d/CCNode.h"
 #include "2d/CCNodeGrid.h"
 #include "2d/CCParticleBatchNode.h"
+#include "2d/CCParticleBinary.h"
 #include "2d/CCParticleExamples.h"
 #include "2d/CCParticleSystem.h"
 #include "2d/CCParticleSystemQuad.h"
+#include "2d/CCParticleTemplateCache.h"
+#include "2d/CCParticleBudgetManager.h"
 #include "2d/CCProgressTimer.h"
 #include "2d/CCProtectedNode.h"
 #include "2d/CCRenderTexture.h"
@@ -162,6 +166,7 @@ THE SOFTWARE.
 #include "renderer/CCPrimitive.h"
 #include "renderer/CCPrimitiveCommand.h"
 #include "renderer/CCQuadCommand.h"
+#include "renderer/CCQuadIndexBuffer.h"
 #include "renderer/CCRenderCommand.h"
 #include "renderer/CCRenderCommandPool.h"
 #include "renderer/CCRenderState.h"
@@ -190,6 +195,7 @@ THE SOFTWARE.
 #include "platform/CCDevice.h"
 #include "platform/CCFileUtils.h"
 #include "platform/CCImage.h"
+#include "platform/CCMappedFile.h"
 #include "platform/CCPlatformConfig.h"
 #include "platform/CCPlatformMacros.h"
 #include "platform/CCSAXParser.h"
@@ -42,6 +42,7 @@ BoneNode::BoneNode()
 , _rackWidth(20)
 , _rootSkeleton(nullptr)
 {
+    setVisitThreadSafe(false);
 }
 
 
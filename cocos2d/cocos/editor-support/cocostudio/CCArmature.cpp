@@ -91,6 +91,7 @@ Armature::Armature()
     , _armatureTransformDirty(true)
     , _animation(nullptr)
 {
+    setVisitThreadSafe(false);
 }
 
 
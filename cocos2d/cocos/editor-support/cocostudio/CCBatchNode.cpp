@@ -51,6 +51,7 @@ BatchNode *BatchNode::create()
 BatchNode::BatchNode()
 : _groupCommand(nullptr)
 {
+    setVisitThreadSafe(false);
 }
 
 BatchNode::~BatchNode()
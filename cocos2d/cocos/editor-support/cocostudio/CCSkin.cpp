@@ -84,6 +84,7 @@ Skin::Skin()
     , _armature(nullptr)
     , _displayName("")
 {
+    setVisitThreadSafe(false);
     _skinTransform = Mat4::IDENTITY;
 }
 
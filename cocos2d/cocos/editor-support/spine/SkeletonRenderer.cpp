@@ -61,6 +61,8 @@ SkeletonRenderer* SkeletonRenderer::createWithFile (const std::string& skeletonD
 }
 
 void SkeletonRenderer::initialize () {
+	// the batches are shared by all skeletons
+	setVisitThreadSafe(false);
 	_worldVertices = new float[1000]; // Max number of vertices per mesh.
 	
 	_clipper = spSkeletonClipping_create();
@@ -21,6 +21,8 @@ This file was modified to fit the cocos2d-x project
 
 #include "math/MathUtil.h"
 #include "base/ccMacros.h"
+#include "base/ccTypes.h"
+#include <string.h>
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include <cpu-features.h>
@@ -59,6 +61,9 @@ This file was modified to fit the cocos2d-x project
 #define INCLUDE_SSE
 #endif
 
+// the SIMD implementations fall back to MathUtilC for the remainder elements
+#include "math/MathUtil.inl"
+
 #ifdef INCLUDE_NEON32
 #include "math/MathUtilNeon.inl"
 #endif
@@ -71,8 +76,6 @@ This file was modified to fit the cocos2d-x project
 #include "math/MathUtilSSE.inl"
 #endif
 
-#include "math/MathUtil.inl"
-
 NS_CC_MATH_BEGIN
 
 void MathUtil::smooth(float* x, float target, float elapsedTime, float responseTime)
@@ -136,6 +139,18 @@ bool MathUtil::isNeon64Enabled()
 #endif
 }
 
+bool MathUtil::isSSSE3Enabled()
+{
+#if defined (__SSSE3__)
+    return true;
+#elif defined (__SSE2__) && (defined (__GNUC__) || defined (__clang__))
+    static bool enabled = (__builtin_cpu_init(), __builtin_cpu_supports("ssse3") != 0);
+    return enabled;
+#else
+    return false;
+#endif
+}
+
 void MathUtil::addMatrix(const float* m, float scalar, float* dst)
 {
 #ifdef USE_NEON32
@@ -276,4 +291,393 @@ void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 #endif
 }
 
+void MathUtil::integrate(float* value, const float* delta, float dt, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::integrate(value, delta, dt, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::integrate(value, delta, dt, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::integrate(value, delta, dt, count);
+    else MathUtilC::integrate(value, delta, dt, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::integrate(value, delta, dt, count);
+#else
+    MathUtilC::integrate(value, delta, dt, count);
+#endif
+}
+
+void MathUtil::integrateNonNegative(float* value, const float* delta, float dt, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::integrateNonNegative(value, delta, dt, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::integrateNonNegative(value, delta, dt, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::integrateNonNegative(value, delta, dt, count);
+    else MathUtilC::integrateNonNegative(value, delta, dt, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::integrateNonNegative(value, delta, dt, count);
+#else
+    MathUtilC::integrateNonNegative(value, delta, dt, count);
+#endif
+}
+
+void MathUtil::minMax(const float* values, int count, float* min, float* max)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::minMax(values, count, min, max);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::minMax(values, count, min, max);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::minMax(values, count, min, max);
+    else MathUtilC::minMax(values, count, min, max);
+#elif defined (USE_SSE)
+    MathUtilSSE::minMax(values, count, min, max);
+#else
+    MathUtilC::minMax(values, count, min, max);
+#endif
+}
+
+void MathUtil::updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                          const float* radialAccel, const float* tangentialAccel,
+                                          float gravityX, float gravityY, float dt, float yFlip, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::updateParticlesGravityMode(posx, posy, dirX, dirY, radialAccel, tangentialAccel, gravityX, gravityY, dt, yFlip, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::updateParticlesGravityMode(posx, posy, dirX, dirY, radialAccel, tangentialAccel, gravityX, gravityY, dt, yFlip, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::updateParticlesGravityMode(posx, posy, dirX, dirY, radialAccel, tangentialAccel, gravityX, gravityY, dt, yFlip, count);
+    else MathUtilC::updateParticlesGravityMode(posx, posy, dirX, dirY, radialAccel, tangentialAccel, gravityX, gravityY, dt, yFlip, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::updateParticlesGravityMode(posx, posy, dirX, dirY, radialAccel, tangentialAccel, gravityX, gravityY, dt, yFlip, count);
+#else
+    MathUtilC::updateParticlesGravityMode(posx, posy, dirX, dirY, radialAccel, tangentialAccel, gravityX, gravityY, dt, yFlip, count);
+#endif
+}
+
+void MathUtil::updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                         float* radius, const float* deltaRadius, float dt, float yFlip, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::updateParticlesRadiusMode(posx, posy, angle, degreesPerSecond, radius, deltaRadius, dt, yFlip, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::updateParticlesRadiusMode(posx, posy, angle, degreesPerSecond, radius, deltaRadius, dt, yFlip, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::updateParticlesRadiusMode(posx, posy, angle, degreesPerSecond, radius, deltaRadius, dt, yFlip, count);
+    else MathUtilC::updateParticlesRadiusMode(posx, posy, angle, degreesPerSecond, radius, deltaRadius, dt, yFlip, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::updateParticlesRadiusMode(posx, posy, angle, degreesPerSecond, radius, deltaRadius, dt, yFlip, count);
+#else
+    MathUtilC::updateParticlesRadiusMode(posx, posy, angle, degreesPerSecond, radius, deltaRadius, dt, yFlip, count);
+#endif
+}
+
+void MathUtil::fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                 const float* startPosX, const float* startPosY, const float* transform,
+                                 const float* size, const float* rotation,
+                                 const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                 bool premultiplyAlpha, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::fillParticleQuads(quads, posx, posy, startPosX, startPosY, transform, size, rotation, colorR, colorG, colorB, colorA, premultiplyAlpha, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::fillParticleQuads(quads, posx, posy, startPosX, startPosY, transform, size, rotation, colorR, colorG, colorB, colorA, premultiplyAlpha, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::fillParticleQuads(quads, posx, posy, startPosX, startPosY, transform, size, rotation, colorR, colorG, colorB, colorA, premultiplyAlpha, count);
+    else MathUtilC::fillParticleQuads(quads, posx, posy, startPosX, startPosY, transform, size, rotation, colorR, colorG, colorB, colorA, premultiplyAlpha, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::fillParticleQuads(quads, posx, posy, startPosX, startPosY, transform, size, rotation, colorR, colorG, colorB, colorA, premultiplyAlpha, count);
+#else
+    MathUtilC::fillParticleQuads(quads, posx, posy, startPosX, startPosY, transform, size, rotation, colorR, colorG, colorB, colorA, premultiplyAlpha, count);
+#endif
+}
+
+void MathUtil::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count)
+{
+    // only the upper 3x4 part takes part in transformPoint
+    if (m[0] == 1.0f && m[1] == 0.0f && m[2] == 0.0f &&
+        m[4] == 0.0f && m[5] == 1.0f && m[6] == 0.0f &&
+        m[8] == 0.0f && m[9] == 0.0f && m[10] == 1.0f)
+    {
+        if (m[12] == 0.0f && m[13] == 0.0f && m[14] == 0.0f)
+        {
+            memcpy(dst, src, sizeof(V3F_C4B_T2F) * count);
+            return;
+        }
+#ifdef USE_NEON32
+        MathUtilNeon::translateVertices(dst, src, m, count);
+#elif defined (USE_NEON64)
+        MathUtilNeon64::translateVertices(dst, src, m, count);
+#elif defined (INCLUDE_NEON32)
+        if(isNeon32Enabled()) MathUtilNeon::translateVertices(dst, src, m, count);
+        else MathUtilC::translateVertices(dst, src, m, count);
+#elif defined (USE_SSE)
+        MathUtilSSE::translateVertices(dst, src, m, count);
+#else
+        MathUtilC::translateVertices(dst, src, m, count);
+#endif
+        return;
+    }
+
+#ifdef USE_NEON32
+    MathUtilNeon::transformVertices(dst, src, m, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformVertices(dst, src, m, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformVertices(dst, src, m, count);
+    else MathUtilC::transformVertices(dst, src, m, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::transformVertices(dst, src, m, count);
+#else
+    MathUtilC::transformVertices(dst, src, m, count);
+#endif
+}
+
+void MathUtil::offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::offsetIndices(dst, src, offset, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::offsetIndices(dst, src, offset, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::offsetIndices(dst, src, offset, count);
+    else MathUtilC::offsetIndices(dst, src, offset, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::offsetIndices(dst, src, offset, count);
+#else
+    MathUtilC::offsetIndices(dst, src, offset, count);
+#endif
+}
+
+void MathUtil::offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::offsetIndices(dst, src, offset, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::offsetIndices(dst, src, offset, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::offsetIndices(dst, src, offset, count);
+    else MathUtilC::offsetIndices(dst, src, offset, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::offsetIndices(dst, src, offset, count);
+#else
+    MathUtilC::offsetIndices(dst, src, offset, count);
+#endif
+}
+
+void MathUtil::convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertI8ToRGBA8888(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertI8ToRGBA8888(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertI8ToRGBA8888(src, dst, count);
+    else MathUtilC::convertI8ToRGBA8888(src, dst, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::convertI8ToRGBA8888(src, dst, count);
+#else
+    MathUtilC::convertI8ToRGBA8888(src, dst, count);
+#endif
+}
+
+void MathUtil::convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertAI88ToRGBA8888(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertAI88ToRGBA8888(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertAI88ToRGBA8888(src, dst, count);
+    else MathUtilC::convertAI88ToRGBA8888(src, dst, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::convertAI88ToRGBA8888(src, dst, count);
+#else
+    MathUtilC::convertAI88ToRGBA8888(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGB888ToRGBA8888(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGB888ToRGBA8888(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGB888ToRGBA8888(src, dst, count);
+    else MathUtilC::convertRGB888ToRGBA8888(src, dst, count);
+#elif defined (USE_SSE)
+    if(isSSSE3Enabled()) MathUtilSSE::convertRGB888ToRGBA8888(src, dst, count);
+    else MathUtilC::convertRGB888ToRGBA8888(src, dst, count);
+#else
+    MathUtilC::convertRGB888ToRGBA8888(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGBA8888ToRGB888(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGBA8888ToRGB888(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGBA8888ToRGB888(src, dst, count);
+    else MathUtilC::convertRGBA8888ToRGB888(src, dst, count);
+#elif defined (USE_SSE)
+    if(isSSSE3Enabled()) MathUtilSSE::convertRGBA8888ToRGB888(src, dst, count);
+    else MathUtilC::convertRGBA8888ToRGB888(src, dst, count);
+#else
+    MathUtilC::convertRGBA8888ToRGB888(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGBA8888ToA8(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGBA8888ToA8(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGBA8888ToA8(src, dst, count);
+    else MathUtilC::convertRGBA8888ToA8(src, dst, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::convertRGBA8888ToA8(src, dst, count);
+#else
+    MathUtilC::convertRGBA8888ToA8(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGB888ToRGB565(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGB888ToRGB565(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGB888ToRGB565(src, dst, count);
+    else MathUtilC::convertRGB888ToRGB565(src, dst, count);
+#elif defined (USE_SSE)
+    if(isSSSE3Enabled()) MathUtilSSE::convertRGB888ToRGB565(src, dst, count);
+    else MathUtilC::convertRGB888ToRGB565(src, dst, count);
+#else
+    MathUtilC::convertRGB888ToRGB565(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGBA8888ToRGB565(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGBA8888ToRGB565(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGBA8888ToRGB565(src, dst, count);
+    else MathUtilC::convertRGBA8888ToRGB565(src, dst, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::convertRGBA8888ToRGB565(src, dst, count);
+#else
+    MathUtilC::convertRGBA8888ToRGB565(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGB888ToRGBA4444(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGB888ToRGBA4444(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGB888ToRGBA4444(src, dst, count);
+    else MathUtilC::convertRGB888ToRGBA4444(src, dst, count);
+#elif defined (USE_SSE)
+    if(isSSSE3Enabled()) MathUtilSSE::convertRGB888ToRGBA4444(src, dst, count);
+    else MathUtilC::convertRGB888ToRGBA4444(src, dst, count);
+#else
+    MathUtilC::convertRGB888ToRGBA4444(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGBA8888ToRGBA4444(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGBA8888ToRGBA4444(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGBA8888ToRGBA4444(src, dst, count);
+    else MathUtilC::convertRGBA8888ToRGBA4444(src, dst, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::convertRGBA8888ToRGBA4444(src, dst, count);
+#else
+    MathUtilC::convertRGBA8888ToRGBA4444(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGB888ToRGB5A1(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGB888ToRGB5A1(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGB888ToRGB5A1(src, dst, count);
+    else MathUtilC::convertRGB888ToRGB5A1(src, dst, count);
+#elif defined (USE_SSE)
+    if(isSSSE3Enabled()) MathUtilSSE::convertRGB888ToRGB5A1(src, dst, count);
+    else MathUtilC::convertRGB888ToRGB5A1(src, dst, count);
+#else
+    MathUtilC::convertRGB888ToRGB5A1(src, dst, count);
+#endif
+}
+
+void MathUtil::convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::convertRGBA8888ToRGB5A1(src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::convertRGBA8888ToRGB5A1(src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::convertRGBA8888ToRGB5A1(src, dst, count);
+    else MathUtilC::convertRGBA8888ToRGB5A1(src, dst, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::convertRGBA8888ToRGB5A1(src, dst, count);
+#else
+    MathUtilC::convertRGBA8888ToRGB5A1(src, dst, count);
+#endif
+}
+
+void MathUtil::premultiplyAlpha(unsigned char* rgba, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::premultiplyAlpha(rgba, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::premultiplyAlpha(rgba, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::premultiplyAlpha(rgba, count);
+    else MathUtilC::premultiplyAlpha(rgba, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::premultiplyAlpha(rgba, count);
+#else
+    MathUtilC::premultiplyAlpha(rgba, count);
+#endif
+}
+
+void MathUtil::reversePremultipliedAlpha(unsigned char* rgba, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::reversePremultipliedAlpha(rgba, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::reversePremultipliedAlpha(rgba, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::reversePremultipliedAlpha(rgba, count);
+    else MathUtilC::reversePremultipliedAlpha(rgba, count);
+#elif defined (USE_SSE)
+    MathUtilSSE::reversePremultipliedAlpha(rgba, count);
+#else
+    MathUtilC::reversePremultipliedAlpha(rgba, count);
+#endif
+}
+
 NS_CC_MATH_END
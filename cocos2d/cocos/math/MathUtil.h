@@ -36,6 +36,9 @@
 
 NS_CC_MATH_BEGIN
 
+struct V3F_C4B_T2F;
+struct V3F_C4B_T2F_Quad;
+
 /**
  * Defines a math utility class.
  *
@@ -88,10 +91,190 @@ public:
      * @return interpolated float value
      */
     static float lerp(float from, float to, float alpha);
+
+    /**
+     * Integrates a structure-of-arrays attribute: value[i] += delta[i] * dt.
+     *
+     * Used by the particle system for color, rotation and radius updates.
+     * The SSE and NEON versions produce bit-identical results to the scalar one.
+     *
+     * @param value the values to update.
+     * @param delta the per-element rate of change.
+     * @param dt elapsed time.
+     * @param count number of elements.
+     */
+    static void integrate(float* value, const float* delta, float dt, int count);
+
+    /**
+     * Same as integrate, but the result is clamped so that it never goes below zero.
+     *
+     * @param value the values to update.
+     * @param delta the per-element rate of change.
+     * @param dt elapsed time.
+     * @param count number of elements.
+     */
+    static void integrateNonNegative(float* value, const float* delta, float dt, int count);
+
+    /**
+     * Widens [min, max] to contain the values.
+     *
+     * @param values the values.
+     * @param count number of values.
+     * @param min the minimum, updated in place.
+     * @param max the maximum, updated in place.
+     */
+    static void minMax(const float* values, int count, float* min, float* max);
+
+    /**
+     * Advances particles of a gravity mode (mode A) particle system by dt.
+     *
+     * Applies gravity plus the radial and tangential accelerations to the directions,
+     * then moves the positions along the directions. The SSE version is bit-identical
+     * to the scalar one; the armv7 NEON version refines reciprocal square root
+     * estimates and matches within 1e-6 relative error.
+     *
+     * @param posx particle x positions.
+     * @param posy particle y positions.
+     * @param dirX particle x directions.
+     * @param dirY particle y directions.
+     * @param radialAccel per particle radial acceleration.
+     * @param tangentialAccel per particle tangential acceleration.
+     * @param gravityX gravity x component.
+     * @param gravityY gravity y component.
+     * @param dt elapsed time.
+     * @param yFlip 1 or -1, applied to the position delta.
+     * @param count number of particles.
+     */
+    static void updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                           const float* radialAccel, const float* tangentialAccel,
+                                           float gravityX, float gravityY, float dt, float yFlip, int count);
+
+    /**
+     * Advances particles of a radius mode (mode B) particle system by dt.
+     *
+     * Rotates and shrinks/grows the particles around the emitter and recomputes their positions.
+     * The SIMD versions use polynomial sin/cos approximations whose absolute error
+     * is below 1e-6 for angles up to 8192 radians.
+     *
+     * @param posx particle x positions, written.
+     * @param posy particle y positions, written.
+     * @param angle particle angles in radians.
+     * @param degreesPerSecond per particle angular speed in radians per second.
+     * @param radius particle distances to the emitter.
+     * @param deltaRadius per particle radius rate of change.
+     * @param dt elapsed time.
+     * @param yFlip 1 or -1, applied to the y position.
+     * @param count number of particles.
+     */
+    static void updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                          float* radius, const float* deltaRadius, float dt, float yFlip, int count);
+
+    /**
+     * Writes the vertex positions and colors of square particle quads in one pass.
+     *
+     * The center of particle i is (posx[i], posy[i]) plus its start position transformed by
+     * the 2x3 matrix transform: transform[0] * startPosX[i] + transform[2] * startPosY[i] + transform[4]
+     * for x, transform[1] * startPosX[i] + transform[3] * startPosY[i] + transform[5] for y.
+     * The quad is size[i] wide and rotated clockwise by rotation[i] degrees; particles that are
+     * not rotated skip the sin/cos. Colors are clamped to [0, 1] and truncated to bytes.
+     * Vertex z and texture coordinates are left untouched.
+     * The SIMD versions use the same sin/cos approximations as updateParticlesRadiusMode.
+     *
+     * @param quads the quads to write, one per particle.
+     * @param posx particle x positions.
+     * @param posy particle y positions.
+     * @param startPosX particle x start positions.
+     * @param startPosY particle y start positions.
+     * @param transform the 2x3 matrix applied to the start positions, column major.
+     * @param size particle sizes.
+     * @param rotation particle rotations in degrees.
+     * @param colorR particle red components.
+     * @param colorG particle green components.
+     * @param colorB particle blue components.
+     * @param colorA particle alpha components.
+     * @param premultiplyAlpha whether red, green and blue are multiplied by alpha.
+     * @param count number of particles.
+     */
+    static void fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                  const float* startPosX, const float* startPosY, const float* transform,
+                                  const float* size, const float* rotation,
+                                  const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                  bool premultiplyAlpha, int count);
+
+    /**
+     * Copies vertices and transforms their positions by a matrix in one pass.
+     *
+     * Positions are transformed as by Mat4::transformPoint, and the results are bit-identical to it.
+     * Colors and texture coordinates are copied unchanged. When the upper 3x3 part of the matrix
+     * is identity, only the translation is added, and an identity matrix copies the vertices.
+     *
+     * @param dst the vertices to write, must not overlap src.
+     * @param src the vertices to read.
+     * @param m the matrix, column major as in Mat4::m.
+     * @param count number of vertices.
+     */
+    static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count);
+
+    /**
+     * Writes dst[i] = src[i] + offset, rebasing indices into a batched vertex buffer.
+     *
+     * @param dst the indices to write.
+     * @param src the indices to read.
+     * @param offset the value added to every index, it must not make them wrap around.
+     * @param count number of indices.
+     */
+    static void offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count);
+
+    /**
+     * Same as the 16 bit version, but widens the indices to 32 bit.
+     *
+     * @param dst the indices to write.
+     * @param src the indices to read.
+     * @param offset the value added to every index.
+     * @param count number of indices.
+     */
+    static void offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count);
+
+    /**
+     * Pixel format conversions used by Texture2D, count being the number of pixels.
+     *
+     * The SIMD versions give exactly the same bytes as the C ones. The source and
+     * destination must not overlap. 16 bit pixels are written in native byte order.
+     */
+    static void convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+    static void convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+    static void convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+    static void convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count);
+    static void convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count);
+    static void convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+    static void convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+    static void convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+    static void convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+    static void convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+    static void convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+
+    /**
+     * Multiplies the color of RGBA8888 pixels by their alpha in place, as CC_RGB_PREMULTIPLY_ALPHA.
+     *
+     * @param rgba the pixels.
+     * @param count number of pixels.
+     */
+    static void premultiplyAlpha(unsigned char* rgba, int count);
+
+    /**
+     * Divides the color of premultiplied RGBA8888 pixels by their alpha in place,
+     * rounding up. Pixels whose alpha is 0 are left unchanged.
+     *
+     * @param rgba the pixels.
+     * @param count number of pixels.
+     */
+    static void reversePremultipliedAlpha(unsigned char* rgba, int count);
 private:
     //Indicates that if neon is enabled
     static bool isNeon32Enabled();
     static bool isNeon64Enabled();
+    //Indicates that if the CPU supports SSSE3, which the SSE code may use without being built for it
+    static bool isSSSE3Enabled();
 private:
 #ifdef __SSE__
     static void addMatrix(const __m128 m[4], float scalar, __m128 dst[4]);
@@ -42,6 +42,61 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+
+    inline static void integrate(float* value, const float* delta, float dt, int count);
+
+    inline static void integrateNonNegative(float* value, const float* delta, float dt, int count);
+
+    inline static void minMax(const float* values, int count, float* min, float* max);
+
+    inline static void updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                                  const float* radialAccel, const float* tangentialAccel,
+                                                  float gravityX, float gravityY, float dt, float yFlip, int count);
+
+    inline static void updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                                 float* radius, const float* deltaRadius, float dt, float yFlip, int count);
+
+    inline static void fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                         const float* startPosX, const float* startPosY, const float* transform,
+                                         const float* size, const float* rotation,
+                                         const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                         bool premultiplyAlpha, int count);
+
+    inline static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count);
+
+    inline static void translateVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count);
+
+    inline static void offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count);
+
+    inline static void offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count);
+
+    inline static void convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void premultiplyAlpha(unsigned char* rgba, int count);
+
+    inline static void reversePremultipliedAlpha(unsigned char* rgba, int count);
+
+    inline static unsigned char toColorByte(float v);
 };
 
 inline void MathUtilC::addMatrix(const float* m, float scalar, float* dst)
@@ -215,4 +270,309 @@ inline void MathUtilC::crossVec3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline void MathUtilC::integrate(float* value, const float* delta, float dt, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        value[i] += delta[i] * dt;
+    }
+}
+
+inline void MathUtilC::integrateNonNegative(float* value, const float* delta, float dt, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        float v = value[i] + delta[i] * dt;
+        value[i] = 0.0f > v ? 0.0f : v;
+    }
+}
+
+inline void MathUtilC::minMax(const float* values, int count, float* min, float* max)
+{
+    float lo = *min;
+    float hi = *max;
+    for (int i = 0; i < count; ++i)
+    {
+        lo = values[i] < lo ? values[i] : lo;
+        hi = values[i] > hi ? values[i] : hi;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+inline void MathUtilC::updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                                  const float* radialAccel, const float* tangentialAccel,
+                                                  float gravityX, float gravityY, float dt, float yFlip, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        // Normalized position, left at zero when it is already a unit vector or too close to zero.
+        float nx = 0.0f, ny = 0.0f;
+        float n = posx[i] * posx[i] + posy[i] * posy[i];
+        if (n != 0.0f && n != 1.0f)
+        {
+            n = 1.0f / sqrtf(n);
+            nx = posx[i] * n;
+            ny = posy[i] * n;
+        }
+
+        // (gravity + radial + tangential) * dt
+        float tmpx = (nx * radialAccel[i] + ny * -tangentialAccel[i]) + gravityX;
+        float tmpy = (ny * radialAccel[i] + nx * tangentialAccel[i]) + gravityY;
+        dirX[i] += tmpx * dt;
+        dirY[i] += tmpy * dt;
+
+        posx[i] += dirX[i] * dt * yFlip;
+        posy[i] += dirY[i] * dt * yFlip;
+    }
+}
+
+inline void MathUtilC::updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                                 float* radius, const float* deltaRadius, float dt, float yFlip, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        angle[i] += degreesPerSecond[i] * dt;
+        radius[i] += deltaRadius[i] * dt;
+        posx[i] = - cosf(angle[i]) * radius[i];
+        posy[i] = - sinf(angle[i]) * radius[i] * yFlip;
+    }
+}
+
+inline void MathUtilC::fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                         const float* startPosX, const float* startPosY, const float* transform,
+                                         const float* size, const float* rotation,
+                                         const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                         bool premultiplyAlpha, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        float x = posx[i] + transform[0] * startPosX[i] + transform[2] * startPosY[i] + transform[4];
+        float y = posy[i] + transform[1] * startPosX[i] + transform[3] * startPosY[i] + transform[5];
+        float h = size[i] * 0.5f;
+        float hc = h;
+        float hs = 0.0f;
+        if (rotation[i] != 0.0f)
+        {
+            float r = rotation[i] * -0.01745329252f;
+            hc = h * cosf(r);
+            hs = h * sinf(r);
+        }
+
+        // the corners (-h, -h), (h, -h), (h, h) and (-h, h) rotated, around the center
+        V3F_C4B_T2F_Quad& quad = quads[i];
+        quad.bl.vertices.x = x - hc + hs;
+        quad.bl.vertices.y = y - hs - hc;
+        quad.br.vertices.x = x + hc + hs;
+        quad.br.vertices.y = y + hs - hc;
+        quad.tr.vertices.x = x + hc - hs;
+        quad.tr.vertices.y = y + hs + hc;
+        quad.tl.vertices.x = x - hc - hs;
+        quad.tl.vertices.y = y - hs + hc;
+
+        float m = premultiplyAlpha ? colorA[i] : 1.0f;
+        Color4B color(toColorByte(colorR[i] * m * 255),
+                      toColorByte(colorG[i] * m * 255),
+                      toColorByte(colorB[i] * m * 255),
+                      toColorByte(colorA[i] * 255));
+        quad.bl.colors = color;
+        quad.br.colors = color;
+        quad.tl.colors = color;
+        quad.tr.colors = color;
+    }
+}
+
+inline void MathUtilC::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        // same operations, in the same order, as transformVec4 with w = 1
+        float x = src[i].vertices.x;
+        float y = src[i].vertices.y;
+        float z = src[i].vertices.z;
+        dst[i].vertices.x = x * m[0] + y * m[4] + z * m[8] + m[12];
+        dst[i].vertices.y = x * m[1] + y * m[5] + z * m[9] + m[13];
+        dst[i].vertices.z = x * m[2] + y * m[6] + z * m[10] + m[14];
+        dst[i].colors = src[i].colors;
+        dst[i].texCoords = src[i].texCoords;
+    }
+}
+
+inline void MathUtilC::translateVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        dst[i].vertices.x = src[i].vertices.x + m[12];
+        dst[i].vertices.y = src[i].vertices.y + m[13];
+        dst[i].vertices.z = src[i].vertices.z + m[14];
+        dst[i].colors = src[i].colors;
+        dst[i].texCoords = src[i].texCoords;
+    }
+}
+
+inline void MathUtilC::offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        dst[i] = src[i] + offset;
+    }
+}
+
+inline void MathUtilC::offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        dst[i] = src[i] + offset;
+    }
+}
+
+// the pixel conversions below are the reference for the SIMD versions, which give the same bytes
+
+inline void MathUtilC::convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        *dst++ = src[i];     //R
+        *dst++ = src[i];     //G
+        *dst++ = src[i];     //B
+        *dst++ = 0xFF;       //A
+    }
+}
+
+inline void MathUtilC::convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 2)
+    {
+        *dst++ = src[0];     //R
+        *dst++ = src[0];     //G
+        *dst++ = src[0];     //B
+        *dst++ = src[1];     //A
+    }
+}
+
+inline void MathUtilC::convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 3)
+    {
+        *dst++ = src[0];     //R
+        *dst++ = src[1];     //G
+        *dst++ = src[2];     //B
+        *dst++ = 0xFF;       //A
+    }
+}
+
+inline void MathUtilC::convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 4)
+    {
+        *dst++ = src[0];     //R
+        *dst++ = src[1];     //G
+        *dst++ = src[2];     //B
+    }
+}
+
+inline void MathUtilC::convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 4)
+    {
+        *dst++ = src[3];     //A
+    }
+}
+
+inline void MathUtilC::convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 3)
+    {
+        *dst++ = (src[0] & 0x00F8) << 8    //R
+            | (src[1] & 0x00FC) << 3       //G
+            | (src[2] & 0x00F8) >> 3;      //B
+    }
+}
+
+inline void MathUtilC::convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 4)
+    {
+        *dst++ = (src[0] & 0x00F8) << 8    //R
+            | (src[1] & 0x00FC) << 3       //G
+            | (src[2] & 0x00F8) >> 3;      //B
+    }
+}
+
+inline void MathUtilC::convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 3)
+    {
+        *dst++ = (src[0] & 0x00F0) << 8    //R
+            | (src[1] & 0x00F0) << 4       //G
+            | (src[2] & 0x00F0)            //B
+            | 0x000F;                      //A
+    }
+}
+
+inline void MathUtilC::convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 4)
+    {
+        *dst++ = (src[0] & 0x00F0) << 8    //R
+            | (src[1] & 0x00F0) << 4       //G
+            | (src[2] & 0x00F0)            //B
+            | (src[3] & 0x00F0) >> 4;      //A
+    }
+}
+
+inline void MathUtilC::convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 3)
+    {
+        *dst++ = (src[0] & 0x00F8) << 8    //R
+            | (src[1] & 0x00F8) << 3       //G
+            | (src[2] & 0x00F8) >> 2       //B
+            | 0x0001;                      //A
+    }
+}
+
+inline void MathUtilC::convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 4)
+    {
+        *dst++ = (src[0] & 0x00F8) << 8    //R
+            | (src[1] & 0x00F8) << 3       //G
+            | (src[2] & 0x00F8) >> 2       //B
+            | (src[3] & 0x0080) >> 7;      //A
+    }
+}
+
+inline void MathUtilC::premultiplyAlpha(unsigned char* rgba, int count)
+{
+    for (int i = 0; i < count; ++i, rgba += 4)
+    {
+        unsigned int a = rgba[3] + 1;
+        rgba[0] = (unsigned char)((rgba[0] * a) >> 8);
+        rgba[1] = (unsigned char)((rgba[1] * a) >> 8);
+        rgba[2] = (unsigned char)((rgba[2] * a) >> 8);
+    }
+}
+
+inline void MathUtilC::reversePremultipliedAlpha(unsigned char* rgba, int count)
+{
+    for (int i = 0; i < count; ++i, rgba += 4)
+    {
+        if (rgba[3] > 0)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                int v = int(std::ceil((rgba[c] * 255.0f) / rgba[3]));
+                rgba[c] = (unsigned char)(v >= 0 ? (v < 255 ? v : 255) : 0);
+            }
+        }
+    }
+}
+
+inline unsigned char MathUtilC::toColorByte(float v)
+{
+    // saturate like the SIMD versions, NaN gives 0
+    return !(v > 0.0f) ? 0 : (v >= 255.0f ? 255 : static_cast<unsigned char>(v));
+}
+
 NS_CC_MATH_END
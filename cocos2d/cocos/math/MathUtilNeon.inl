@@ -17,6 +17,8 @@
 
  This file was modified to fit the cocos2d-x project
  */
+#include <arm_neon.h>
+
 NS_CC_MATH_BEGIN
 
 class MathUtilNeon
@@ -41,6 +43,67 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+
+    inline static void integrate(float* value, const float* delta, float dt, int count);
+
+    inline static void integrateNonNegative(float* value, const float* delta, float dt, int count);
+
+    inline static void minMax(const float* values, int count, float* min, float* max);
+
+    inline static void updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                                  const float* radialAccel, const float* tangentialAccel,
+                                                  float gravityX, float gravityY, float dt, float yFlip, int count);
+
+    inline static void updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                                 float* radius, const float* deltaRadius, float dt, float yFlip, int count);
+
+    inline static void fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                         const float* startPosX, const float* startPosY, const float* transform,
+                                         const float* size, const float* rotation,
+                                         const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                         bool premultiplyAlpha, int count);
+
+    inline static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count);
+
+    inline static void translateVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count);
+
+    inline static void offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count);
+
+    inline static void offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count);
+
+    inline static void convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void premultiplyAlpha(unsigned char* rgba, int count);
+
+    inline static void reversePremultipliedAlpha(unsigned char* rgba, int count);
+
+    inline static void sincos(float32x4_t x, float32x4_t* s, float32x4_t* c);
+
+    inline static uint16x8_t packRGB565(uint8x8_t r, uint8x8_t g, uint8x8_t b);
+
+    inline static uint16x8_t packRGBA4444(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a);
+
+    inline static uint16x8_t packRGB5A1(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a);
 };
 
 inline void MathUtilNeon::addMatrix(const float* m, float scalar, float* dst) __attribute__((optnone))
@@ -268,4 +331,475 @@ inline void MathUtilNeon::crossVec3(const float* v1, const float* v2, float* dst
                  );
 }
 
+inline void MathUtilNeon::integrate(float* value, const float* delta, float dt, int count)
+{
+    float32x4_t t = vdupq_n_f32(dt);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t v = vld1q_f32(value + i);
+        float32x4_t d = vld1q_f32(delta + i);
+        vst1q_f32(value + i, vaddq_f32(v, vmulq_f32(d, t)));
+    }
+    MathUtilC::integrate(value + i, delta + i, dt, count - i);
+}
+
+inline void MathUtilNeon::integrateNonNegative(float* value, const float* delta, float dt, int count)
+{
+    float32x4_t t = vdupq_n_f32(dt);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t v = vaddq_f32(vld1q_f32(value + i), vmulq_f32(vld1q_f32(delta + i), t));
+        vst1q_f32(value + i, vbslq_f32(vcgtq_f32(zero, v), zero, v));
+    }
+    MathUtilC::integrateNonNegative(value + i, delta + i, dt, count - i);
+}
+
+inline void MathUtilNeon::minMax(const float* values, int count, float* min, float* max)
+{
+    int i = 0;
+    if (count >= 4)
+    {
+        float32x4_t lo = vdupq_n_f32(*min);
+        float32x4_t hi = vdupq_n_f32(*max);
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t v = vld1q_f32(values + i);
+            lo = vminq_f32(lo, v);
+            hi = vmaxq_f32(hi, v);
+        }
+        // reduce the four lanes
+        float32x2_t lo2 = vpmin_f32(vget_low_f32(lo), vget_high_f32(lo));
+        float32x2_t hi2 = vpmax_f32(vget_low_f32(hi), vget_high_f32(hi));
+        *min = vget_lane_f32(vpmin_f32(lo2, lo2), 0);
+        *max = vget_lane_f32(vpmax_f32(hi2, hi2), 0);
+    }
+    MathUtilC::minMax(values + i, count - i, min, max);
+}
+
+inline void MathUtilNeon::updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                             const float* radialAccel, const float* tangentialAccel,
+                                             float gravityX, float gravityY, float dt, float yFlip, int count)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t gx = vdupq_n_f32(gravityX);
+    const float32x4_t gy = vdupq_n_f32(gravityY);
+    const float32x4_t t = vdupq_n_f32(dt);
+    const float32x4_t flip = vdupq_n_f32(yFlip);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t x = vld1q_f32(posx + i);
+        float32x4_t y = vld1q_f32(posy + i);
+
+        // normalize, lanes that are zero or already normalized keep a zero radial vector
+        float32x4_t n = vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y));
+        uint32x4_t mask = vandq_u32(vmvnq_u32(vceqq_f32(n, zero)), vmvnq_u32(vceqq_f32(n, one)));
+        // no divide or square root on armv7, refine the estimate with two Newton-Raphson steps
+        float32x4_t e = vrsqrteq_f32(n);
+        e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(n, e), e));
+        n = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(n, e), e));
+        float32x4_t nx = vbslq_f32(mask, vmulq_f32(x, n), zero);
+        float32x4_t ny = vbslq_f32(mask, vmulq_f32(y, n), zero);
+
+        float32x4_t ra = vld1q_f32(radialAccel + i);
+        float32x4_t ta = vld1q_f32(tangentialAccel + i);
+        float32x4_t tmpx = vaddq_f32(vaddq_f32(vmulq_f32(nx, ra), vmulq_f32(ny, vnegq_f32(ta))), gx);
+        float32x4_t tmpy = vaddq_f32(vaddq_f32(vmulq_f32(ny, ra), vmulq_f32(nx, ta)), gy);
+
+        float32x4_t dx = vaddq_f32(vld1q_f32(dirX + i), vmulq_f32(tmpx, t));
+        float32x4_t dy = vaddq_f32(vld1q_f32(dirY + i), vmulq_f32(tmpy, t));
+        vst1q_f32(dirX + i, dx);
+        vst1q_f32(dirY + i, dy);
+
+        vst1q_f32(posx + i, vaddq_f32(x, vmulq_f32(vmulq_f32(dx, t), flip)));
+        vst1q_f32(posy + i, vaddq_f32(y, vmulq_f32(vmulq_f32(dy, t), flip)));
+    }
+    MathUtilC::updateParticlesGravityMode(posx + i, posy + i, dirX + i, dirY + i, radialAccel + i, tangentialAccel + i,
+                                          gravityX, gravityY, dt, yFlip, count - i);
+}
+
+inline void MathUtilNeon::updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                            float* radius, const float* deltaRadius, float dt, float yFlip, int count)
+{
+    const float32x4_t t = vdupq_n_f32(dt);
+    const float32x4_t flip = vdupq_n_f32(yFlip);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t a = vaddq_f32(vld1q_f32(angle + i), vmulq_f32(vld1q_f32(degreesPerSecond + i), t));
+        float32x4_t r = vaddq_f32(vld1q_f32(radius + i), vmulq_f32(vld1q_f32(deltaRadius + i), t));
+        vst1q_f32(angle + i, a);
+        vst1q_f32(radius + i, r);
+
+        float32x4_t s, c;
+        sincos(a, &s, &c);
+        vst1q_f32(posx + i, vmulq_f32(vnegq_f32(c), r));
+        vst1q_f32(posy + i, vmulq_f32(vmulq_f32(vnegq_f32(s), r), flip));
+    }
+    MathUtilC::updateParticlesRadiusMode(posx + i, posy + i, angle + i, degreesPerSecond + i,
+                                         radius + i, deltaRadius + i, dt, yFlip, count - i);
+}
+
+inline void MathUtilNeon::fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                            const float* startPosX, const float* startPosY, const float* transform,
+                                            const float* size, const float* rotation,
+                                            const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                            bool premultiplyAlpha, int count)
+{
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float32x4_t toRadians = vdupq_n_f32(-0.01745329252f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t sx = vld1q_f32(startPosX + i);
+        float32x4_t sy = vld1q_f32(startPosY + i);
+        float32x4_t x = vaddq_f32(vaddq_f32(vaddq_f32(vld1q_f32(posx + i), vmulq_n_f32(sx, transform[0])), vmulq_n_f32(sy, transform[2])), vdupq_n_f32(transform[4]));
+        float32x4_t y = vaddq_f32(vaddq_f32(vaddq_f32(vld1q_f32(posy + i), vmulq_n_f32(sx, transform[1])), vmulq_n_f32(sy, transform[3])), vdupq_n_f32(transform[5]));
+        float32x4_t h = vmulq_f32(vld1q_f32(size + i), half);
+        float32x4_t hc = h;
+        float32x4_t hs = zero;
+        float32x4_t r = vld1q_f32(rotation + i);
+        uint32x4_t rotated = vmvnq_u32(vceqq_f32(r, zero));
+        uint32x2_t anyRotated = vorr_u32(vget_low_u32(rotated), vget_high_u32(rotated));
+        if (vget_lane_u32(vpmax_u32(anyRotated, anyRotated), 0))
+        {
+            float32x4_t sr, cr;
+            sincos(vmulq_f32(r, toRadians), &sr, &cr);
+            hc = vmulq_f32(h, cr);
+            hs = vmulq_f32(h, sr);
+        }
+
+        float32x4x2_t bl = vzipq_f32(vaddq_f32(vsubq_f32(x, hc), hs), vsubq_f32(vsubq_f32(y, hs), hc));
+        float32x4x2_t br = vzipq_f32(vaddq_f32(vaddq_f32(x, hc), hs), vsubq_f32(vaddq_f32(y, hs), hc));
+        float32x4x2_t tr = vzipq_f32(vsubq_f32(vaddq_f32(x, hc), hs), vaddq_f32(vaddq_f32(y, hs), hc));
+        float32x4x2_t tl = vzipq_f32(vsubq_f32(vsubq_f32(x, hc), hs), vaddq_f32(vsubq_f32(y, hs), hc));
+
+        // colors: the conversion saturates negative values to 0, vqmovn the others to 255
+        float32x4_t a = vld1q_f32(colorA + i);
+        float32x4_t m = premultiplyAlpha ? a : one;
+        uint16x4_t cr = vqmovn_u32(vcvtq_u32_f32(vmulq_f32(vmulq_f32(vld1q_f32(colorR + i), m), scale)));
+        uint16x4_t cg = vqmovn_u32(vcvtq_u32_f32(vmulq_f32(vmulq_f32(vld1q_f32(colorG + i), m), scale)));
+        uint16x4_t cb = vqmovn_u32(vcvtq_u32_f32(vmulq_f32(vmulq_f32(vld1q_f32(colorB + i), m), scale)));
+        uint16x4_t ca = vqmovn_u32(vcvtq_u32_f32(vmulq_f32(a, scale)));
+        // r0..r3 g0..g3 and b0..b3 a0..a3, interleaved twice to r0 g0 b0 a0 r1 g1 b1 a1...
+        uint8x8x2_t c = vzip_u8(vqmovn_u16(vcombine_u16(cr, cg)), vqmovn_u16(vcombine_u16(cb, ca)));
+        c = vzip_u8(c.val[0], c.val[1]);
+        uint32x2_t c01 = vreinterpret_u32_u8(c.val[0]);
+        uint32x2_t c23 = vreinterpret_u32_u8(c.val[1]);
+        uint32_t packed[4] = { vget_lane_u32(c01, 0), vget_lane_u32(c01, 1), vget_lane_u32(c23, 0), vget_lane_u32(c23, 1) };
+
+        V3F_C4B_T2F_Quad* quad = quads + i;
+#define CC_STORE_PARTICLE_QUAD(n, part, half)\
+        vst1_f32(&quad[n].bl.vertices.x, half(bl.val[part]));\
+        vst1_f32(&quad[n].br.vertices.x, half(br.val[part]));\
+        vst1_f32(&quad[n].tr.vertices.x, half(tr.val[part]));\
+        vst1_f32(&quad[n].tl.vertices.x, half(tl.val[part]));\
+        memcpy(reinterpret_cast<GLubyte*>(&quad[n].bl.colors), &packed[n], 4);\
+        memcpy(reinterpret_cast<GLubyte*>(&quad[n].br.colors), &packed[n], 4);\
+        memcpy(reinterpret_cast<GLubyte*>(&quad[n].tr.colors), &packed[n], 4);\
+        memcpy(reinterpret_cast<GLubyte*>(&quad[n].tl.colors), &packed[n], 4);
+        CC_STORE_PARTICLE_QUAD(0, 0, vget_low_f32)
+        CC_STORE_PARTICLE_QUAD(1, 0, vget_high_f32)
+        CC_STORE_PARTICLE_QUAD(2, 1, vget_low_f32)
+        CC_STORE_PARTICLE_QUAD(3, 1, vget_high_f32)
+#undef CC_STORE_PARTICLE_QUAD
+    }
+    MathUtilC::fillParticleQuads(quads + i, posx + i, posy + i, startPosX + i, startPosY + i, transform,
+                                 size + i, rotation + i, colorR + i, colorG + i, colorB + i, colorA + i,
+                                 premultiplyAlpha, count - i);
+}
+
+// Cephes style sin/cos: reduce to [-pi/4, pi/4] in extended precision, then evaluate both minimax polynomials.
+inline void MathUtilNeon::sincos(float32x4_t x, float32x4_t* s, float32x4_t* c)
+{
+    uint32x4_t signSin = vcltq_f32(x, vdupq_n_f32(0.0f));
+    x = vabsq_f32(x);
+
+    // octant index j = (int)(x * 4 / pi), rounded up to an even number
+    uint32x4_t j = vcvtq_u32_f32(vmulq_f32(x, vdupq_n_f32(1.27323954473516f)));
+    j = vandq_u32(vaddq_u32(j, vdupq_n_u32(1)), vdupq_n_u32(~1u));
+    float32x4_t y = vcvtq_f32_u32(j);
+
+    uint32x4_t polyMask = vtstq_u32(j, vdupq_n_u32(2));
+    signSin = veorq_u32(signSin, vtstq_u32(j, vdupq_n_u32(4)));
+    uint32x4_t signCos = vtstq_u32(vsubq_u32(j, vdupq_n_u32(2)), vdupq_n_u32(4));
+
+    // x - y * pi / 4, with pi / 4 split in three parts
+    x = vaddq_f32(x, vmulq_f32(y, vdupq_n_f32(-0.78515625f)));
+    x = vaddq_f32(x, vmulq_f32(y, vdupq_n_f32(-2.4187564849853515625e-4f)));
+    x = vaddq_f32(x, vmulq_f32(y, vdupq_n_f32(-3.77489497744594108e-8f)));
+    float32x4_t z = vmulq_f32(x, x);
+
+    float32x4_t yc = vdupq_n_f32(2.443315711809948e-5f);
+    yc = vaddq_f32(vmulq_f32(yc, z), vdupq_n_f32(-1.388731625493765e-3f));
+    yc = vaddq_f32(vmulq_f32(yc, z), vdupq_n_f32(4.166664568298827e-2f));
+    yc = vmulq_f32(vmulq_f32(yc, z), z);
+    yc = vsubq_f32(yc, vmulq_f32(z, vdupq_n_f32(0.5f)));
+    yc = vaddq_f32(yc, vdupq_n_f32(1.0f));
+
+    float32x4_t ys = vdupq_n_f32(-1.9515295891e-4f);
+    ys = vaddq_f32(vmulq_f32(ys, z), vdupq_n_f32(8.3321608736e-3f));
+    ys = vaddq_f32(vmulq_f32(ys, z), vdupq_n_f32(-1.6666654611e-1f));
+    ys = vaddq_f32(vmulq_f32(vmulq_f32(ys, z), x), x);
+
+    // pick the polynomial for each output depending on the octant
+    float32x4_t sinv = vbslq_f32(polyMask, yc, ys);
+    float32x4_t cosv = vbslq_f32(polyMask, ys, yc);
+    *s = vbslq_f32(signSin, vnegq_f32(sinv), sinv);
+    *c = vbslq_f32(signCos, cosv, vnegq_f32(cosv));
+}
+
+inline void MathUtilNeon::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count)
+{
+    const float32x4_t c0 = vld1q_f32(m);
+    const float32x4_t c1 = vld1q_f32(m + 4);
+    const float32x4_t c2 = vld1q_f32(m + 8);
+    const float32x4_t c3 = vld1q_f32(m + 12);
+    // x, y and z come from the result, the color bytes from the source
+    const uint32x4_t xyz = vsetq_lane_u32(0, vdupq_n_u32(0xffffffff), 3);
+    for (int i = 0; i < count; ++i)
+    {
+        const float* s = &src[i].vertices.x;
+        float* d = &dst[i].vertices.x;
+        float32x4_t p = vld1q_f32(s);
+        // separate multiplies and adds, so that the results match the scalar version
+        float32x4_t r = vmulq_n_f32(c0, vgetq_lane_f32(p, 0));
+        r = vaddq_f32(r, vmulq_n_f32(c1, vgetq_lane_f32(p, 1)));
+        r = vaddq_f32(r, vmulq_n_f32(c2, vgetq_lane_f32(p, 2)));
+        r = vaddq_f32(r, c3);
+        vst1q_f32(d, vbslq_f32(xyz, r, p));
+        vst1_f32(d + 4, vld1_f32(s + 4));
+    }
+}
+
+inline void MathUtilNeon::translateVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count)
+{
+    const float32x4_t t = vsetq_lane_f32(0.0f, vld1q_f32(m + 12), 3);
+    const uint32x4_t xyz = vsetq_lane_u32(0, vdupq_n_u32(0xffffffff), 3);
+    for (int i = 0; i < count; ++i)
+    {
+        const float* s = &src[i].vertices.x;
+        float* d = &dst[i].vertices.x;
+        float32x4_t p = vld1q_f32(s);
+        vst1q_f32(d, vbslq_f32(xyz, vaddq_f32(p, t), p));
+        vst1_f32(d + 4, vld1_f32(s + 4));
+    }
+}
+
+inline void MathUtilNeon::offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count)
+{
+    const uint16x8_t o = vdupq_n_u16(offset);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u16(dst + i, vaddq_u16(vld1q_u16(src + i), o));
+    }
+    MathUtilC::offsetIndices(dst + i, src + i, offset, count - i);
+}
+
+inline void MathUtilNeon::offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count)
+{
+    const uint32x4_t o = vdupq_n_u32(offset);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t v = vld1q_u16(src + i);
+        vst1q_u32(dst + i, vaddq_u32(vmovl_u16(vget_low_u16(v)), o));
+        vst1q_u32(dst + i + 4, vaddq_u32(vmovl_u16(vget_high_u16(v)), o));
+    }
+    MathUtilC::offsetIndices(dst + i, src + i, offset, count - i);
+}
+
+inline void MathUtilNeon::convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p;
+        p.val[0] = p.val[1] = p.val[2] = vld1_u8(src + i);
+        p.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(dst + i * 4, p);
+    }
+    MathUtilC::convertI8ToRGBA8888(src + i, dst + i * 4, count - i);
+}
+
+inline void MathUtilNeon::convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x2_t ia = vld2_u8(src + i * 2);
+        uint8x8x4_t p;
+        p.val[0] = p.val[1] = p.val[2] = ia.val[0];
+        p.val[3] = ia.val[1];
+        vst4_u8(dst + i * 4, p);
+    }
+    MathUtilC::convertAI88ToRGBA8888(src + i * 2, dst + i * 4, count - i);
+}
+
+inline void MathUtilNeon::convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x3_t rgb = vld3_u8(src + i * 3);
+        uint8x8x4_t p;
+        p.val[0] = rgb.val[0];
+        p.val[1] = rgb.val[1];
+        p.val[2] = rgb.val[2];
+        p.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(dst + i * 4, p);
+    }
+    MathUtilC::convertRGB888ToRGBA8888(src + i * 3, dst + i * 4, count - i);
+}
+
+inline void MathUtilNeon::convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        uint8x8x3_t rgb;
+        rgb.val[0] = p.val[0];
+        rgb.val[1] = p.val[1];
+        rgb.val[2] = p.val[2];
+        vst3_u8(dst + i * 3, rgb);
+    }
+    MathUtilC::convertRGBA8888ToRGB888(src + i * 4, dst + i * 3, count - i);
+}
+
+inline void MathUtilNeon::convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        vst1q_u8(dst + i, vld4q_u8(src + i * 4).val[3]);
+    }
+    MathUtilC::convertRGBA8888ToA8(src + i * 4, dst + i, count - i);
+}
+
+// (R & 0xF8) << 8 | (G & 0xFC) << 3 | (B & 0xF8) >> 3
+inline uint16x8_t MathUtilNeon::packRGB565(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+    uint16x8_t v = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+    v = vorrq_u16(v, vshll_n_u8(vand_u8(g, vdup_n_u8(0xFC)), 3));
+    return vorrq_u16(v, vmovl_u8(vshr_n_u8(b, 3)));
+}
+
+// (R & 0xF0) << 8 | (G & 0xF0) << 4 | (B & 0xF0) | (A & 0xF0) >> 4
+inline uint16x8_t MathUtilNeon::packRGBA4444(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint8x8_t high = vdup_n_u8(0xF0);
+    uint16x8_t v = vshll_n_u8(vand_u8(r, high), 8);
+    v = vorrq_u16(v, vshll_n_u8(vand_u8(g, high), 4));
+    v = vorrq_u16(v, vmovl_u8(vand_u8(b, high)));
+    return vorrq_u16(v, vmovl_u8(vshr_n_u8(a, 4)));
+}
+
+// (R & 0xF8) << 8 | (G & 0xF8) << 3 | (B & 0xF8) >> 2 | (A & 0x80) >> 7
+inline uint16x8_t MathUtilNeon::packRGB5A1(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    uint8x8_t high = vdup_n_u8(0xF8);
+    uint16x8_t v = vshll_n_u8(vand_u8(r, high), 8);
+    v = vorrq_u16(v, vshll_n_u8(vand_u8(g, high), 3));
+    v = vorrq_u16(v, vshll_n_u8(vshr_n_u8(b, 3), 1));
+    return vorrq_u16(v, vmovl_u8(vshr_n_u8(a, 7)));
+}
+
+inline void MathUtilNeon::convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x3_t p = vld3_u8(src + i * 3);
+        vst1q_u16(dst + i, packRGB565(p.val[0], p.val[1], p.val[2]));
+    }
+    MathUtilC::convertRGB888ToRGB565(src + i * 3, dst + i, count - i);
+}
+
+inline void MathUtilNeon::convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        vst1q_u16(dst + i, packRGB565(p.val[0], p.val[1], p.val[2]));
+    }
+    MathUtilC::convertRGBA8888ToRGB565(src + i * 4, dst + i, count - i);
+}
+
+inline void MathUtilNeon::convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x3_t p = vld3_u8(src + i * 3);
+        vst1q_u16(dst + i, packRGBA4444(p.val[0], p.val[1], p.val[2], vdup_n_u8(0xFF)));
+    }
+    MathUtilC::convertRGB888ToRGBA4444(src + i * 3, dst + i, count - i);
+}
+
+inline void MathUtilNeon::convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        vst1q_u16(dst + i, packRGBA4444(p.val[0], p.val[1], p.val[2], p.val[3]));
+    }
+    MathUtilC::convertRGBA8888ToRGBA4444(src + i * 4, dst + i, count - i);
+}
+
+inline void MathUtilNeon::convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x3_t p = vld3_u8(src + i * 3);
+        vst1q_u16(dst + i, packRGB5A1(p.val[0], p.val[1], p.val[2], vdup_n_u8(0xFF)));
+    }
+    MathUtilC::convertRGB888ToRGB5A1(src + i * 3, dst + i, count - i);
+}
+
+inline void MathUtilNeon::convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        vst1q_u16(dst + i, packRGB5A1(p.val[0], p.val[1], p.val[2], p.val[3]));
+    }
+    MathUtilC::convertRGBA8888ToRGB5A1(src + i * 4, dst + i, count - i);
+}
+
+inline void MathUtilNeon::premultiplyAlpha(unsigned char* rgba, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(rgba + i * 4);
+        // c * (a + 1) is at most 0xFF00
+        uint16x8_t a = vaddl_u8(p.val[3], vdup_n_u8(1));
+        p.val[0] = vshrn_n_u16(vmulq_u16(vmovl_u8(p.val[0]), a), 8);
+        p.val[1] = vshrn_n_u16(vmulq_u16(vmovl_u8(p.val[1]), a), 8);
+        p.val[2] = vshrn_n_u16(vmulq_u16(vmovl_u8(p.val[2]), a), 8);
+        vst4_u8(rgba + i * 4, p);
+    }
+    MathUtilC::premultiplyAlpha(rgba + i * 4, count - i);
+}
+
+inline void MathUtilNeon::reversePremultipliedAlpha(unsigned char* rgba, int count)
+{
+    // there is no vector division before ARMv8, and the reciprocal estimates would not give the same bytes
+    MathUtilC::reversePremultipliedAlpha(rgba, count);
+}
+
 NS_CC_MATH_END
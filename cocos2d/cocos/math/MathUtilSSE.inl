@@ -1,3 +1,12 @@
+#ifdef __SSE2__
+#include <emmintrin.h>
+#include <tmmintrin.h>
+// compiled for SSSE3 whatever the target, MathUtil checks the CPU before calling them
+#define CC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define CC_TARGET_SSSE3
+#endif
+
 NS_CC_MATH_BEGIN
 
 #ifdef __SSE__
@@ -151,6 +160,664 @@ void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128& dst)
                      );
 }
 
+class MathUtilSSE
+{
+public:
+    inline static void integrate(float* value, const float* delta, float dt, int count);
+
+    inline static void integrateNonNegative(float* value, const float* delta, float dt, int count);
+
+    inline static void minMax(const float* values, int count, float* min, float* max);
+
+    inline static void updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                                  const float* radialAccel, const float* tangentialAccel,
+                                                  float gravityX, float gravityY, float dt, float yFlip, int count);
+
+    inline static void updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                                 float* radius, const float* deltaRadius, float dt, float yFlip, int count);
+
+    inline static void fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                         const float* startPosX, const float* startPosY, const float* transform,
+                                         const float* size, const float* rotation,
+                                         const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                         bool premultiplyAlpha, int count);
+
+    inline static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count);
+
+    inline static void translateVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count);
+
+    inline static void offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count);
+
+    inline static void offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count);
+
+    inline static void convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    CC_TARGET_SSSE3 inline static void convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count);
+
+    CC_TARGET_SSSE3 inline static void convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count);
+
+    inline static void convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count);
+
+    CC_TARGET_SSSE3 inline static void convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count);
+
+    CC_TARGET_SSSE3 inline static void convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count);
+
+    CC_TARGET_SSSE3 inline static void convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count);
+
+    inline static void premultiplyAlpha(unsigned char* rgba, int count);
+
+    inline static void reversePremultipliedAlpha(unsigned char* rgba, int count);
+
+#ifdef __SSE2__
+    inline static void sincos(__m128 x, __m128* s, __m128* c);
+
+    inline static __m128i packRGB565(__m128i rgba);
+
+    inline static __m128i packRGBA4444(__m128i rgba);
+
+    inline static __m128i packRGB5A1(__m128i rgba);
+
+    CC_TARGET_SSSE3 inline static __m128i loadRGB888(const unsigned char* src);
+#endif
+};
+
+inline void MathUtilSSE::integrate(float* value, const float* delta, float dt, int count)
+{
+    __m128 t = _mm_set1_ps(dt);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(value + i);
+        __m128 d = _mm_loadu_ps(delta + i);
+        _mm_storeu_ps(value + i, _mm_add_ps(v, _mm_mul_ps(d, t)));
+    }
+    MathUtilC::integrate(value + i, delta + i, dt, count - i);
+}
+
+inline void MathUtilSSE::integrateNonNegative(float* value, const float* delta, float dt, int count)
+{
+    __m128 t = _mm_set1_ps(dt);
+    __m128 zero = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(value + i);
+        __m128 d = _mm_loadu_ps(delta + i);
+        // _mm_max_ps(a, b) is "a > b ? a : b", keep zero first to match the scalar MAX(0, v)
+        _mm_storeu_ps(value + i, _mm_max_ps(zero, _mm_add_ps(v, _mm_mul_ps(d, t))));
+    }
+    MathUtilC::integrateNonNegative(value + i, delta + i, dt, count - i);
+}
+
+inline void MathUtilSSE::minMax(const float* values, int count, float* min, float* max)
+{
+    int i = 0;
+    if (count >= 4)
+    {
+        __m128 lo = _mm_set1_ps(*min);
+        __m128 hi = _mm_set1_ps(*max);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(values + i);
+            lo = _mm_min_ps(lo, v);
+            hi = _mm_max_ps(hi, v);
+        }
+        // reduce the four lanes
+        lo = _mm_min_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 0, 3, 2)));
+        lo = _mm_min_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 3, 0, 1)));
+        hi = _mm_max_ps(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 0, 3, 2)));
+        hi = _mm_max_ps(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 3, 0, 1)));
+        _mm_store_ss(min, lo);
+        _mm_store_ss(max, hi);
+    }
+    MathUtilC::minMax(values + i, count - i, min, max);
+}
+
+inline void MathUtilSSE::updateParticlesGravityMode(float* posx, float* posy, float* dirX, float* dirY,
+                                                    const float* radialAccel, const float* tangentialAccel,
+                                                    float gravityX, float gravityY, float dt, float yFlip, int count)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 gx = _mm_set1_ps(gravityX);
+    const __m128 gy = _mm_set1_ps(gravityY);
+    const __m128 t = _mm_set1_ps(dt);
+    const __m128 flip = _mm_set1_ps(yFlip);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(posx + i);
+        __m128 y = _mm_loadu_ps(posy + i);
+
+        // normalize, lanes that are zero or already normalized keep a zero radial vector
+        __m128 n = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+        __m128 mask = _mm_and_ps(_mm_cmpneq_ps(n, zero), _mm_cmpneq_ps(n, one));
+        n = _mm_div_ps(one, _mm_sqrt_ps(n));
+        __m128 nx = _mm_and_ps(mask, _mm_mul_ps(x, n));
+        __m128 ny = _mm_and_ps(mask, _mm_mul_ps(y, n));
+
+        __m128 ra = _mm_loadu_ps(radialAccel + i);
+        __m128 ta = _mm_loadu_ps(tangentialAccel + i);
+        __m128 tmpx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ra), _mm_mul_ps(ny, _mm_xor_ps(ta, signMask))), gx);
+        __m128 tmpy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ny, ra), _mm_mul_ps(nx, ta)), gy);
+
+        __m128 dx = _mm_add_ps(_mm_loadu_ps(dirX + i), _mm_mul_ps(tmpx, t));
+        __m128 dy = _mm_add_ps(_mm_loadu_ps(dirY + i), _mm_mul_ps(tmpy, t));
+        _mm_storeu_ps(dirX + i, dx);
+        _mm_storeu_ps(dirY + i, dy);
+
+        _mm_storeu_ps(posx + i, _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(dx, t), flip)));
+        _mm_storeu_ps(posy + i, _mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(dy, t), flip)));
+    }
+    MathUtilC::updateParticlesGravityMode(posx + i, posy + i, dirX + i, dirY + i, radialAccel + i, tangentialAccel + i,
+                                          gravityX, gravityY, dt, yFlip, count - i);
+}
+
+inline void MathUtilSSE::updateParticlesRadiusMode(float* posx, float* posy, float* angle, const float* degreesPerSecond,
+                                                   float* radius, const float* deltaRadius, float dt, float yFlip, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 t = _mm_set1_ps(dt);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 flip = _mm_set1_ps(yFlip);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(angle + i), _mm_mul_ps(_mm_loadu_ps(degreesPerSecond + i), t));
+        __m128 r = _mm_add_ps(_mm_loadu_ps(radius + i), _mm_mul_ps(_mm_loadu_ps(deltaRadius + i), t));
+        _mm_storeu_ps(angle + i, a);
+        _mm_storeu_ps(radius + i, r);
+
+        __m128 s, c;
+        sincos(a, &s, &c);
+        _mm_storeu_ps(posx + i, _mm_mul_ps(_mm_xor_ps(c, signMask), r));
+        _mm_storeu_ps(posy + i, _mm_mul_ps(_mm_mul_ps(_mm_xor_ps(s, signMask), r), flip));
+    }
+#endif
+    MathUtilC::updateParticlesRadiusMode(posx + i, posy + i, angle + i, degreesPerSecond + i,
+                                         radius + i, deltaRadius + i, dt, yFlip, count - i);
+}
+
+inline void MathUtilSSE::fillParticleQuads(V3F_C4B_T2F_Quad* quads, const float* posx, const float* posy,
+                                           const float* startPosX, const float* startPosY, const float* transform,
+                                           const float* size, const float* rotation,
+                                           const float* colorR, const float* colorG, const float* colorB, const float* colorA,
+                                           bool premultiplyAlpha, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 t0 = _mm_set1_ps(transform[0]);
+    const __m128 t1 = _mm_set1_ps(transform[1]);
+    const __m128 t2 = _mm_set1_ps(transform[2]);
+    const __m128 t3 = _mm_set1_ps(transform[3]);
+    const __m128 t4 = _mm_set1_ps(transform[4]);
+    const __m128 t5 = _mm_set1_ps(transform[5]);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 toRadians = _mm_set1_ps(-0.01745329252f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 sx = _mm_loadu_ps(startPosX + i);
+        __m128 sy = _mm_loadu_ps(startPosY + i);
+        __m128 x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_loadu_ps(posx + i), _mm_mul_ps(t0, sx)), _mm_mul_ps(t2, sy)), t4);
+        __m128 y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_loadu_ps(posy + i), _mm_mul_ps(t1, sx)), _mm_mul_ps(t3, sy)), t5);
+        __m128 h = _mm_mul_ps(_mm_loadu_ps(size + i), half);
+        __m128 hc = h;
+        __m128 hs = _mm_setzero_ps();
+        __m128 r = _mm_loadu_ps(rotation + i);
+        if (_mm_movemask_ps(_mm_cmpneq_ps(r, _mm_setzero_ps())))
+        {
+            __m128 sr, cr;
+            sincos(_mm_mul_ps(r, toRadians), &sr, &cr);
+            hc = _mm_mul_ps(h, cr);
+            hs = _mm_mul_ps(h, sr);
+        }
+
+        __m128 blx = _mm_add_ps(_mm_sub_ps(x, hc), hs);
+        __m128 bly = _mm_sub_ps(_mm_sub_ps(y, hs), hc);
+        __m128 brx = _mm_add_ps(_mm_add_ps(x, hc), hs);
+        __m128 bry = _mm_sub_ps(_mm_add_ps(y, hs), hc);
+        __m128 trx = _mm_sub_ps(_mm_add_ps(x, hc), hs);
+        __m128 tr_y = _mm_add_ps(_mm_add_ps(y, hs), hc);
+        __m128 tlx = _mm_sub_ps(_mm_sub_ps(x, hc), hs);
+        __m128 tly = _mm_add_ps(_mm_sub_ps(y, hs), hc);
+
+        // colors: the four channels of each particle packed in 32 bits, saturated
+        __m128 a = _mm_loadu_ps(colorA + i);
+        __m128 m = premultiplyAlpha ? a : one;
+        __m128i cr = _mm_cvttps_epi32(_mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(colorR + i), m), scale));
+        __m128i cg = _mm_cvttps_epi32(_mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(colorG + i), m), scale));
+        __m128i cb = _mm_cvttps_epi32(_mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(colorB + i), m), scale));
+        __m128i ca = _mm_cvttps_epi32(_mm_mul_ps(a, scale));
+        // r0..r3 b0..b3 g0..g3 a0..a3, then interleaved twice to r0 g0 b0 a0 r1 g1 b1 a1...
+        __m128i c = _mm_packus_epi16(_mm_packs_epi32(cr, cb), _mm_packs_epi32(cg, ca));
+        c = _mm_unpacklo_epi8(c, _mm_srli_si128(c, 8));
+        c = _mm_unpacklo_epi16(c, _mm_srli_si128(c, 8));
+
+        // x and y of two particles per register
+        __m128 bl01 = _mm_unpacklo_ps(blx, bly), bl23 = _mm_unpackhi_ps(blx, bly);
+        __m128 br01 = _mm_unpacklo_ps(brx, bry), br23 = _mm_unpackhi_ps(brx, bry);
+        __m128 tr01 = _mm_unpacklo_ps(trx, tr_y), tr23 = _mm_unpackhi_ps(trx, tr_y);
+        __m128 tl01 = _mm_unpacklo_ps(tlx, tly), tl23 = _mm_unpackhi_ps(tlx, tly);
+
+        V3F_C4B_T2F_Quad* quad = quads + i;
+#define CC_STORE_PARTICLE_QUAD(n, lo, store)\
+        store((__m64*)&quad[n].bl.vertices, bl##lo);\
+        store((__m64*)&quad[n].br.vertices, br##lo);\
+        store((__m64*)&quad[n].tr.vertices, tr##lo);\
+        store((__m64*)&quad[n].tl.vertices, tl##lo);\
+        {\
+            int packed = _mm_cvtsi128_si32(c);\
+            memcpy(reinterpret_cast<GLubyte*>(&quad[n].bl.colors), &packed, 4);\
+            memcpy(reinterpret_cast<GLubyte*>(&quad[n].br.colors), &packed, 4);\
+            memcpy(reinterpret_cast<GLubyte*>(&quad[n].tr.colors), &packed, 4);\
+            memcpy(reinterpret_cast<GLubyte*>(&quad[n].tl.colors), &packed, 4);\
+            c = _mm_srli_si128(c, 4);\
+        }
+        CC_STORE_PARTICLE_QUAD(0, 01, _mm_storel_pi)
+        CC_STORE_PARTICLE_QUAD(1, 01, _mm_storeh_pi)
+        CC_STORE_PARTICLE_QUAD(2, 23, _mm_storel_pi)
+        CC_STORE_PARTICLE_QUAD(3, 23, _mm_storeh_pi)
+#undef CC_STORE_PARTICLE_QUAD
+    }
+#endif
+    MathUtilC::fillParticleQuads(quads + i, posx + i, posy + i, startPosX + i, startPosY + i, transform,
+                                 size + i, rotation + i, colorR + i, colorG + i, colorB + i, colorA + i,
+                                 premultiplyAlpha, count - i);
+}
+
+inline void MathUtilSSE::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+    // x, y and z come from the result, the color bytes from the source
+    const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    for (; i < count; ++i)
+    {
+        const float* s = &src[i].vertices.x;
+        float* d = &dst[i].vertices.x;
+        __m128 p = _mm_loadu_ps(s);
+        __m128 r = _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)), c0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)), c1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), c2));
+        r = _mm_add_ps(r, c3);
+        _mm_storeu_ps(d, _mm_or_ps(_mm_and_ps(xyz, r), _mm_andnot_ps(xyz, p)));
+        _mm_storel_epi64((__m128i*)(d + 4), _mm_loadl_epi64((const __m128i*)(s + 4)));
+    }
+#endif
+    MathUtilC::transformVertices(dst + i, src + i, m, count - i);
+}
+
+inline void MathUtilSSE::translateVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, const float* m, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 t = _mm_set_ps(0.0f, m[14], m[13], m[12]);
+    const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    for (; i < count; ++i)
+    {
+        const float* s = &src[i].vertices.x;
+        float* d = &dst[i].vertices.x;
+        __m128 p = _mm_loadu_ps(s);
+        __m128 r = _mm_add_ps(p, t);
+        _mm_storeu_ps(d, _mm_or_ps(_mm_and_ps(xyz, r), _mm_andnot_ps(xyz, p)));
+        _mm_storel_epi64((__m128i*)(d + 4), _mm_loadl_epi64((const __m128i*)(s + 4)));
+    }
+#endif
+    MathUtilC::translateVertices(dst + i, src + i, m, count - i);
+}
+
+inline void MathUtilSSE::offsetIndices(unsigned short* dst, const unsigned short* src, unsigned short offset, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i o = _mm_set1_epi16((short) offset);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi16(v, o));
+    }
+#endif
+    MathUtilC::offsetIndices(dst + i, src + i, offset, count - i);
+}
+
+inline void MathUtilSSE::offsetIndices(unsigned int* dst, const unsigned short* src, unsigned int offset, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i o = _mm_set1_epi32((int) offset);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(_mm_unpacklo_epi16(v, zero), o));
+        _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_add_epi32(_mm_unpackhi_epi16(v, zero), o));
+    }
+#endif
+    MathUtilC::offsetIndices(dst + i, src + i, offset, count - i);
+}
+
+#ifdef __SSE2__
+// narrows 32 bit lanes holding 16 bit values, packs_epi32 would saturate the values above 0x7FFF
+#define CC_PACK_LOW16(lo, hi) _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16))
+#endif
+
+inline void MathUtilSSE::convertI8ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i alpha = _mm_set1_epi8((char) 0xFF);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        // II and IA pairs, interleaved to IIIA
+        __m128i ii = _mm_unpacklo_epi8(v, v);
+        __m128i ia = _mm_unpacklo_epi8(v, alpha);
+        _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_unpacklo_epi16(ii, ia));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(ii, ia));
+        ii = _mm_unpackhi_epi8(v, v);
+        ia = _mm_unpackhi_epi8(v, alpha);
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 32), _mm_unpacklo_epi16(ii, ia));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 48), _mm_unpackhi_epi16(ii, ia));
+    }
+#endif
+    MathUtilC::convertI8ToRGBA8888(src + i, dst + i * 4, count - i);
+}
+
+inline void MathUtilSSE::convertAI88ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i ia = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        __m128i ii = _mm_and_si128(ia, lowByte);
+        ii = _mm_or_si128(ii, _mm_slli_epi16(ii, 8));
+        _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_unpacklo_epi16(ii, ia));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(ii, ia));
+    }
+#endif
+    MathUtilC::convertAI88ToRGBA8888(src + i * 2, dst + i * 4, count - i);
+}
+
+CC_TARGET_SSSE3 inline void MathUtilSSE::convertRGB888ToRGBA8888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    // 16 bytes are read for 4 pixels, stop while the next 2 pixels are there
+    for (; i + 6 <= count; i += 4)
+    {
+        _mm_storeu_si128((__m128i*)(dst + i * 4), loadRGB888(src + i * 3));
+    }
+#endif
+    MathUtilC::convertRGB888ToRGBA8888(src + i * 3, dst + i * 4, count - i);
+}
+
+CC_TARGET_SSSE3 inline void MathUtilSSE::convertRGBA8888ToRGB888(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 4)), shuffle);
+        // 12 bytes
+        _mm_storel_epi64((__m128i*)(dst + i * 3), v);
+        int last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+        memcpy(dst + i * 3 + 8, &last, 4);
+    }
+#endif
+    MathUtilC::convertRGBA8888ToRGB888(src + i * 4, dst + i * 3, count - i);
+}
+
+inline void MathUtilSSE::convertRGBA8888ToA8(const unsigned char* src, unsigned char* dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a0 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(src + i * 4)), 24);
+        __m128i a1 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(src + i * 4 + 16)), 24);
+        __m128i a2 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(src + i * 4 + 32)), 24);
+        __m128i a3 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(src + i * 4 + 48)), 24);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)));
+    }
+#endif
+    MathUtilC::convertRGBA8888ToA8(src + i * 4, dst + i, count - i);
+}
+
+#ifdef __SSE2__
+// a pixel is 0xAABBGGRR in a 32 bit lane, the 16 bit result is left in the low half of the lane
+
+inline __m128i MathUtilSSE::packRGB565(__m128i v)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF8)), 8),
+                                     _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xFC00)), 5)),
+                        _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF80000)), 19));
+}
+
+inline __m128i MathUtilSSE::packRGBA4444(__m128i v)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF0)), 8),
+                                     _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF000)), 4)),
+                        _mm_or_si128(_mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF00000)), 16),
+                                     _mm_srli_epi32(v, 28)));
+}
+
+inline __m128i MathUtilSSE::packRGB5A1(__m128i v)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF8)), 8),
+                                     _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF800)), 5)),
+                        _mm_or_si128(_mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF80000)), 18),
+                                     _mm_srli_epi32(v, 31)));
+}
+
+// 4 RGB888 pixels as opaque RGBA8888, 16 bytes are read
+CC_TARGET_SSSE3 inline __m128i MathUtilSSE::loadRGB888(const unsigned char* src)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), shuffle);
+    return _mm_or_si128(v, _mm_set1_epi32((int) 0xFF000000));
+}
+#endif
+
+// the 16 bit conversions of RGB888 go through opaque RGBA8888, the alpha bits being then all set as in the C versions;
+// 8 pixels, 24 bytes, are converted at a time and the last load reads 16 bytes from the 19th: stop while 2 more pixels are there
+#define CC_CONVERT_TO_16BIT(pack, load, bpp, extra)\
+    int i = 0;\
+    for (; i + 8 + extra <= count; i += 8)\
+    {\
+        __m128i lo = pack(load(src + i * bpp));\
+        __m128i hi = pack(load(src + i * bpp + 4 * bpp));\
+        _mm_storeu_si128((__m128i*)(dst + i), CC_PACK_LOW16(lo, hi));\
+    }
+
+#define CC_LOAD_RGBA8888(src) _mm_loadu_si128((const __m128i*)(src))
+
+CC_TARGET_SSSE3 inline void MathUtilSSE::convertRGB888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef __SSE2__
+    CC_CONVERT_TO_16BIT(packRGB565, loadRGB888, 3, 2)
+#else
+    int i = 0;
+#endif
+    MathUtilC::convertRGB888ToRGB565(src + i * 3, dst + i, count - i);
+}
+
+inline void MathUtilSSE::convertRGBA8888ToRGB565(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef __SSE2__
+    CC_CONVERT_TO_16BIT(packRGB565, CC_LOAD_RGBA8888, 4, 0)
+#else
+    int i = 0;
+#endif
+    MathUtilC::convertRGBA8888ToRGB565(src + i * 4, dst + i, count - i);
+}
+
+CC_TARGET_SSSE3 inline void MathUtilSSE::convertRGB888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef __SSE2__
+    CC_CONVERT_TO_16BIT(packRGBA4444, loadRGB888, 3, 2)
+#else
+    int i = 0;
+#endif
+    MathUtilC::convertRGB888ToRGBA4444(src + i * 3, dst + i, count - i);
+}
+
+inline void MathUtilSSE::convertRGBA8888ToRGBA4444(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef __SSE2__
+    CC_CONVERT_TO_16BIT(packRGBA4444, CC_LOAD_RGBA8888, 4, 0)
+#else
+    int i = 0;
+#endif
+    MathUtilC::convertRGBA8888ToRGBA4444(src + i * 4, dst + i, count - i);
+}
+
+CC_TARGET_SSSE3 inline void MathUtilSSE::convertRGB888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef __SSE2__
+    CC_CONVERT_TO_16BIT(packRGB5A1, loadRGB888, 3, 2)
+#else
+    int i = 0;
+#endif
+    MathUtilC::convertRGB888ToRGB5A1(src + i * 3, dst + i, count - i);
+}
+
+inline void MathUtilSSE::convertRGBA8888ToRGB5A1(const unsigned char* src, unsigned short* dst, int count)
+{
+#ifdef __SSE2__
+    CC_CONVERT_TO_16BIT(packRGB5A1, CC_LOAD_RGBA8888, 4, 0)
+#else
+    int i = 0;
+#endif
+    MathUtilC::convertRGBA8888ToRGB5A1(src + i * 4, dst + i, count - i);
+}
+
+#undef CC_LOAD_RGBA8888
+#undef CC_CONVERT_TO_16BIT
+
+inline void MathUtilSSE::premultiplyAlpha(unsigned char* rgba, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    // the alpha channel is kept
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+        __m128i c[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+        for (int j = 0; j < 2; ++j)
+        {
+            __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c[j], _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            // c * (a + 1) is at most 0xFF00
+            __m128i m = _mm_srli_epi16(_mm_mullo_epi16(c[j], _mm_add_epi16(a, one)), 8);
+            c[j] = _mm_or_si128(_mm_andnot_si128(alphaMask, m), _mm_and_si128(alphaMask, c[j]));
+        }
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_packus_epi16(c[0], c[1]));
+    }
+#endif
+    MathUtilC::premultiplyAlpha(rgba + i * 4, count - i);
+}
+
+inline void MathUtilSSE::reversePremultipliedAlpha(unsigned char* rgba, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32((int) 0xFF000000);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+        __m128i c16[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+        __m128i c32[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            // one pixel per vector
+            __m128i c = (j & 1) ? _mm_unpackhi_epi16(c16[j >> 1], zero) : _mm_unpacklo_epi16(c16[j >> 1], zero);
+            __m128 f = _mm_cvtepi32_ps(c);
+            __m128 a = _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3));
+            // same operations as the scalar version, then ceil() of a positive value
+            __m128 q = _mm_div_ps(_mm_mul_ps(f, scale), a);
+            __m128i t = _mm_cvttps_epi32(q);
+            t = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmplt_ps(_mm_cvtepi32_ps(t), q)));
+            c32[j] = t;
+        }
+        // the saturation of the packs clamps to 255
+        __m128i r = _mm_packus_epi16(_mm_packs_epi32(c32[0], c32[1]), _mm_packs_epi32(c32[2], c32[3]));
+        // alpha, and the whole pixel when alpha is 0, are kept
+        __m128i keep = _mm_or_si128(alphaMask, _mm_cmpeq_epi32(_mm_and_si128(v, alphaMask), zero));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, r)));
+    }
+#endif
+    MathUtilC::reversePremultipliedAlpha(rgba + i * 4, count - i);
+}
+
+#ifdef __SSE2__
+#undef CC_PACK_LOW16
+// Cephes style sin/cos: reduce to [-pi/4, pi/4] in extended precision, then evaluate both minimax polynomials.
+inline void MathUtilSSE::sincos(__m128 x, __m128* s, __m128* c)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 signSin = _mm_and_ps(x, signMask);
+    x = _mm_andnot_ps(signMask, x);
+
+    // octant index j = (int)(x * 4 / pi), rounded up to an even number
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+    j = _mm_add_epi32(j, _mm_set1_epi32(1));
+    j = _mm_and_si128(j, _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+
+    __m128 swapSignSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+    __m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+    __m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+    signSin = _mm_xor_ps(signSin, swapSignSin);
+
+    // x - y * pi / 4, with pi / 4 split in three parts
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-0.78515625f)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-2.4187564849853515625e-4f)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-3.77489497744594108e-8f)));
+    __m128 z = _mm_mul_ps(x, x);
+
+    __m128 yc = _mm_set1_ps(2.443315711809948e-5f);
+    yc = _mm_add_ps(_mm_mul_ps(yc, z), _mm_set1_ps(-1.388731625493765e-3f));
+    yc = _mm_add_ps(_mm_mul_ps(yc, z), _mm_set1_ps(4.166664568298827e-2f));
+    yc = _mm_mul_ps(_mm_mul_ps(yc, z), z);
+    yc = _mm_sub_ps(yc, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    yc = _mm_add_ps(yc, _mm_set1_ps(1.0f));
+
+    __m128 ys = _mm_set1_ps(-1.9515295891e-4f);
+    ys = _mm_add_ps(_mm_mul_ps(ys, z), _mm_set1_ps(8.3321608736e-3f));
+    ys = _mm_add_ps(_mm_mul_ps(ys, z), _mm_set1_ps(-1.6666654611e-1f));
+    ys = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ys, z), x), x);
+
+    // pick the polynomial for each output depending on the octant
+    __m128 sinv = _mm_or_ps(_mm_and_ps(polyMask, ys), _mm_andnot_ps(polyMask, yc));
+    __m128 cosv = _mm_or_ps(_mm_and_ps(polyMask, yc), _mm_andnot_ps(polyMask, ys));
+    *s = _mm_xor_ps(sinv, signSin);
+    *c = _mm_xor_ps(cosv, signCos);
+}
+#endif
+
 #endif
 
 
@@ -0,0 +1,325 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "platform/CCAssetPack.h"
+#include <algorithm>
+#include <zlib.h>
+
+NS_CC_BEGIN
+
+const char* AssetPack::FILE_EXTENSION = ".ccpack";
+
+namespace
+{
+    const char PACK_MAGIC[4] = { 'C', 'C', 'P', 'K' };
+    const uint32_t PACK_VERSION = 1;
+    // the raw entries are aligned for the consumers reading them in place
+    const uint64_t PACK_ALIGNMENT = 16;
+}
+
+// little endian, all the offsets are from the start of the pack
+struct AssetPack::Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+struct AssetPack::Entry
+{
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t originalSize;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t compression;
+    uint32_t reserved;
+};
+
+AssetPack::AssetPack()
+: _entryCount(0)
+{
+}
+
+bool AssetPack::open(const std::string& fullPath)
+{
+    _entryCount = 0;
+    _path.clear();
+    if (!_file.open(fullPath))
+    {
+        return false;
+    }
+
+    const unsigned char* bytes = _file.getBytes();
+    uint64_t size = (uint64_t)_file.getSize();
+    Header header;
+    if (size < sizeof(header))
+    {
+        _file.close();
+        return false;
+    }
+    memcpy(&header, bytes, sizeof(header));
+
+    bool valid = memcmp(header.magic, PACK_MAGIC, sizeof(header.magic)) == 0
+        && header.version == PACK_VERSION
+        && sizeof(Header) + (uint64_t)header.entryCount * sizeof(Entry) <= size
+        && header.namesOffset <= size && header.namesSize <= size - header.namesOffset;
+    // readEntry() fills buffers of originalSize bytes, and findEntry() does a binary search on the names
+    const char* names = reinterpret_cast<const char*>(bytes + header.namesOffset);
+    for (uint32_t i = 0; valid && i < header.entryCount; ++i)
+    {
+        const Entry* entry = reinterpret_cast<const Entry*>(bytes + sizeof(Header)) + i;
+        valid = entry->offset <= size && entry->storedSize <= size - entry->offset
+            && entry->originalSize <= 0xFFFFFFFFu
+            && (uint64_t)entry->nameOffset + entry->nameLength <= header.namesSize
+            && ((entry->compression == (uint32_t)Compression::NONE && entry->storedSize == entry->originalSize)
+                || entry->compression == (uint32_t)Compression::ZLIB);
+        if (valid && i > 0)
+        {
+            const Entry* previous = entry - 1;
+            int result = memcmp(names + previous->nameOffset, names + entry->nameOffset, std::min(previous->nameLength, entry->nameLength));
+            valid = result < 0 || (result == 0 && previous->nameLength < entry->nameLength);
+        }
+    }
+    if (!valid)
+    {
+        CCLOG("cocos2d: AssetPack: %s is not a valid pack", fullPath.c_str());
+        _file.close();
+        return false;
+    }
+
+    _entryCount = header.entryCount;
+    _path = fullPath;
+    return true;
+}
+
+const AssetPack::Entry* AssetPack::getEntry(int index) const
+{
+    return reinterpret_cast<const Entry*>(_file.getBytes() + sizeof(Header)) + index;
+}
+
+int AssetPack::findEntry(const std::string& name) const
+{
+    if (_entryCount == 0)
+    {
+        return -1;
+    }
+
+    const unsigned char* bytes = _file.getBytes();
+    const char* names = reinterpret_cast<const char*>(bytes + reinterpret_cast<const Header*>(bytes)->namesOffset);
+    const Entry* first = getEntry(0);
+    const Entry* last = first + _entryCount;
+    auto compare = [names](const Entry& entry, const std::string& key) {
+        int result = memcmp(names + entry.nameOffset, key.data(), std::min((size_t)entry.nameLength, key.size()));
+        return result < 0 || (result == 0 && entry.nameLength < key.size());
+    };
+    const Entry* entry = std::lower_bound(first, last, name, compare);
+    if (entry == last || entry->nameLength != name.size() || memcmp(names + entry->nameOffset, name.data(), name.size()) != 0)
+    {
+        return -1;
+    }
+    return (int)(entry - first);
+}
+
+ssize_t AssetPack::getEntrySize(const std::string& name) const
+{
+    int index = findEntry(name);
+    return index >= 0 ? (ssize_t)getEntry(index)->originalSize : -1;
+}
+
+const unsigned char* AssetPack::getEntryBytes(const std::string& name, ssize_t* size) const
+{
+    int index = findEntry(name);
+    if (index < 0)
+    {
+        return nullptr;
+    }
+
+    const Entry* entry = getEntry(index);
+    if (entry->compression != (uint32_t)Compression::NONE)
+    {
+        return nullptr;
+    }
+    *size = (ssize_t)entry->storedSize;
+    return _file.getBytes() + entry->offset;
+}
+
+FileUtils::Status AssetPack::readEntry(const std::string& name, ResizableBuffer* buffer) const
+{
+    int index = findEntry(name);
+    if (index < 0)
+    {
+        return FileUtils::Status::NotExists;
+    }
+
+    const Entry* entry = getEntry(index);
+    const unsigned char* stored = _file.getBytes() + entry->offset;
+    buffer->resize((size_t)entry->originalSize);
+    if (entry->originalSize == 0)
+    {
+        return FileUtils::Status::OK;
+    }
+    if (entry->compression == (uint32_t)Compression::NONE)
+    {
+        memcpy(buffer->buffer(), stored, (size_t)entry->storedSize);
+        return FileUtils::Status::OK;
+    }
+
+    uLongf length = (uLongf)entry->originalSize;
+    if (uncompress(static_cast<Bytef*>(buffer->buffer()), &length, stored, (uLong)entry->storedSize) != Z_OK || length != entry->originalSize)
+    {
+        buffer->resize(0);
+        return FileUtils::Status::ReadFailed;
+    }
+    return FileUtils::Status::OK;
+}
+
+std::vector<std::string> AssetPack::getEntryNames() const
+{
+    std::vector<std::string> entryNames;
+    if (_entryCount == 0)
+    {
+        return entryNames;
+    }
+
+    const unsigned char* bytes = _file.getBytes();
+    const char* names = reinterpret_cast<const char*>(bytes + reinterpret_cast<const Header*>(bytes)->namesOffset);
+    entryNames.reserve(_entryCount);
+    for (unsigned int i = 0; i < _entryCount; ++i)
+    {
+        const Entry* entry = getEntry(i);
+        entryNames.emplace_back(names + entry->nameOffset, entry->nameLength);
+    }
+    return entryNames;
+}
+
+void AssetPackWriter::addEntry(const std::string& name, const Data& data, AssetPack::Compression compression)
+{
+    PendingEntry entry;
+    entry.name = name;
+    entry.originalSize = (size_t)data.getSize();
+    entry.compression = AssetPack::Compression::NONE;
+    if (compression == AssetPack::Compression::ZLIB && !data.isNull())
+    {
+        uLongf length = compressBound((uLong)data.getSize());
+        auto compressed = static_cast<unsigned char*>(malloc(length));
+        if (compressed && compress2(compressed, &length, data.getBytes(), (uLong)data.getSize(), Z_BEST_COMPRESSION) == Z_OK
+            && length < (uLongf)data.getSize())
+        {
+            entry.data.fastSet(compressed, (ssize_t)length);
+            entry.compression = AssetPack::Compression::ZLIB;
+        }
+        else
+        {
+            free(compressed);
+        }
+    }
+    if (entry.compression == AssetPack::Compression::NONE)
+    {
+        entry.data = data;
+    }
+
+    auto iter = std::find_if(_entries.begin(), _entries.end(), [&name](const PendingEntry& pending) {
+        return pending.name == name;
+    });
+    if (iter != _entries.end())
+    {
+        *iter = std::move(entry);
+    }
+    else
+    {
+        _entries.push_back(std::move(entry));
+    }
+}
+
+bool AssetPackWriter::write(const std::string& fullPath) const
+{
+    // looked up by binary search
+    std::vector<const PendingEntry*> sorted;
+    sorted.reserve(_entries.size());
+    for (const auto& entry : _entries)
+    {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const PendingEntry* a, const PendingEntry* b) {
+        return a->name < b->name;
+    });
+
+    std::string names;
+    std::vector<AssetPack::Entry> entries(sorted.size());
+    uint64_t offset = sizeof(AssetPack::Header) + sorted.size() * sizeof(AssetPack::Entry);
+    uint64_t namesOffset = offset;
+    for (const auto pending : sorted)
+    {
+        names += pending->name;
+    }
+    offset += names.size();
+    for (size_t i = 0, nameOffset = 0; i < sorted.size(); ++i)
+    {
+        offset = (offset + PACK_ALIGNMENT - 1) & ~(PACK_ALIGNMENT - 1);
+        auto& entry = entries[i];
+        entry.offset = offset;
+        entry.storedSize = (uint64_t)sorted[i]->data.getSize();
+        entry.originalSize = sorted[i]->originalSize;
+        entry.nameOffset = (uint32_t)nameOffset;
+        entry.nameLength = (uint32_t)sorted[i]->name.size();
+        entry.compression = (uint32_t)sorted[i]->compression;
+        entry.reserved = 0;
+        nameOffset += sorted[i]->name.size();
+        offset += entry.storedSize;
+    }
+
+    AssetPack::Header header;
+    memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+    header.version = PACK_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.reserved = 0;
+    header.namesOffset = namesOffset;
+    header.namesSize = names.size();
+
+    FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+        && (entries.empty() || fwrite(entries.data(), sizeof(AssetPack::Entry), entries.size(), fp) == entries.size())
+        && fwrite(names.data(), 1, names.size(), fp) == names.size();
+    uint64_t position = namesOffset + names.size();
+    static const char padding[PACK_ALIGNMENT] = {};
+    for (size_t i = 0; written && i < entries.size(); ++i)
+    {
+        written = fwrite(padding, 1, (size_t)(entries[i].offset - position), fp) == entries[i].offset - position
+            && fwrite(sorted[i]->data.getBytes(), 1, (size_t)entries[i].storedSize, fp) == entries[i].storedSize;
+        position = entries[i].offset + entries[i].storedSize;
+    }
+    written = fclose(fp) == 0 && written;
+    return written;
+}
+
+NS_CC_END
@@ -0,0 +1,162 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCASSETPACK_H_
+#define __CCASSETPACK_H_
+
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCMappedFile.h"
+#include "platform/CCFileUtils.h"
+#include "base/CCData.h"
+#include <string>
+#include <vector>
+
+/**
+* @addtogroup platform
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class AssetPack
+ * @brief Read-only archive of asset files, mounted as a search path by FileUtils::addAssetPack().
+ *
+ * A pack starts with a header, followed by the entries sorted by name, their names and their contents.
+ * Each entry is stored raw or zlib compressed. The pack is memory mapped, so the raw entries
+ * can be read in place, without copying them.
+ * Packs are written by AssetPackWriter, or by the ccpack command line tool.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL AssetPack
+{
+public:
+    /** Compression of an entry. */
+    enum class Compression
+    {
+        NONE,
+        ZLIB,
+    };
+
+    /** Extension of the pack files. */
+    static const char* FILE_EXTENSION;
+
+    AssetPack();
+
+    /**
+     * Maps a pack, closing the previous one.
+     *
+     * @param fullPath full path of the pack.
+     * @return false if the file can't be opened or is not a valid pack.
+     */
+    bool open(const std::string& fullPath);
+
+    /** Gets the full path of the pack. */
+    const std::string& getPath() const { return _path; }
+
+    /** Gets the number of entries. */
+    unsigned int getEntryCount() const { return _entryCount; }
+
+    /** Returns whether the pack contains an entry, given its path relative to the pack. */
+    bool hasEntry(const std::string& name) const { return findEntry(name) >= 0; }
+
+    /** Gets the size of an entry once uncompressed, -1 if the pack doesn't contain it. */
+    ssize_t getEntrySize(const std::string& name) const;
+
+    /**
+     * Gets the bytes of a raw entry in the mapped pack.
+     *
+     * @param name path of the entry, relative to the pack.
+     * @param size set to the size of the entry.
+     * @return the bytes, valid until the pack is closed, or nullptr if the entry is missing or compressed.
+     */
+    const unsigned char* getEntryBytes(const std::string& name, ssize_t* size) const;
+
+    /**
+     * Copies or uncompresses an entry into a buffer.
+     *
+     * @param name path of the entry, relative to the pack.
+     * @param buffer the buffer, resized to the size of the entry.
+     * @return FileUtils::Status::OK, or the reason of the failure.
+     */
+    FileUtils::Status readEntry(const std::string& name, ResizableBuffer* buffer) const;
+
+    /** Gets the names of the entries, in order. */
+    std::vector<std::string> getEntryNames() const;
+
+protected:
+    friend class AssetPackWriter;
+    struct Header;
+    struct Entry;
+
+    int findEntry(const std::string& name) const;
+    const Entry* getEntry(int index) const;
+
+    MappedFile _file;
+    std::string _path;
+    unsigned int _entryCount;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(AssetPack);
+};
+
+/**
+ * @class AssetPackWriter
+ * @brief Collects files and writes them as an AssetPack.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL AssetPackWriter
+{
+public:
+    /**
+     * Adds an entry, replacing the entry of the same name.
+     *
+     * @param name path of the entry, relative to the pack, with '/' separators.
+     * @param data contents of the entry.
+     * @param compression zlib is only kept when it makes the entry smaller.
+     */
+    void addEntry(const std::string& name, const Data& data, AssetPack::Compression compression);
+
+    /** Writes the pack, returns false if the file can't be written. */
+    bool write(const std::string& fullPath) const;
+
+    /** Gets the number of entries. */
+    size_t getEntryCount() const { return _entries.size(); }
+
+protected:
+    struct PendingEntry
+    {
+        std::string name;
+        Data data;
+        size_t originalSize;
+        AssetPack::Compression compression;
+    };
+    std::vector<PendingEntry> _entries;
+};
+
+NS_CC_END
+/** @} */
+#endif //__CCASSETPACK_H_
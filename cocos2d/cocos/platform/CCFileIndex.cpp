@@ -0,0 +1,109 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "platform/CCFileIndex.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+FileIndex::FileIndex(const std::vector<std::string>& searchPaths, const std::vector<std::string>& resolutions,
+                     const std::unordered_map<std::string, std::string>& filenameLookup)
+: _searchPaths(searchPaths)
+, _resolutions(resolutions)
+, _filenameLookup(filenameLookup)
+{
+}
+
+const std::string& FileIndex::getNewFilename(const std::string& filename) const
+{
+    auto iter = _filenameLookup.find(filename);
+    return iter != _filenameLookup.end() ? iter->second : filename;
+}
+
+void FileIndex::addDirectory(const std::string& dirPath, const std::vector<std::string>& entries)
+{
+    for (const auto& entry : entries)
+    {
+        if (!entry.empty() && entry.back() != '/')
+        {
+            _files.insert(entry);
+        }
+    }
+    _directories[dirPath] = entries;
+}
+
+void FileIndex::addRoot(const std::string& searchPath)
+{
+    _roots.push_back(searchPath);
+}
+
+bool FileIndex::isIndexed(const std::string& fullPath) const
+{
+    for (const auto& root : _roots)
+    {
+        if (fullPath.compare(0, root.size(), root) != 0)
+            continue;
+
+        // the listed paths are never denormalized, check those on the disk
+        size_t start = root.size() - 1;
+        return fullPath.find("//", start) == std::string::npos
+            && fullPath.find("/./", start) == std::string::npos
+            && fullPath.find("/../", start) == std::string::npos
+            && fullPath.find('\\', start) == std::string::npos;
+    }
+    return false;
+}
+
+bool FileIndex::isAffectedBy(const std::string& fullPath) const
+{
+    std::string path = fullPath;
+    std::replace(path.begin(), path.end(), '\\', '/');
+    if (path.empty() || path.find("//") != std::string::npos || path.find("/./") != std::string::npos || path.find("/../") != std::string::npos
+        || (path.size() >= 2 && path.compare(path.size() - 2, 2, "/.") == 0)
+        || (path.size() >= 3 && path.compare(path.size() - 3, 3, "/..") == 0))
+    {
+        return true;
+    }
+
+    for (const auto& root : _roots)
+    {
+        if (path.compare(0, root.size(), root) == 0)
+            return true;
+        // removing or renaming a parent directory takes the search path with it
+        if (path.size() < root.size() && root.compare(0, path.size(), path) == 0
+            && (path.back() == '/' || root[path.size()] == '/'))
+            return true;
+    }
+    return false;
+}
+
+const std::vector<std::string>* FileIndex::getEntries(const std::string& dirPath) const
+{
+    auto iter = _directories.find(dirPath);
+    return iter != _directories.end() ? &iter->second : nullptr;
+}
+
+NS_CC_END
@@ -0,0 +1,109 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCFILEINDEX_H_
+#define __CCFILEINDEX_H_
+
+#include "platform/CCPlatformMacros.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+* @addtogroup platform
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class FileIndex
+ * @brief Snapshot of the files under the search paths, used by FileUtils to resolve files without touching the disk.
+ *
+ * It holds the search paths, resolution orders and filename lookup dictionary it was built for,
+ * the files and the entries of every directory under the indexed search paths.
+ * It is immutable once built, so it can be read from any thread.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL FileIndex
+{
+public:
+    FileIndex(const std::vector<std::string>& searchPaths, const std::vector<std::string>& resolutions,
+              const std::unordered_map<std::string, std::string>& filenameLookup);
+
+    /** Gets the search paths the index was built for. */
+    const std::vector<std::string>& getSearchPaths() const { return _searchPaths; }
+    /** Gets the resolution orders the index was built for. */
+    const std::vector<std::string>& getResolutions() const { return _resolutions; }
+
+    /** Gets the new filename from the filename lookup dictionary, or the filename itself. */
+    const std::string& getNewFilename(const std::string& filename) const;
+
+    /**
+     * Adds a directory to the index while it is built.
+     *
+     * @param dirPath full path of the directory, ending with '/'.
+     * @param entries the entries of the directory as returned by FileUtils::listFiles(), directories end with '/'.
+     */
+    void addDirectory(const std::string& dirPath, const std::vector<std::string>& entries);
+    /** Marks a search path as indexed, once its directories were added. */
+    void addRoot(const std::string& searchPath);
+
+    /**
+     * Returns whether the index can answer for a full path.
+     * Paths outside the indexed search paths, and paths with "." or ".." components, have to be checked on the disk.
+     */
+    bool isIndexed(const std::string& fullPath) const;
+    /**
+     * Returns whether a change on the disk at a full path may make the index stale: the path is under an
+     * indexed search path or is the parent of one, or it is not normalized and can't be compared.
+     */
+    bool isAffectedBy(const std::string& fullPath) const;
+    /** Returns whether an indexed full path is a file. */
+    bool isFile(const std::string& fullPath) const { return _files.find(fullPath) != _files.end(); }
+    /** Returns whether an indexed full path, ending with '/', is a directory. */
+    bool isDirectory(const std::string& dirPath) const { return _directories.find(dirPath) != _directories.end(); }
+    /** Gets the entries of an indexed directory, nullptr if it doesn't exist. */
+    const std::vector<std::string>* getEntries(const std::string& dirPath) const;
+
+    /** Gets the number of indexed files. */
+    size_t getFileCount() const { return _files.size(); }
+
+protected:
+    std::vector<std::string> _searchPaths;
+    std::vector<std::string> _resolutions;
+    std::unordered_map<std::string, std::string> _filenameLookup;
+    std::vector<std::string> _roots;
+    std::unordered_set<std::string> _files;
+    std::unordered_map<std::string, std::vector<std::string>> _directories;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(FileIndex);
+};
+
+NS_CC_END
+/** @} */
+#endif //__CCFILEINDEX_H_
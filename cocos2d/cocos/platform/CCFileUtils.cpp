@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "platform/CCSAXParser.h"
+#include "platform/CCFileIndex.h"
+#include "platform/CCAssetPack.h"
 //#include "base/ccUtils.h"
 
 #include "tinyxml2/tinyxml2.h"
@@ -396,6 +398,7 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    invalidateFileIndex(fullPath);
 
     delete doc;
     return ret;
@@ -436,6 +439,7 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    invalidateFileIndex(fullPath);
 
     delete doc;
     return ret;
@@ -554,6 +558,8 @@ void FileUtils::setDelegate(FileUtils *delegate)
 
 FileUtils::FileUtils()
     : _writablePath("")
+    , _fileIndexEnabled(false)
+    , _buildingFileIndex(false)
 {
 }
 
@@ -567,6 +573,7 @@ bool FileUtils::writeStringToFile(const std::string& dataStr, const std::string&
     data.fastSet((unsigned char*)dataStr.c_str(), dataStr.size());
 
     bool rv = writeDataToFile(data, fullPath);
+    invalidateFileIndex(fullPath);
 
     data.fastSet(nullptr, 0);
     return rv;
@@ -597,6 +604,7 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath) c
         fwrite(data.getBytes(), size, 1, fp);
 
         fclose(fp);
+        invalidateFileIndex(fullPath);
 
         return true;
     } while (0);
@@ -624,6 +632,197 @@ void FileUtils::purgeCachedEntries()
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    invalidateFileIndex();
+}
+
+void FileUtils::setFileIndexEnabled(bool enabled)
+{
+    DECLARE_GUARD;
+    _fileIndexEnabled = enabled;
+    invalidateFileIndex();
+}
+
+void FileUtils::refreshFileIndex()
+{
+    DECLARE_GUARD;
+    invalidateFileIndex();
+}
+
+void FileUtils::invalidateFileIndex() const
+{
+    std::atomic_store(&_fileIndex, std::shared_ptr<const FileIndex>());
+}
+
+void FileUtils::invalidateFileIndex(const std::string& path) const
+{
+    // the writes outside the search paths, like the texture disk cache or UserDefault, keep the index
+    auto index = std::atomic_load(&_fileIndex);
+    if (index && (!isAbsolutePath(path) || index->isAffectedBy(path)))
+    {
+        invalidateFileIndex();
+    }
+}
+
+std::shared_ptr<const FileIndex> FileUtils::getFileIndex() const
+{
+    if (!_fileIndexEnabled)
+    {
+        return nullptr;
+    }
+
+    auto index = std::atomic_load(&_fileIndex);
+    if (!index)
+    {
+        DECLARE_GUARD;
+        index = std::atomic_load(&_fileIndex);
+        // the lookups made while building go to the disk
+        if (!index && !_buildingFileIndex)
+        {
+            _buildingFileIndex = true;
+            index = buildFileIndex();
+            std::atomic_store(&_fileIndex, index);
+            _buildingFileIndex = false;
+        }
+    }
+    return index;
+}
+
+bool FileUtils::addAssetPack(const std::string& filename, bool front)
+{
+    std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+    {
+        return false;
+    }
+    auto pack = std::make_shared<AssetPack>();
+    if (!pack->open(fullPath))
+    {
+        return false;
+    }
+
+    DECLARE_GUARD;
+    auto packs = std::atomic_load(&_assetPacks);
+    auto mounted = packs ? std::make_shared<std::vector<std::shared_ptr<AssetPack>>>(*packs)
+                         : std::make_shared<std::vector<std::shared_ptr<AssetPack>>>();
+    mounted->push_back(pack);
+    std::atomic_store(&_assetPacks, std::shared_ptr<const std::vector<std::shared_ptr<AssetPack>>>(mounted));
+    addSearchPath(fullPath + "/", front);
+    return true;
+}
+
+const AssetPack* FileUtils::findAssetPack(const std::string& fullPath, std::string* entryName) const
+{
+    auto packs = std::atomic_load(&_assetPacks);
+    if (!packs)
+    {
+        return nullptr;
+    }
+
+    for (const auto& pack : *packs)
+    {
+        const std::string& packPath = pack->getPath();
+        if (fullPath.size() > packPath.size() && fullPath[packPath.size()] == '/'
+            && fullPath.compare(0, packPath.size(), packPath) == 0)
+        {
+            entryName->assign(fullPath, packPath.size() + 1, std::string::npos);
+            return pack.get();
+        }
+    }
+    return nullptr;
+}
+
+std::string FileUtils::findPathForFilename(const std::string& filename, const std::string& resolutionDirectory, const std::string& searchPath) const
+{
+    std::string entryName;
+    const AssetPack* pack = findAssetPack(searchPath, &entryName);
+    if (!pack)
+    {
+        return this->getPathForFilename(filename, resolutionDirectory, searchPath);
+    }
+
+    // split up like getPathForFilename()
+    std::string file = filename;
+    std::string filePath;
+    size_t pos = filename.find_last_of('/');
+    if (pos != std::string::npos)
+    {
+        filePath = filename.substr(0, pos+1);
+        file = filename.substr(pos+1);
+    }
+
+    std::string name = filePath + resolutionDirectory + file;
+    return pack->hasEntry(entryName + name) ? searchPath + name : "";
+}
+
+bool FileUtils::getContentsFromAssetPack(const std::string& fullPath, ResizableBuffer* buffer, Status* status) const
+{
+    std::string entryName;
+    const AssetPack* pack = findAssetPack(fullPath, &entryName);
+    if (!pack)
+    {
+        return false;
+    }
+    *status = pack->readEntry(entryName, buffer);
+    return true;
+}
+
+const unsigned char* FileUtils::getFileView(const std::string& filename, ssize_t* size) const
+{
+    if (!std::atomic_load(&_assetPacks) || filename.empty())
+    {
+        return nullptr;
+    }
+
+    std::string entryName;
+    const AssetPack* pack = findAssetPack(fullPathForFilename(filename), &entryName);
+    return pack ? pack->getEntryBytes(entryName, size) : nullptr;
+}
+
+std::shared_ptr<const FileIndex> FileUtils::buildFileIndex() const
+{
+    std::unordered_map<std::string, std::string> filenameLookup;
+    for (const auto& iter : _filenameLookupDict)
+    {
+        filenameLookup.emplace(iter.first, iter.second.asString());
+    }
+    auto index = std::make_shared<FileIndex>(_searchPathArray, _searchResolutionsOrderArray, filenameLookup);
+
+    for (const auto& searchPath : _searchPathArray)
+    {
+        // only the directories on the disk, the packaged assets are looked up as before
+        bool onDisk = !searchPath.empty() && (searchPath[0] == '/' || (searchPath.size() > 2 && searchPath[1] == ':'));
+        if (!onDisk || !isDirectoryExistInternal(searchPath))
+        {
+            continue;
+        }
+
+        if (!index->isIndexed(searchPath))
+        {
+            std::vector<std::string> pending(1, searchPath);
+            while (!pending.empty())
+            {
+                std::string dirPath = std::move(pending.back());
+                pending.pop_back();
+
+                auto entries = listFiles(dirPath);
+                for (const auto& entry : entries)
+                {
+                    if (entry.size() < 2 || entry.back() != '/')
+                        continue;
+
+                    size_t nameStart = entry.find_last_of('/', entry.size() - 2) + 1;
+                    std::string name = entry.substr(nameStart, entry.size() - 1 - nameStart);
+                    if (name != "." && name != "..")
+                    {
+                        pending.push_back(entry);
+                    }
+                }
+                index->addDirectory(dirPath, entries);
+            }
+        }
+        index->addRoot(searchPath);
+    }
+    return index;
 }
 
 std::string FileUtils::getStringFromFile(const std::string& filename) const
@@ -669,6 +868,10 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     if (fullPath.empty())
         return Status::NotExists;
 
+    Status status;
+    if (getContentsFromAssetPack(fullPath, buffer, &status))
+        return status;
+
     std::string suitableFullPath = fs->getSuitableFOpen(fullPath);
 
     struct stat statBuf;
@@ -817,7 +1020,12 @@ std::string FileUtils::getPathForDirectory(const std::string &dir, const std::st
 
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
-    
+    auto index = getFileIndex();
+    if (index && !filename.empty() && !isAbsolutePath(filename))
+    {
+        return fullPathForFilenameWithIndex(*index, filename);
+    }
+
     DECLARE_GUARD;
 
     if (filename.empty())
@@ -846,7 +1054,7 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
     {
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            fullpath = findPathForFilename(newFilename, resolutionIt, searchIt);
 
             if (!fullpath.empty())
             {
@@ -867,8 +1075,111 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
 }
 
 
+std::string FileUtils::fullPathForFilenameWithIndex(const FileIndex& index, const std::string& filename) const
+{
+    const std::string& newFilename = index.getNewFilename(filename);
+
+    // split up like getPathForFilename()
+    std::string file = newFilename;
+    std::string filePath;
+    size_t pos = newFilename.find_last_of('/');
+    if (pos != std::string::npos)
+    {
+        filePath = newFilename.substr(0, pos+1);
+        file = newFilename.substr(pos+1);
+    }
+
+    for (const auto& searchIt : index.getSearchPaths())
+    {
+        for (const auto& resolutionIt : index.getResolutions())
+        {
+            // a mounted pack may lie in an indexed directory, but its entries are not in the index
+            std::string entryName;
+            std::string fullpath = searchIt + filePath + resolutionIt + file;
+            if (!findAssetPack(searchIt, &entryName) && index.isIndexed(fullpath))
+            {
+                if (index.isFile(fullpath))
+                    return fullpath;
+            }
+            else
+            {
+                fullpath = findPathForFilename(newFilename, resolutionIt, searchIt);
+                if (!fullpath.empty())
+                    return fullpath;
+            }
+        }
+    }
+
+    if(isPopupNotify()){
+        CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
+    }
+
+    return "";
+}
+
+std::string FileUtils::fullPathForDirectoryWithIndex(const FileIndex& index, const std::string& dir) const
+{
+    std::string longdir = dir;
+    if(longdir[longdir.length() - 1] != '/')
+    {
+        longdir +="/";
+    }
+
+    const std::string& newdirname = index.getNewFilename(longdir);
+
+    for (const auto& searchIt : index.getSearchPaths())
+    {
+        for (const auto& resolutionIt : index.getResolutions())
+        {
+            std::string fullpath = this->getPathForDirectory(newdirname, resolutionIt, searchIt);
+            if (index.isIndexed(fullpath) ? index.isDirectory(fullpath) : isDirectoryExistInternal(fullpath))
+            {
+                return fullpath;
+            }
+        }
+    }
+
+    if(isPopupNotify()){
+        CCLOG("cocos2d: fullPathForDirectory: No directory found at %s. Possible missing directory.", dir.c_str());
+    }
+
+    return "";
+}
+
+bool FileUtils::listFilesFromIndex(const std::string& dirPath, std::vector<std::string>* files) const
+{
+    auto index = getFileIndex();
+    if (!index || dirPath.empty())
+    {
+        return false;
+    }
+
+    std::string longdir = dirPath;
+    if (longdir[longdir.length() - 1] != '/')
+    {
+        longdir += "/";
+    }
+    if (!index->isIndexed(longdir))
+    {
+        return false;
+    }
+
+    auto entries = index->getEntries(longdir);
+    if (entries)
+    {
+        *files = *entries;
+    }
+    return true;
+}
+
 std::string FileUtils::fullPathForDirectory(const std::string &dir) const
 {
+    auto index = getFileIndex();
+    if (index && !dir.empty() && !isAbsolutePath(dir))
+    {
+        return fullPathForDirectoryWithIndex(*index, dir);
+    }
+
     DECLARE_GUARD;
 
     if (dir.empty())
@@ -938,6 +1249,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    invalidateFileIndex();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -975,6 +1287,7 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     } else {
         _searchResolutionsOrderArray.push_back(resOrder);
     }
+    invalidateFileIndex();
 }
 
 const std::vector<std::string> FileUtils::getSearchResolutionsOrder() const
@@ -1033,6 +1346,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    invalidateFileIndex();
     _searchPathArray.clear();
 
     for (const auto& path : _originalSearchPaths)
@@ -1083,6 +1397,7 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         _originalSearchPaths.push_back(searchpath);
         _searchPathArray.push_back(path);
     }
+    invalidateFileIndex();
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
@@ -1090,6 +1405,7 @@ void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    invalidateFileIndex();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -1132,6 +1448,16 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        std::string entryName;
+        if (const AssetPack* pack = findAssetPack(filename, &entryName))
+        {
+            return pack->hasEntry(entryName);
+        }
+        auto index = getFileIndex();
+        if (index && index->isIndexed(filename))
+        {
+            return index->isFile(filename);
+        }
         return isFileExistInternal(filename);
     }
     else
@@ -1254,6 +1580,7 @@ bool FileUtils::isDirectoryExistInternal(const std::string& dirPath) const
 bool FileUtils::createDirectory(const std::string& path) const
 {
     CCASSERT(false, "FileUtils not support createDirectory");
+    invalidateFileIndex(path);
     return false;
 }
 
@@ -1374,6 +1701,7 @@ bool FileUtils::createDirectory(const std::string& path) const
             // directory doesn't exist, should create a new one
 
             int ret = mkdir(subpath.c_str(), S_IRWXU | S_IRWXG | S_IRWXO);
+            invalidateFileIndex(subpath);
             if (ret != 0 && (errno != EEXIST))
             {
                 // current directory can not be created, sub directories can not be created too
@@ -1410,19 +1738,15 @@ bool FileUtils::removeDirectory(const std::string& path) const
 #if !defined(CC_TARGET_OS_TVOS)
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
-    if (nftw(path.c_str(), unlink_cb, 64, FTW_DEPTH | FTW_PHYS) == -1)
-        return false;
-    else
-        return true;
+    bool removed = nftw(path.c_str(), unlink_cb, 64, FTW_DEPTH | FTW_PHYS) != -1;
 #else
     std::string command = "rm -r ";
     // Path may include space.
     command += "\"" + path + "\"";
-    if (system(command.c_str()) >= 0)
-        return true;
-    else
-        return false;
+    bool removed = system(command.c_str()) >= 0;
 #endif // (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
+    invalidateFileIndex(path);
+    return removed;
 
 #else
     return false;
@@ -1431,7 +1755,9 @@ bool FileUtils::removeDirectory(const std::string& path) const
 
 bool FileUtils::removeFile(const std::string &path) const
 {
-    if (remove(path.c_str())) {
+    int errorCode = remove(path.c_str());
+    invalidateFileIndex(path);
+    if (errorCode) {
         return false;
     } else {
         return true;
@@ -1444,6 +1770,8 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
     CCASSERT(!newfullpath.empty(), "Invalid path");
 
     int errorCode = rename(oldfullpath.c_str(), newfullpath.c_str());
+    invalidateFileIndex(oldfullpath);
+    invalidateFileIndex(newfullpath);
 
     if (0 != errorCode)
     {
@@ -1479,6 +1807,12 @@ long FileUtils::getFileSize(const std::string &filepath) const
             return 0;
     }
 
+    std::string entryName;
+    if (const AssetPack* pack = findAssetPack(fullpath, &entryName))
+    {
+        return pack->getEntrySize(entryName);
+    }
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat(fullpath.c_str(), &info);
@@ -1499,6 +1833,10 @@ std::vector<std::string> FileUtils::listFiles(const std::string& dirPath) const
 {
     std::vector<std::string> files;
     std::string fullpath = fullPathForDirectory(dirPath);
+    if (listFilesFromIndex(fullpath, &files))
+    {
+        return files;
+    }
     if (!fullpath.empty() && isDirectoryExist(fullpath))
     {
         tinydir_dir dir;
@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include <unordered_map>
 #include <type_traits>
 #include <mutex>
+#include <memory>
+#include <atomic>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccTypes.h"
@@ -42,6 +44,9 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class FileIndex;
+class AssetPack;
+
 /**
  * @addtogroup platform
  * @{
@@ -165,6 +170,50 @@ public:
      */
     virtual void purgeCachedEntries();
 
+    /**
+     *  Enables or disables the file index.
+     *
+     *  When enabled, the files under the search paths are listed once, and fullPathForFilename(),
+     *  isFileExist() and listFiles() are answered from that list without accessing the disk or locking,
+     *  including for missing files. The index is rebuilt after the search paths, resolution orders
+     *  or filename lookup dictionary change, and after refreshFileIndex().
+     *  Files added or removed under the search paths are not seen until refreshFileIndex() is called.
+     *
+     *  @param enabled Whether the index is used, false by default.
+     */
+    void setFileIndexEnabled(bool enabled);
+
+    /** Returns whether the file index is enabled. */
+    bool isFileIndexEnabled() const { return _fileIndexEnabled; }
+
+    /**
+     *  Lists the search paths again on the next lookup, after files were added or removed.
+     */
+    void refreshFileIndex();
+
+    /**
+     *  Mounts an asset pack as a search path.
+     *
+     *  The files of the pack are found as if the pack was a directory, for example "sprites/a.png"
+     *  in "res.ccpack" has the full path ".../res.ccpack/sprites/a.png". They are read through
+     *  getContents() and its variants, and the raw ones through getFileView() without copying.
+     *  Packs stay mounted until FileUtils is destroyed.
+     *
+     *  @param filename The pack, relative to the search paths or absolute.
+     *  @param front Whether the pack is searched before the search paths already added.
+     *  @return false if the pack can't be opened.
+     */
+    bool addAssetPack(const std::string& filename, bool front = false);
+
+    /**
+     *  Gets the bytes of a file stored raw in a mounted asset pack, without copying them.
+     *
+     *  @param filename The file name, relative to the search paths or absolute.
+     *  @param size Set to the size of the file.
+     *  @return The bytes, valid as long as FileUtils, or nullptr for the files outside packs and the compressed ones.
+     */
+    const unsigned char* getFileView(const std::string& filename, ssize_t* size) const;
+
     /**
      *  Gets string from a file.
      */
@@ -918,6 +967,44 @@ protected:
      */
     virtual std::string fullPathForDirectory(const std::string &dirname) const;
 
+    /**
+     *  Gets the file index, building it if needed.
+     *  Returns nullptr if the index is disabled, or while it is built.
+     */
+    std::shared_ptr<const FileIndex> getFileIndex() const;
+
+    /** Lists the search paths on the disk, called with _mutex locked. */
+    std::shared_ptr<const FileIndex> buildFileIndex() const;
+
+    /** Drops the file index, it is rebuilt on the next lookup. */
+    void invalidateFileIndex() const;
+    /** Drops the file index if a path changed on the disk may be in it, called after the change. */
+    void invalidateFileIndex(const std::string& path) const;
+
+    std::string fullPathForFilenameWithIndex(const FileIndex& index, const std::string& filename) const;
+    std::string fullPathForDirectoryWithIndex(const FileIndex& index, const std::string& dirname) const;
+
+    /**
+     *  Finds the mounted asset pack containing a full path.
+     *  @param entryName Set to the path relative to the pack.
+     */
+    const AssetPack* findAssetPack(const std::string& fullPath, std::string* entryName) const;
+
+    /** Same as getPathForFilename(), looking into the asset packs mounted as search paths. */
+    std::string findPathForFilename(const std::string& filename, const std::string& resolutionDirectory, const std::string& searchPath) const;
+
+    /**
+     *  Reads a file from a mounted asset pack.
+     *  @return false if the full path is not in a pack, it has to be read from the disk then.
+     */
+    bool getContentsFromAssetPack(const std::string& fullPath, ResizableBuffer* buffer, Status* status) const;
+
+    /**
+     *  Gets the entries of a directory from the file index.
+     *  @return false if the directory is not indexed, it has to be listed on the disk then.
+     */
+    bool listFilesFromIndex(const std::string& dirPath, std::vector<std::string>* files) const;
+
     /**
     * mutex used to protect fields. 
     */
@@ -976,6 +1063,18 @@ protected:
      */
     std::string _writablePath;
 
+    /**
+     *  The index of the search paths, published atomically so that it is read without locking _mutex.
+     */
+    mutable std::shared_ptr<const FileIndex> _fileIndex;
+    std::atomic<bool> _fileIndexEnabled;
+    mutable bool _buildingFileIndex;
+
+    /**
+     *  The mounted asset packs, replaced atomically when one is added.
+     */
+    std::shared_ptr<const std::vector<std::shared_ptr<AssetPack>>> _assetPacks;
+
     /**
      *  The singleton pointer of FileUtils.
      */
@@ -109,6 +109,7 @@ extern "C"
 #include "base/CCConfiguration.h"
 #include "base/ccUtils.h"
 #include "base/ZipUtils.h"
+#include "math/MathUtil.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtils-android.h"
 #endif
@@ -511,6 +512,14 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
+    // the raw files of the asset packs are decoded in place
+    ssize_t size = 0;
+    const unsigned char* view = FileUtils::getInstance()->getFileView(_filePath, &size);
+    if (view)
+    {
+        return initWithImageData(view, size);
+    }
+
     Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
 
     if (!data.isNull())
@@ -526,6 +535,13 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
+    ssize_t size = 0;
+    const unsigned char* view = FileUtils::getInstance()->getFileView(fullpath, &size);
+    if (view)
+    {
+        return initWithImageData(view, size);
+    }
+
     Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
 
     if (!data.isNull())
@@ -2462,37 +2478,18 @@ void Image::premultiplyAlpha()
 #else
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-    }
+    // same result as CC_RGB_PREMULTIPLY_ALPHA
+    MathUtil::premultiplyAlpha(_data, _width * _height);
     
     _hasPremultipliedAlpha = true;
 #endif
 }
 
-static inline unsigned char clamp(int x) {
-    return (unsigned char)(x >= 0 ? (x < 255 ? x : 255) : 0);
-}
-
 void Image::reversePremultipliedAlpha()
 {
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
 
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for (int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        if (p[3] > 0)
-        {
-            fourBytes[i] = clamp(int(std::ceil((p[0] * 255.0f) / p[3]))) |
-                clamp(int(std::ceil((p[1] * 255.0f) / p[3]))) << 8 |
-                clamp(int(std::ceil((p[2] * 255.0f) / p[3]))) << 16 |
-                p[3] << 24;
-        }
-    }
+    MathUtil::reversePremultipliedAlpha(_data, _width * _height);
 
     _hasPremultipliedAlpha = false;
 }
@@ -0,0 +1,163 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "platform/CCMappedFile.h"
+#include "platform/CCFileUtils.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include "base/ccUTF8.h"
+#include <windows.h>
+#define CC_MAPPED_FILE_WIN32 1
+#elif (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CC_MAPPED_FILE_POSIX 1
+#endif
+
+NS_CC_BEGIN
+
+MappedFile::MappedFile()
+: _bytes(nullptr)
+, _size(0)
+, _mapped(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& fullPath)
+{
+    close();
+    ssize_t size = 0;
+    const unsigned char* view = FileUtils::getInstance()->getFileView(fullPath, &size);
+    if (view)
+    {
+        _bytes = view;
+        _size = size;
+        return true;
+    }
+    if (map(fullPath))
+    {
+        _mapped = true;
+        return true;
+    }
+
+    _data = FileUtils::getInstance()->getDataFromFile(fullPath);
+    if (_data.isNull())
+    {
+        return false;
+    }
+    _bytes = _data.getBytes();
+    _size = _data.getSize();
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_mapped)
+    {
+#if defined(CC_MAPPED_FILE_WIN32)
+        UnmapViewOfFile(_bytes);
+#elif defined(CC_MAPPED_FILE_POSIX)
+        munmap(const_cast<unsigned char*>(_bytes), _size);
+#endif
+        _mapped = false;
+    }
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
+}
+
+bool MappedFile::map(const std::string& fullPath)
+{
+    // relative paths are in a package, Android assets for example
+    if (!FileUtils::getInstance()->isAbsolutePath(fullPath))
+    {
+        return false;
+    }
+
+#if defined(CC_MAPPED_FILE_WIN32)
+    std::u16string path;
+    if (!StringUtils::UTF8ToUTF16(fullPath, path))
+    {
+        return false;
+    }
+    HANDLE file = CreateFileW((LPCWSTR)path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    void* bytes = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        // the view keeps the mapping alive after the handles are closed
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+        {
+            bytes = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+    if (!bytes)
+    {
+        return false;
+    }
+    _bytes = static_cast<const unsigned char*>(bytes);
+    _size = (ssize_t)size.QuadPart;
+    return true;
+#elif defined(CC_MAPPED_FILE_POSIX)
+    int fd = ::open(fullPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    void* bytes = MAP_FAILED;
+    // empty files can't be mapped, they are read instead
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        bytes = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (bytes == MAP_FAILED)
+    {
+        return false;
+    }
+    _bytes = static_cast<const unsigned char*>(bytes);
+    _size = (ssize_t)st.st_size;
+    return true;
+#else
+    return false;
+#endif
+}
+
+NS_CC_END
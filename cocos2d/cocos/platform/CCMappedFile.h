@@ -0,0 +1,88 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCMAPPEDFILE_H_
+#define __CCMAPPEDFILE_H_
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+#include <string>
+
+/**
+* @addtogroup platform
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a file, memory mapped when the platform can.
+ *
+ * Files that can't be mapped, for example the assets in an Android apk, are read into memory instead,
+ * so that the bytes are available the same way everywhere. The raw files of a mounted AssetPack
+ * are viewed in the mapped pack.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /**
+     * Maps or reads a file, closing the previous one.
+     *
+     * @param fullPath full path of the file, as returned by FileUtils::fullPathForFilename().
+     * @return true if the file could be opened.
+     */
+    bool open(const std::string& fullPath);
+
+    /** Unmaps or frees the file. */
+    void close();
+
+    /** Gets the bytes of the file, valid until it is closed. */
+    const unsigned char* getBytes() const { return _bytes; }
+    /** Gets the size of the file. */
+    ssize_t getSize() const { return _size; }
+    /** Returns whether the bytes are mapped rather than read. */
+    bool isMapped() const { return _mapped; }
+
+protected:
+    bool map(const std::string& fullPath);
+
+    const unsigned char* _bytes;
+    ssize_t _size;
+    bool _mapped;
+    /** contents of a file that is not mapped */
+    Data _data;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+NS_CC_END
+/** @} */
+#endif //__CCMAPPEDFILE_H_
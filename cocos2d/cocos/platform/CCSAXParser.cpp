@@ -89,6 +89,14 @@ bool SAXParser::parse(const char* xmlData, size_t dataLength)
 
 bool SAXParser::parse(const std::string& filename)
 {
+    // rapidxml parses in place, so the raw files of the asset packs are copied once instead of read
+    ssize_t size = 0;
+    const unsigned char* view = FileUtils::getInstance()->getFileView(filename, &size);
+    if (view)
+    {
+        return parse(reinterpret_cast<const char*>(view), (size_t)size);
+    }
+
     bool ret = false;
     Data data = FileUtils::getInstance()->getDataFromFile(filename);
     if (!data.isNull())
@@ -349,7 +349,9 @@ bool FileUtilsAndroid::removeDirectory(const std::string& path) const
     if (path.empty())
         return false;
     
-    return removeDirectoryJNI(path.c_str());
+    bool removed = removeDirectoryJNI(path.c_str());
+    invalidateFileIndex(path);
+    return removed;
 }
 
 FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, ResizableBuffer* buffer) const
@@ -360,6 +362,11 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
 
     string fullPath = fullPathForFilename(filename);
 
+    // packs in the apk are read into memory by MappedFile
+    FileUtils::Status status;
+    if (getContentsFromAssetPack(fullPath, buffer, &status))
+        return status;
+
     if (fullPath[0] == '/')
         return FileUtils::getContents(fullPath, buffer);
 
@@ -309,7 +309,9 @@ bool FileUtilsApple::removeDirectory(const std::string& path) const
         return false;
     }
 
-    if (nftw(path.c_str(),unlink_cb, 64, FTW_DEPTH | FTW_PHYS))
+    int result = nftw(path.c_str(),unlink_cb, 64, FTW_DEPTH | FTW_PHYS);
+    invalidateFileIndex(path);
+    if (result)
         return false;
     else
         return true;
@@ -409,7 +411,9 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
 
     NSString *file = [NSString stringWithUTF8String:fullPath.c_str()];
     // do it atomically
-    return [nsDict writeToFile:file atomically:YES];
+    bool written = [nsDict writeToFile:file atomically:YES];
+    invalidateFileIndex(fullPath);
+    return written;
 }
 
 void FileUtilsApple::valueMapCompact(ValueMap& valueMap) const
@@ -475,6 +479,7 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     }
 
     [array writeToFile:path atomically:YES];
+    invalidateFileIndex(fullPath);
 
     return true;
 }
@@ -509,6 +514,7 @@ bool FileUtilsApple::createDirectory(const std::string& path) const
     NSError* error;
     
     bool result = [s_fileManager createDirectoryAtPath:[NSString stringWithUTF8String:path.c_str()] withIntermediateDirectories:YES attributes:nil error:&error];
+    invalidateFileIndex(path);
     
     if(!result && error != nil)
     {
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "platform/win32/CCFileUtils-win32.h"
 #include "platform/win32/CCUtils-win32.h"
 #include "platform/CCCommon.h"
+#include "platform/CCAssetPack.h"
 #include "tinydir/tinydir.h"
 #include <Shlobj.h>
 #include <cstdlib>
@@ -180,6 +181,10 @@ FileUtils::Status FileUtilsWin32::getContents(const std::string& filename, Resiz
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    Status status;
+    if (getContentsFromAssetPack(fullPath, buffer, &status))
+        return status;
+
     HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -276,6 +281,12 @@ void FileUtilsWin32::listFilesRecursively(const std::string& dirPath, std::vecto
 
 long FileUtilsWin32::getFileSize(const std::string &filepath) const
 {
+    std::string entryName;
+    if (const AssetPack* pack = findAssetPack(filepath, &entryName))
+    {
+        return (long)pack->getEntrySize(entryName);
+    }
+
     struct _stat tmp;
     if (_stat(filepath.c_str(), &tmp) == 0)
     {
@@ -288,6 +299,10 @@ std::vector<std::string> FileUtilsWin32::listFiles(const std::string& dirPath) c
 {
     std::string fullpath = fullPathForDirectory(dirPath);
     std::vector<std::string> files;
+    if (listFilesFromIndex(fullpath, &files))
+    {
+        return files;
+    }
     if (isDirectoryExist(fullpath))
     {
         tinydir_dir dir;
@@ -393,7 +408,10 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
         }
     }
 
-    if (MoveFile(_wOld.c_str(), _wNew.c_str()))
+    BOOL moved = MoveFile(_wOld.c_str(), _wNew.c_str());
+    invalidateFileIndex(oldfullpath);
+    invalidateFileIndex(newfullpath);
+    if (moved)
     {
         return true;
     }
@@ -463,6 +481,7 @@ bool FileUtilsWin32::createDirectory(const std::string& dirPath) const
             if (!isDirectoryExist(utf8Path))
             {
                 BOOL ret = CreateDirectory(subpath.c_str(), NULL);
+                invalidateFileIndex(utf8Path);
                 if (!ret && ERROR_ALREADY_EXISTS != GetLastError())
                 {
                     CCLOGERROR("Fail create directory %s !Error code is 0x%x", utf8Path.c_str(), GetLastError());
@@ -479,7 +498,9 @@ bool FileUtilsWin32::removeFile(const std::string &filepath) const
     std::regex pat("\\/");
     std::string win32path = std::regex_replace(filepath, pat, "\\");
 
-    if (DeleteFile(StringUtf8ToWideChar(win32path).c_str()))
+    BOOL deleted = DeleteFile(StringUtf8ToWideChar(win32path).c_str());
+    invalidateFileIndex(filepath);
+    if (deleted)
     {
         return true;
     }
@@ -527,7 +548,9 @@ bool FileUtilsWin32::removeDirectory(const std::string& dirPath) const
         }
         FindClose(search);
     }
-    if (ret && RemoveDirectory(wpath.c_str()))
+    ret = ret && RemoveDirectory(wpath.c_str());
+    invalidateFileIndex(dirPath);
+    if (ret)
     {
         return true;
     }
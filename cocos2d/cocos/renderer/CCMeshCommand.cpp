@@ -189,6 +189,35 @@ uint32_t MeshCommand::getMaterialID() const
     return _materialID;
 }
 
+bool MeshCommand::isDepthTestAndWriteEnabled() const
+{
+    // like RenderState::bind(), the blocks are applied top-down from the default state, depth test on and
+    // depth write off, and each state comes from the last block that sets it
+    auto depthTestAndWrite = [](std::initializer_list<RenderState::StateBlock*> states) {
+        bool depthTest = true;
+        bool depthWrite = false;
+        for (auto state : states)
+        {
+            if (state && state->isStateSet(RenderState::StateBlock::RS_DEPTH_TEST))
+                depthTest = state->isDepthTestEnabled();
+            if (state && state->isStateSet(RenderState::StateBlock::RS_DEPTH_WRITE))
+                depthWrite = state->isDepthWriteEnabled();
+        }
+        return depthTest && depthWrite;
+    };
+
+    if (!_material)
+    {
+        return depthTestAndWrite({_stateBlock});
+    }
+    for (const auto& pass : _material->_currentTechnique->_passes)
+    {
+        if (!depthTestAndWrite({_material->getStateBlock(), _material->_currentTechnique->getStateBlock(), pass->getStateBlock()}))
+            return false;
+    }
+    return true;
+}
+
 void MeshCommand::preBatchDraw()
 {
     // Do nothing if using material since each pass needs to bind its own VAO
@@ -66,6 +66,9 @@ public:
     void genMaterialID(GLuint texID, void* glProgramState, GLuint vertexBuffer, GLuint indexBuffer, BlendFunc blend);
     
     uint32_t getMaterialID() const;
+
+    /** Whether every pass draws with both the depth test and the depth write enabled. */
+    bool isDepthTestAndWriteEnabled() const;
     
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     void listenRendererRecreated(EventCustom* event);
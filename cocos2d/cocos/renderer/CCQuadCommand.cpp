@@ -36,21 +36,14 @@
 
 NS_CC_BEGIN
 
-int QuadCommand::__indexCapacity = -1;
-GLushort* QuadCommand::__indices = nullptr;
-
-QuadCommand::QuadCommand():
-_indexSize(-1),
-_ownedIndices()
+QuadCommand::QuadCommand()
+: _quadIndices(nullptr)
 {
 }
 
 QuadCommand::~QuadCommand()
 {
-    for (auto& indices : _ownedIndices)
-    {
-        CC_SAFE_DELETE_ARRAY(indices);
-    }
+    CC_SAFE_RELEASE(_quadIndices);
 }
 
 void QuadCommand::init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, ssize_t quadCount,
@@ -59,51 +52,21 @@ void QuadCommand::init(float globalOrder, GLuint textureID, GLProgramState* glPr
     CCASSERT(glProgramState, "Invalid GLProgramState");
     CCASSERT(glProgramState->getVertexAttribsFlags() == 0, "No custom attributes are supported in QuadCommand");
 
-    if (quadCount * 6 > _indexSize)
-        reIndex((int)quadCount*6);
+    // TrianglesCommand indices are 16 bit, larger counts used to wrap around silently
+    CCASSERT(quadCount <= QuadIndexBuffer::MAX_SHORT_QUADS, "Too many quads for QuadCommand");
+    quadCount = std::min(quadCount, QuadIndexBuffer::MAX_SHORT_QUADS);
+
+    if (_quadIndices == nullptr)
+        _quadIndices = QuadIndexBuffer::acquire(0);
 
     Triangles triangles;
     triangles.verts = &quads->tl;
     triangles.vertCount = (int)quadCount * 4;
-    triangles.indices = __indices;
+    triangles.indices = const_cast<GLushort*>(_quadIndices->getShortIndices(quadCount));
     triangles.indexCount = (int)quadCount * 6;
     TrianglesCommand::init(globalOrder, textureID, glProgramState, blendType, triangles, mv, flags);
 }
 
-void QuadCommand::reIndex(int indicesCount)
-{
-    // first time init: create a decent buffer size for indices to prevent too much resizing
-    if (__indexCapacity == -1)
-    {
-        indicesCount = std::max(indicesCount, 2048);
-    }
-
-    if (indicesCount > __indexCapacity)
-    {
-        // if resizing is needed, get needed size plus 25%, but not bigger that max size
-        indicesCount *= 1.25;
-        indicesCount = std::min(indicesCount, 65536);
-
-        CCLOG("cocos2d: QuadCommand: resizing index size from [%d] to [%d]", __indexCapacity, indicesCount);
-
-        _ownedIndices.push_back(__indices);
-        __indices = new (std::nothrow) GLushort[indicesCount];
-        __indexCapacity = indicesCount;
-    }
-
-    for( int i=0; i < __indexCapacity/6; i++)
-    {
-        __indices[i*6+0] = (GLushort) (i*4+0);
-        __indices[i*6+1] = (GLushort) (i*4+1);
-        __indices[i*6+2] = (GLushort) (i*4+2);
-        __indices[i*6+3] = (GLushort) (i*4+3);
-        __indices[i*6+4] = (GLushort) (i*4+2);
-        __indices[i*6+5] = (GLushort) (i*4+1);
-    }
-
-    _indexSize = indicesCount;
-}
-
 void QuadCommand::init(float globalOrder, GLuint textureID, GLProgramState* shader, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, ssize_t quadCount, const Mat4 &mv)
 {
     init(globalOrder, textureID, shader, blendType, quads, quadCount, mv, 0);
@@ -30,6 +30,7 @@
 
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCGLProgramState.h"
+#include "renderer/CCQuadIndexBuffer.h"
 
 /**
  * @addtogroup renderer
@@ -72,14 +73,8 @@ public:
         const Mat4& mv, uint32_t flags);
 
 protected:
-    void reIndex(int indices);
-
-    int _indexSize;
-    std::vector<GLushort*> _ownedIndices;
-
-    // shared across all instances
-    static int __indexCapacity;
-    static GLushort* __indices;
+    // shared with every quad drawing class
+    QuadIndexBuffer* _quadIndices;
 };
 
 NS_CC_END
@@ -0,0 +1,227 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "renderer/CCQuadIndexBuffer.h"
+
+#include <algorithm>
+
+#include "base/ccMacros.h"
+#include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/CCEventType.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "renderer/ccGLStateCache.h"
+
+NS_CC_BEGIN
+
+// first allocation, same as the 2048 indices QuadCommand used to start with
+static const ssize_t MIN_QUADS = 2048 / 6;
+
+template <typename T>
+static void fillQuadIndices(T* indices, ssize_t first, ssize_t last)
+{
+    for (ssize_t i = first; i < last; ++i)
+    {
+        indices[i*6+0] = (T) (i*4+0);
+        indices[i*6+1] = (T) (i*4+1);
+        indices[i*6+2] = (T) (i*4+2);
+
+        // inverted index. issue #179
+        indices[i*6+3] = (T) (i*4+3);
+        indices[i*6+4] = (T) (i*4+2);
+        indices[i*6+5] = (T) (i*4+1);
+    }
+}
+
+const ssize_t QuadIndexBuffer::MAX_SHORT_QUADS;
+QuadIndexBuffer* QuadIndexBuffer::s_sharedBuffer = nullptr;
+
+QuadIndexBuffer* QuadIndexBuffer::acquire(ssize_t quadCount)
+{
+    if (s_sharedBuffer == nullptr)
+    {
+        // the last release() deletes it, see the destructor
+        s_sharedBuffer = new (std::nothrow) QuadIndexBuffer();
+    }
+    else
+    {
+        s_sharedBuffer->retain();
+    }
+    s_sharedBuffer->reserve(quadCount);
+    return s_sharedBuffer;
+}
+
+QuadIndexBuffer::QuadIndexBuffer()
+: _vbo(0)
+, _capacity(0)
+, _uploadedCapacity(0)
+, _supportsUintIndices(false)
+, _shortIndices(nullptr)
+, _shortCapacity(0)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+, _rendererRecreatedListener(nullptr)
+#endif
+{
+#ifdef CC_PLATFORM_PC
+    _supportsUintIndices = true;
+#else
+    _supportsUintIndices = Configuration::getInstance()->checkForGLExtension("GL_OES_element_index_uint");
+#endif
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // has to run before the listeners of its users (TextureAtlas uses -1) so that they get the new handle
+    _rendererRecreatedListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, CC_CALLBACK_1(QuadIndexBuffer::listenRendererRecreated, this));
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, -2);
+#endif
+}
+
+QuadIndexBuffer::~QuadIndexBuffer()
+{
+    if (s_sharedBuffer == this)
+    {
+        s_sharedBuffer = nullptr;
+    }
+
+    if (_vbo)
+    {
+        glDeleteBuffers(1, &_vbo);
+    }
+
+    CC_SAFE_DELETE_ARRAY(_shortIndices);
+    for (auto& indices : _retiredShortIndices)
+    {
+        CC_SAFE_DELETE_ARRAY(indices);
+    }
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+#endif
+}
+
+void QuadIndexBuffer::reserve(ssize_t quadCount)
+{
+    if (quadCount <= _capacity)
+        return;
+
+    if (quadCount > MAX_SHORT_QUADS && !_supportsUintIndices)
+    {
+        CCLOG("cocos2d: QuadIndexBuffer: 32 bit indices are not supported, only %d of %d quads can be drawn",
+              (int)MAX_SHORT_QUADS, (int)quadCount);
+        quadCount = MAX_SHORT_QUADS;
+        if (quadCount <= _capacity)
+            return;
+    }
+
+    // grow by 50% to limit re-uploads, but don't leave the 16 bit range for it
+    ssize_t newCapacity = std::max(quadCount, std::max(MIN_QUADS, _capacity + _capacity / 2));
+    if (quadCount <= MAX_SHORT_QUADS || !_supportsUintIndices)
+    {
+        newCapacity = std::min(newCapacity, MAX_SHORT_QUADS);
+    }
+
+    CCLOG("cocos2d: QuadIndexBuffer: resizing from [%d] to [%d] quads", (int)_capacity, (int)newCapacity);
+    _capacity = newCapacity;
+}
+
+GLenum QuadIndexBuffer::getIndexType() const
+{
+    return _capacity > MAX_SHORT_QUADS ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+}
+
+int QuadIndexBuffer::getSizePerIndex() const
+{
+    return _capacity > MAX_SHORT_QUADS ? sizeof(GLuint) : sizeof(GLushort);
+}
+
+GLuint QuadIndexBuffer::getVBO()
+{
+    if (_uploadedCapacity != _capacity)
+    {
+        uploadIndices();
+    }
+    return _vbo;
+}
+
+void QuadIndexBuffer::uploadIndices()
+{
+    // Avoid changing the element buffer for whatever VAO might be bound.
+    GL::bindVAO(0);
+
+    if (!_vbo)
+    {
+        glGenBuffers(1, &_vbo);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo);
+
+    if (getIndexType() == GL_UNSIGNED_INT)
+    {
+        std::vector<GLuint> indices(_capacity * 6);
+        fillQuadIndices(indices.data(), 0, _capacity);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        std::vector<GLushort> indices(_capacity * 6);
+        fillQuadIndices(indices.data(), 0, _capacity);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    _uploadedCapacity = _capacity;
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+const GLushort* QuadIndexBuffer::getShortIndices(ssize_t quadCount)
+{
+    CCASSERT(quadCount <= MAX_SHORT_QUADS, "Too many quads for 16 bit indices");
+    quadCount = std::min(quadCount, MAX_SHORT_QUADS);
+
+    if (quadCount > _shortCapacity)
+    {
+        // if resizing is needed, get needed size plus 25%, but not bigger that max size
+        ssize_t newCapacity = std::max(quadCount, std::max(MIN_QUADS, _shortCapacity + _shortCapacity / 4));
+        newCapacity = std::min(newCapacity, MAX_SHORT_QUADS);
+
+        if (_shortIndices)
+        {
+            _retiredShortIndices.push_back(_shortIndices);
+        }
+        _shortIndices = new (std::nothrow) GLushort[newCapacity * 6];
+        fillQuadIndices(_shortIndices, 0, newCapacity);
+        _shortCapacity = newCapacity;
+    }
+
+    return _shortIndices;
+}
+
+void QuadIndexBuffer::listenRendererRecreated(EventCustom* /*event*/)
+{
+    // the old handle died with the context
+    _vbo = 0;
+    _uploadedCapacity = 0;
+}
+
+NS_CC_END
@@ -0,0 +1,126 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_QUAD_INDEX_BUFFER_H__
+#define __CC_QUAD_INDEX_BUFFER_H__
+
+#include <vector>
+#include "base/CCRef.h"
+#include "platform/CCStdC.h"
+#include "platform/CCGL.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class EventCustom;
+class EventListenerCustom;
+
+/**
+ QuadIndexBuffer holds the indices used to draw quads as pairs of triangles.
+
+ The indices only depend on the number of quads, so a single grow-only buffer is shared by
+ every ParticleSystemQuad, TextureAtlas and QuadCommand. Users take a reference with acquire()
+ and give it back with release(); the buffer is destroyed with its last user.
+
+ Up to MAX_SHORT_QUADS quads the GL buffer stores GLushort indices. Above that it switches to
+ GLuint indices, so users have to query getIndexType() and getSizePerIndex() when drawing.
+ @js NA
+ */
+class CC_DLL QuadIndexBuffer : public Ref
+{
+public:
+    /** Number of quads addressable with 16 bit indices. The index 0xffff is left out, it is the primitive restart index. */
+    static const ssize_t MAX_SHORT_QUADS = 16383;
+
+    /**
+     Returns the shared buffer, retained, with room for at least quadCount quads.
+     @param quadCount The number of quads needed by the caller.
+     */
+    static QuadIndexBuffer* acquire(ssize_t quadCount);
+
+    /**
+     Grows the buffer to hold at least quadCount quads. It never shrinks.
+     If 32 bit indices are not supported, the capacity is limited to MAX_SHORT_QUADS.
+     */
+    void reserve(ssize_t quadCount);
+
+    /** Gets the number of quads the GL buffer can draw. */
+    ssize_t getCapacity() const { return _capacity; }
+
+    /** Gets the type of the indices in the GL buffer, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT. */
+    GLenum getIndexType() const;
+
+    /** Gets the size in bytes of one index in the GL buffer. */
+    int getSizePerIndex() const;
+
+    /**
+     Gets the openGL handle of the element array buffer, uploading the indices if needed.
+     Call it before binding a VAO: uploading changes the element array buffer binding.
+     */
+    GLuint getVBO();
+
+    /**
+     Gets client side GLushort indices for at least quadCount quads, as used by TrianglesCommand.
+     A pointer returned here stays valid as long as the buffer is alive, even if it grows later.
+     @param quadCount The number of quads, at most MAX_SHORT_QUADS.
+     */
+    const GLushort* getShortIndices(ssize_t quadCount);
+
+CC_CONSTRUCTOR_ACCESS:
+    QuadIndexBuffer();
+    virtual ~QuadIndexBuffer();
+
+protected:
+    void uploadIndices();
+    void listenRendererRecreated(EventCustom* event);
+
+    GLuint _vbo;
+    ssize_t _capacity;
+    // quads present in the GL buffer, 0 when it has to be uploaded again
+    ssize_t _uploadedCapacity;
+    bool _supportsUintIndices;
+
+    GLushort* _shortIndices;
+    ssize_t _shortCapacity;
+    // superseded client side arrays, commands queued in this frame may still point to them
+    std::vector<GLushort*> _retiredShortIndices;
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
+
+    static QuadIndexBuffer* s_sharedBuffer;
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_QUAD_INDEX_BUFFER_H__
@@ -294,6 +294,15 @@ public:
          */
         void setDepthWrite(bool enabled);
 
+        /** Whether depth testing is enabled, as set by setDepthTest(). */
+        bool isDepthTestEnabled() const { return _depthTestEnabled; }
+
+        /** Whether depth writing is enabled, as set by setDepthWrite(). */
+        bool isDepthWriteEnabled() const { return _depthWriteEnabled; }
+
+        /** Whether the given StateBlock bits are set, bind() only applies those states. */
+        bool isStateSet(long stateBits) const { return (_bits & stateBits) != 0; }
+
         /**
          * Sets the depth function to use when depth testing is enabled.
          *
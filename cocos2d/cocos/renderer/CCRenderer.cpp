@@ -47,18 +47,27 @@
 #include "base/CCEventType.h"
 #include "2d/CCCamera.h"
 #include "2d/CCScene.h"
+#include "math/MathUtil.h"
+
+// fence sync objects are only exposed where the GL entry points come from glew
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) && defined(GL_SYNC_GPU_COMMANDS_COMPLETE) && defined(GL_MAP_UNSYNCHRONIZED_BIT)
+#define CC_RENDERER_SYNC_OBJECTS 1
+#else
+#define CC_RENDERER_SYNC_OBJECTS 0
+#endif
 
 NS_CC_BEGIN
 
 // helper
-static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
-{
-    return a->getGlobalOrder() < b->getGlobalOrder();
-}
-
-static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
+// maps a float to an unsigned integer that sorts the same way
+static uint32_t floatSortKey(float f)
 {
-    return  a->getDepth() > b->getDepth();
+    // -0 and 0 compare equal, keep them in their order
+    if (f == 0)
+        f = 0;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
 }
 
 // queue
@@ -112,9 +121,101 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+
+    // back to front
+    auto& transparentQueue = _commands[QUEUE_GROUP::TRANSPARENT_3D];
+    _sortEntries.clear();
+    for (auto command : transparentQueue)
+    {
+        _sortEntries.push_back({(uint64_t) (uint32_t) ~floatSortKey(command->getDepth()), command});
+    }
+    radixSort(transparentQueue);
+
+    // Opaque meshes that both test and write depth can be drawn in any order, so batchable ones are
+    // grouped by material. Other commands keep their place, meshes only move between them.
+    auto& opaqueQueue = _commands[QUEUE_GROUP::OPAQUE_3D];
+    _sortEntries.clear();
+    uint64_t run = 0;
+    for (auto command : opaqueQueue)
+    {
+        if (command->getType() == RenderCommand::Type::MESH_COMMAND && !command->isSkipBatching()
+            && static_cast<MeshCommand*>(command)->isDepthTestAndWriteEnabled())
+        {
+            _sortEntries.push_back({(run << 32) | static_cast<MeshCommand*>(command)->getMaterialID(), command});
+        }
+        else
+        {
+            _sortEntries.push_back({++run << 32, command});
+            ++run;
+        }
+    }
+    radixSort(opaqueQueue);
+
+    for (auto group : {QUEUE_GROUP::GLOBALZ_NEG, QUEUE_GROUP::GLOBALZ_POS})
+    {
+        auto& queue = _commands[group];
+        _sortEntries.clear();
+        for (auto command : queue)
+        {
+            _sortEntries.push_back({floatSortKey(command->getGlobalOrder()), command});
+        }
+        radixSort(queue);
+    }
+}
+
+void RenderQueue::radixSort(std::vector<RenderCommand*>& commands)
+{
+    const size_t count = _sortEntries.size();
+
+    // most frames submit the commands in order already
+    size_t i = 1;
+    while (i < count && _sortEntries[i - 1].key <= _sortEntries[i].key)
+        ++i;
+    if (i >= count)
+        return;
+
+    _sortScratch.resize(count);
+    SortEntry* src = _sortEntries.data();
+    SortEntry* dst = _sortScratch.data();
+    // the histograms of all the digits are counted in one go, the order of the entries does not change them
+    static const int DIGITS = sizeof(uint64_t);
+    size_t histograms[DIGITS][256] = {{0}};
+    for (i = 0; i < count; ++i)
+    {
+        uint64_t key = src[i].key;
+        for (int digit = 0; digit < DIGITS; ++digit)
+        {
+            ++histograms[digit][(key >> (digit * 8)) & 0xff];
+        }
+    }
+
+    for (int digit = 0; digit < DIGITS; ++digit)
+    {
+        const int shift = digit * 8;
+        size_t* offsets = histograms[digit];
+
+        // all the keys share this digit, the pass would not move anything
+        if (offsets[(src[0].key >> shift) & 0xff] == count)
+            continue;
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; ++bucket)
+        {
+            size_t size = offsets[bucket];
+            offsets[bucket] = offset;
+            offset += size;
+        }
+        for (i = 0; i < count; ++i)
+        {
+            dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        commands[i] = src[i].command;
+    }
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -199,11 +300,24 @@ static const int DEFAULT_RENDER_QUEUE = 0;
 //
 Renderer::Renderer()
 :_lastBatchedMeshCommand(nullptr)
+,_verts(nullptr)
+,_indices(nullptr)
+,_vertexCapacity(VBO_SIZE)
+,_indexCapacity(INDEX_VBO_SIZE)
+,_maxVertexCapacity(VBO_SIZE)
+,_maxIndexCapacity(INDEX_VBO_SIZE)
+,_uintIndices(false)
+,_currentStreamSlot(0)
+,_streamFences(false)
 ,_triBatchesToDrawCapacity(-1)
 ,_triBatchesToDraw(nullptr)
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
+,_drawnBatches(0)
+,_drawnVertices(0)
+,_streamedBytes(0)
+,_streamStalls(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -224,6 +338,12 @@ Renderer::Renderer()
     // for the batched TriangleCommand
     _triBatchesToDrawCapacity = 500;
     _triBatchesToDraw = (TriBatchToDraw*) malloc(sizeof(_triBatchesToDraw[0]) * _triBatchesToDrawCapacity);
+
+    // the arrays grow when a frame batches more, index storage is wide enough for 32 bit indices
+    _verts = (V3F_C4B_T2F*) malloc(sizeof(_verts[0]) * _vertexCapacity);
+    _indices = malloc(sizeof(GLuint) * _indexCapacity);
+
+    memset(_streamSlots, 0, sizeof(_streamSlots));
 }
 
 Renderer::~Renderer()
@@ -231,13 +351,25 @@ Renderer::~Renderer()
     _renderGroups.clear();
     _groupCommandManager->release();
     
-    glDeleteBuffers(2, _buffersVBO);
+    for (auto& slot : _streamSlots)
+    {
+        glDeleteBuffers(2, slot.vbo);
+#if CC_RENDERER_SYNC_OBJECTS
+        if (slot.fence)
+            glDeleteSync((GLsync) slot.fence);
+#endif
+    }
 
     free(_triBatchesToDraw);
+    free(_verts);
+    free(_indices);
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_buffersVAO);
+        for (auto& slot : _streamSlots)
+        {
+            glDeleteVertexArrays(1, &slot.vao);
+        }
         GL::bindVAO(0);
     }
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -256,6 +388,23 @@ void Renderer::initGLView()
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_cacheTextureListener, -1);
 #endif
 
+    auto conf = Configuration::getInstance();
+#ifdef CC_PLATFORM_PC
+    bool supportsUintIndices = true;
+#else
+    bool supportsUintIndices = conf->checkForGLExtension("GL_OES_element_index_uint");
+#endif
+    if (supportsUintIndices)
+    {
+        _maxVertexCapacity = MAX_VBO_SIZE;
+        _maxIndexCapacity = MAX_INDEX_VBO_SIZE;
+    }
+
+#if CC_RENDERER_SYNC_OBJECTS
+    // without fences every upload orphans the storage instead, and stalls are left to the driver
+    _streamFences = conf->supportsSyncObjects() && conf->supportsMapBufferRange();
+#endif
+
     setupBuffer();
     
     _glViewAssigned = true;
@@ -263,6 +412,10 @@ void Renderer::initGLView()
 
 void Renderer::setupBuffer()
 {
+    // after the context was lost, the old names and fences are gone with it
+    memset(_streamSlots, 0, sizeof(_streamSlots));
+    _currentStreamSlot = 0;
+
     if(Configuration::getInstance()->supportsShareableVAO())
     {
         setupVBOAndVAO();
@@ -276,35 +429,37 @@ void Renderer::setupBuffer()
 void Renderer::setupVBOAndVAO()
 {
     //generate vbo and vao for trianglesCommand
-    glGenVertexArrays(1, &_buffersVAO);
-    GL::bindVAO(_buffersVAO);
+    for (auto& slot : _streamSlots)
+    {
+        glGenVertexArrays(1, &slot.vao);
+        GL::bindVAO(slot.vao);
 
-    glGenBuffers(2, &_buffersVBO[0]);
+        glGenBuffers(2, &slot.vbo[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    // Issue #15652
-    // Should not initialize VBO with a large size (VBO_SIZE=65536),
-    // it may cause low FPS on some Android devices like LG G4 & Nexus 5X.
-    // It's probably because some implementations of OpenGLES driver will
-    // copy the whole memory of VBO which initialized at the first time
-    // once glBufferData/glBufferSubData is invoked.
-    // For more discussion, please refer to https://github.com/cocos2d/cocos2d-x/issues/15652
-    //glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, slot.vbo[0]);
+        // Issue #15652
+        // Should not initialize VBO with a large size (VBO_SIZE=65536),
+        // it may cause low FPS on some Android devices like LG G4 & Nexus 5X.
+        // It's probably because some implementations of OpenGLES driver will
+        // copy the whole memory of VBO which initialized at the first time
+        // once glBufferData/glBufferSubData is invoked.
+        // For more discussion, please refer to https://github.com/cocos2d/cocos2d-x/issues/15652
+        // The storage is sized on the first upload instead, see streamToBuffer().
 
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+        // vertices
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
 
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+        // colors
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
 
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+        // tex coords
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, slot.vbo[1]);
+    }
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
@@ -316,7 +471,10 @@ void Renderer::setupVBOAndVAO()
 
 void Renderer::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    for (auto& slot : _streamSlots)
+    {
+        glGenBuffers(2, &slot.vbo[0]);
+    }
     // Issue #15652
     // Should not initialize VBO with a large size (VBO_SIZE=65536),
     // it may cause low FPS on some Android devices like LG G4 & Nexus 5X.
@@ -324,30 +482,108 @@ void Renderer::setupVBO()
     // copy the whole memory of VBO which initialized at the first time
     // once glBufferData/glBufferSubData is invoked.
     // For more discussion, please refer to https://github.com/cocos2d/cocos2d-x/issues/15652
-//    mapBuffers();
 }
 
-void Renderer::mapBuffers()
+bool Renderer::reserveStreamCapacity(int vertexCount, int indexCount)
 {
-    // Avoid changing the element buffer for whatever VAO might be bound.
-    GL::bindVAO(0);
+    if (vertexCount > _maxVertexCapacity || indexCount > _maxIndexCapacity)
+        return false;
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
-    
+    // grow geometrically, so that a heavy frame settles after a few reallocations
+    if (vertexCount > _vertexCapacity)
+    {
+        _vertexCapacity = std::min(std::max(vertexCount, _vertexCapacity * 2), _maxVertexCapacity);
+        _verts = (V3F_C4B_T2F*) realloc(_verts, sizeof(_verts[0]) * _vertexCapacity);
+    }
+    if (indexCount > _indexCapacity)
+    {
+        _indexCapacity = std::min(std::max(indexCount, _indexCapacity * 2), _maxIndexCapacity);
+        _indices = realloc(_indices, sizeof(GLuint) * _indexCapacity);
+    }
+    return true;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+void Renderer::streamToSlot(int index, bool uintIndices)
+{
+    auto& slot = _streamSlots[index];
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+#if CC_RENDERER_SYNC_OBJECTS
+    if (slot.fence)
+    {
+        GLsync fence = (GLsync) slot.fence;
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            // the GPU is still reading what was streamed into this slot STREAM_RING_SIZE flushes ago
+            ++_streamStalls;
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        }
+        glDeleteSync(fence);
+        slot.fence = nullptr;
+    }
+#endif
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    streamToBuffer(GL_ARRAY_BUFFER, slot.vbo[0], slot.capacity[0], _verts, sizeof(_verts[0]) * _filledVertex);
+    streamToBuffer(GL_ELEMENT_ARRAY_BUFFER, slot.vbo[1], slot.capacity[1], _indices, (uintIndices ? sizeof(GLuint) : sizeof(GLushort)) * _filledIndex);
+}
 
-    CHECK_GL_ERROR_DEBUG();
+void Renderer::streamToBuffer(GLenum target, GLuint buffer, GLsizeiptr& capacity, const void* data, GLsizeiptr size)
+{
+    glBindBuffer(target, buffer);
+    if (size == 0)
+        return;
+
+    if (size > capacity)
+    {
+        // re-specifying the storage orphans it as well
+        capacity = std::max(size, capacity * 2);
+        glBufferData(target, capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    else if (!_streamFences)
+    {
+        // orphan with the same size and usage, so that the driver can hand out new storage
+        // instead of waiting for the draws still reading the old one
+        glBufferData(target, capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    _streamedBytes += size;
+
+#if CC_RENDERER_SYNC_OBJECTS
+    if (_streamFences)
+    {
+        // the fence of the slot was waited for, nothing else reads the storage
+        void* buf = glMapBufferRange(target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (buf)
+        {
+            memcpy(buf, data, size);
+            glUnmapBuffer(target);
+            return;
+        }
+    }
+#endif
+    glBufferSubData(target, 0, size, data);
+}
+
+// commands added on a worker thread of a parallel visit, merged by the main thread later
+static thread_local Renderer::VisitList* s_visitList = nullptr;
+
+void Renderer::setVisitList(VisitList* list)
+{
+    s_visitList = list;
+}
+
+Renderer::VisitList* Renderer::getVisitList()
+{
+    return s_visitList;
 }
 
 void Renderer::addCommand(RenderCommand* command)
 {
+    if (s_visitList)
+    {
+        s_visitList->push_back({command, nullptr, nullptr, 0});
+        return;
+    }
+
     int renderQueueID =_commandGroupStack.top();
     addCommand(command, renderQueueID);
 }
@@ -355,6 +591,7 @@ void Renderer::addCommand(RenderCommand* command)
 void Renderer::addCommand(RenderCommand* command, int renderQueueID)
 {
     CCASSERT(!_isRendering, "Cannot add command while rendering");
+    CCASSERT(!s_visitList, "Only the main thread can add commands to a render queue");
     CCASSERT(renderQueueID >=0, "Invalid render queue");
     CCASSERT(command->getType() != RenderCommand::Type::UNKNOWN_COMMAND, "Invalid Command Type");
 
@@ -390,12 +627,16 @@ void Renderer::processRenderCommand(RenderCommand* command)
 
         auto cmd = static_cast<TrianglesCommand*>(command);
         
-        // flush own queue when buffer is full
-        if(_filledVertex + cmd->getVertexCount() > VBO_SIZE || _filledIndex + cmd->getIndexCount() > INDEX_VBO_SIZE)
+        // grow the buffers when they are full, and flush own queue only when they can not grow any further
+        if(_filledVertex + cmd->getVertexCount() > _vertexCapacity || _filledIndex + cmd->getIndexCount() > _indexCapacity)
         {
-            CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
-            CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() < INDEX_VBO_SIZE, "VBO for index is not big enough, please break the data down or use customized render command");
-            drawBatchedTriangles();
+            if (!reserveStreamCapacity(_filledVertex + (int) cmd->getVertexCount(), _filledIndex + (int) cmd->getIndexCount()))
+            {
+                CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() <= _maxVertexCapacity, "VBO for vertex is not big enough, please break the data down or use customized render command");
+                CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() <= _maxIndexCapacity, "VBO for index is not big enough, please break the data down or use customized render command");
+                drawBatchedTriangles();
+                reserveStreamCapacity((int) cmd->getVertexCount(), (int) cmd->getIndexCount());
+            }
         }
         
         // queue it
@@ -708,20 +949,17 @@ void Renderer::setDepthTest(bool enable)
 
 void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
 {
-    memcpy(&_verts[_filledVertex], cmd->getVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
+    // copy the vertices and convert them to world coordinates in one pass
+    MathUtil::transformVertices(&_verts[_filledVertex], cmd->getVertices(), cmd->getModelView().m, (int) cmd->getVertexCount());
 
-    // fill vertex, and convert them to world coordinates
-    const Mat4& modelView = cmd->getModelView();
-    for(ssize_t i=0; i < cmd->getVertexCount(); ++i)
+    // fill index
+    if (_uintIndices)
     {
-        modelView.transformPoint(&(_verts[i + _filledVertex].vertices));
+        MathUtil::offsetIndices(static_cast<GLuint*>(_indices) + _filledIndex, cmd->getIndices(), (GLuint) _filledVertex, (int) cmd->getIndexCount());
     }
-
-    // fill index
-    const unsigned short* indices = cmd->getIndices();
-    for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
+    else
     {
-        _indices[_filledIndex + i] = _filledVertex + indices[i];
+        MathUtil::offsetIndices(static_cast<GLushort*>(_indices) + _filledIndex, cmd->getIndices(), (GLushort) _filledVertex, (int) cmd->getIndexCount());
     }
 
     _filledVertex += cmd->getVertexCount();
@@ -735,6 +973,8 @@ void Renderer::drawBatchedTriangles()
 
     CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_BATCH_TRIANGLES");
 
+    // 16 bit indices are enough unless the queue batched more vertices
+    _uintIndices = _filledVertex > VBO_SIZE;
     _filledVertex = 0;
     _filledIndex = 0;
 
@@ -791,40 +1031,22 @@ void Renderer::drawBatchedTriangles()
 
     /************** 2: Copy vertices/indices to GL objects *************/
     auto conf = Configuration::getInstance();
-    if (conf->supportsShareableVAO() && conf->supportsMapBuffer())
+    const bool useVAO = conf->supportsShareableVAO() && conf->supportsMapBuffer();
+    const int slot = _currentStreamSlot;
+    _currentStreamSlot = (_currentStreamSlot + 1) % STREAM_RING_SIZE;
+    if (useVAO)
     {
-        //Bind VAO
-        GL::bindVAO(_buffersVAO);
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        // option 1: subdata
-//        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-
-        // option 2: data
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, _verts, GL_STATIC_DRAW);
-
-        // option 3: orphaning + glMapBuffer
-        // FIXME: in order to work as fast as possible, it must "and the exact same size and usage hints it had before."
-        //  source: https://www.opengl.org/wiki/Buffer_Object_Streaming#Explicit_multiple_buffering
-        // so most probably we won't have any benefit of using it
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, nullptr, GL_STATIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _verts, sizeof(_verts[0]) * _filledVertex);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
-
+        //Bind VAO, it already holds the layout of the slot's buffers
+        GL::bindVAO(_streamSlots[slot].vao);
+        streamToSlot(slot, _uintIndices);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
     }
     else
     {
         // Client Side Arrays
 #define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex , _verts, GL_DYNAMIC_DRAW);
+        streamToSlot(slot, _uintIndices);
+        glBindBuffer(GL_ARRAY_BUFFER, _streamSlots[slot].vbo[0]);
 
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
@@ -836,23 +1058,29 @@ void Renderer::drawBatchedTriangles()
 
         // tex coords
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
     }
 
     /************** 3: Draw *************/
+    const GLenum indexType = _uintIndices ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    const size_t indexSize = _uintIndices ? sizeof(GLuint) : sizeof(GLushort);
     for (int i=0; i<batchesTotal; ++i)
     {
         CC_ASSERT(_triBatchesToDraw[i].cmd && "Invalid batch");
         _triBatchesToDraw[i].cmd->useMaterial();
-        glDrawElements(GL_TRIANGLES, (GLsizei) _triBatchesToDraw[i].indicesToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (_triBatchesToDraw[i].offset*sizeof(_indices[0])) );
+        glDrawElements(GL_TRIANGLES, (GLsizei) _triBatchesToDraw[i].indicesToDraw, indexType, (GLvoid*) (_triBatchesToDraw[i].offset*indexSize) );
         _drawnBatches++;
         _drawnVertices += _triBatchesToDraw[i].indicesToDraw;
     }
 
+#if CC_RENDERER_SYNC_OBJECTS
+    if (_streamFences)
+    {
+        _streamSlots[slot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+#endif
+
     /************** 4: Cleanup *************/
-    if (conf->supportsShareableVAO() && conf->supportsMapBuffer())
+    if (useVAO)
     {
         //Unbind VAO
         GL::bindVAO(0);
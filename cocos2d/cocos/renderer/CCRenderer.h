@@ -62,11 +62,14 @@ NS_CC_BEGIN
 class EventListenerCustom;
 class TrianglesCommand;
 class MeshCommand;
+class Node;
 
 /** Class that knows how to sort `RenderCommand` objects.
  Since the commands that have `z == 0` are "pushed back" in
  the correct order, the only `RenderCommand` objects that need to be sorted,
- are the ones that have `z < 0` and `z > 0`.
+ are the ones that have `z < 0` and `z > 0`, the transparent 3D ones by depth,
+ and the opaque 3D ones, whose meshes are grouped by material.
+ Each sub queue is sorted by a 64 bit key with a stable radix sort.
 */
 class RenderQueue {
 public:
@@ -114,8 +117,18 @@ public:
     void restoreRenderState();
     
 protected:
+    struct SortEntry {
+        uint64_t key;
+        RenderCommand* command;
+    };
+    /**Sorts the commands by the keys in _sortEntries, keeping the order of equal keys.*/
+    void radixSort(std::vector<RenderCommand*>& commands);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
+    /**Keys of the sub queue being sorted, and the buffer the radix sort scatters into.*/
+    std::vector<SortEntry> _sortEntries;
+    std::vector<SortEntry> _sortScratch;
     
     /**Cull state.*/
     bool _isCullEnabled;
@@ -141,14 +154,29 @@ Whenever possible prefer to use `TrianglesCommand` objects since the renderer wi
 class CC_DLL Renderer
 {
 public:
-    /**The max number of vertices in a vertex buffer object.*/
+    /**The initial number of vertices in a vertex buffer object, and the max one when 32 bit indices are not supported.*/
     static const int VBO_SIZE = 65536;
-    /**The max number of indices in a index buffer.*/
+    /**The initial number of indices in a index buffer.*/
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
+    /**The max number of vertices batched into a single draw when 32 bit indices are supported.*/
+    static const int MAX_VBO_SIZE = VBO_SIZE * 16;
+    /**The max number of indices batched into a single draw when 32 bit indices are supported.*/
+    static const int MAX_INDEX_VBO_SIZE = MAX_VBO_SIZE * 6 / 4;
+    /**The number of buffer objects the batched triangles are streamed through in turn.*/
+    static const int STREAM_RING_SIZE = 3;
     /**The rendercommands which can be batched will be saved into a list, this is the reserved size of this list.*/
     static const int BATCH_TRIAGCOMMAND_RESERVED_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
     static const int MATERIAL_ID_DO_NOT_BATCH = 0;
+    /**What a worker thread of a parallel visit produced: a command, or a node left for the main thread.*/
+    struct VisitEntry {
+        RenderCommand* command;
+        Node* node;
+        const Mat4* parentTransform;
+        uint32_t parentFlags;
+    };
+    typedef std::vector<VisitEntry> VisitList;
+
     /**Constructor.*/
     Renderer();
     /**Destructor.*/
@@ -157,9 +185,14 @@ public:
     //TODO: manage GLView inside Render itself
     void initGLView();
 
-    /** Adds a `RenderComamnd` into the renderer */
+    /** Adds a `RenderComamnd` into the renderer, or into the visit list of the calling thread */
     void addCommand(RenderCommand* command);
 
+    /** Makes addCommand() append to list on the calling thread, nullptr adds to the render queues again */
+    static void setVisitList(VisitList* list);
+    /** Returns the visit list of the calling thread, nullptr unless it visits a subtree for a parallel visit */
+    static VisitList* getVisitList();
+
     /** Adds a `RenderComamnd` into the renderer specifying a particular render queue ID */
     void addCommand(RenderCommand* command, int renderQueueID);
 
@@ -193,8 +226,12 @@ public:
     ssize_t getDrawnVertices() const { return _drawnVertices; }
     /* RenderCommands (except) TrianglesCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
+    /* returns the number of vertex and index bytes streamed to the GPU by the batched triangles in the last frame */
+    size_t getStreamedBytes() const { return _streamedBytes; }
+    /* returns how many times streaming had to wait for the GPU to release a buffer in the last frame */
+    ssize_t getStreamStalls() const { return _streamStalls; }
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; _streamedBytes = 0; _streamStalls = 0; }
 
     /**
      * Enable/Disable depth test
@@ -215,9 +252,14 @@ protected:
     void setupBuffer();
     void setupVBOAndVAO();
     void setupVBO();
-    void mapBuffers();
     void drawBatchedTriangles();
 
+    // Grows the client side arrays to hold the given counts, returns false when they would exceed the max
+    bool reserveStreamCapacity(int vertexCount, int indexCount);
+    // Waits until the GPU is done with the slot, and uploads the filled vertices and indices into it
+    void streamToSlot(int slot, bool uintIndices);
+    void streamToBuffer(GLenum target, GLuint buffer, GLsizeiptr& capacity, const void* data, GLsizeiptr size);
+
     //Draw the previews queued triangles and flush previous context
     void flush();
     
@@ -244,10 +286,24 @@ protected:
     std::vector<TrianglesCommand*> _queuedTriangleCommands;
 
     //for TrianglesCommand
-    V3F_C4B_T2F _verts[VBO_SIZE];
-    GLushort _indices[INDEX_VBO_SIZE];
-    GLuint _buffersVAO;
-    GLuint _buffersVBO[2]; //0: vertex  1: indices
+    V3F_C4B_T2F* _verts;
+    void* _indices; // GLuint storage, filled with GLushort when the batch fits in 16 bits
+    int _vertexCapacity;
+    int _indexCapacity;
+    int _maxVertexCapacity;
+    int _maxIndexCapacity;
+    bool _uintIndices;
+
+    // the batched triangles rotate through these, so that writing one does not wait on the draws of the others
+    struct StreamSlot {
+        GLuint vao;
+        GLuint vbo[2]; //0: vertex  1: indices
+        GLsizeiptr capacity[2];
+        void* fence; // GLsync, where sync objects are available
+    };
+    StreamSlot _streamSlots[STREAM_RING_SIZE];
+    int _currentStreamSlot;
+    bool _streamFences;
 
     // Internal structure that has the information for the batches
     struct TriBatchToDraw {
@@ -268,6 +324,8 @@ protected:
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    size_t _streamedBytes;
+    ssize_t _streamStalls;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
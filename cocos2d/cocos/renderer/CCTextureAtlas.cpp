@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "renderer/CCTextureAtlas.h"
 
 #include <stdlib.h>
+#include <algorithm>
 
 #include "base/ccMacros.h"
 #include "base/ccUTF8.h"
@@ -42,6 +43,7 @@ THE SOFTWARE.
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/CCTexture2D.h"
+#include "renderer/CCQuadIndexBuffer.h"
 #include "platform/CCGL.h"
 
 //According to some tests GL_TRIANGLE_STRIP is slower, MUCH slower. Probably I'm doing something very wrong
@@ -51,7 +53,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 TextureAtlas::TextureAtlas()
-    :_indices(nullptr)
+    :_quadIndices(nullptr)
     ,_dirty(false)
     ,_texture(nullptr)
     ,_quads(nullptr)
@@ -65,9 +67,9 @@ TextureAtlas::~TextureAtlas()
     CCLOGINFO("deallocing TextureAtlas: %p", this);
 
     CC_SAFE_FREE(_quads);
-    CC_SAFE_FREE(_indices);
+    CC_SAFE_RELEASE(_quadIndices);
 
-    glDeleteBuffers(2, _buffersVBO);
+    glDeleteBuffers(1, _buffersVBO);
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
@@ -170,16 +172,13 @@ bool TextureAtlas::initWithTexture(Texture2D *texture, ssize_t capacity)
     CC_SAFE_RETAIN(_texture);
 
     // Re-initialization is not allowed
-    CCASSERT(_quads == nullptr && _indices == nullptr, "_quads and _indices should be nullptr.");
+    CCASSERT(_quads == nullptr && _quadIndices == nullptr, "_quads and _quadIndices should be nullptr.");
 
     _quads = (V3F_C4B_T2F_Quad*)malloc( _capacity * sizeof(V3F_C4B_T2F_Quad) );
-    _indices = (GLushort *)malloc( _capacity * 6 * sizeof(GLushort) );
     
-    if( ! ( _quads && _indices) && _capacity > 0) 
+    if( ! _quads && _capacity > 0) 
     {
         //CCLOG("cocos2d: TextureAtlas: not enough memory");
-        CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
 
         // release texture, should set it to null, because the destruction will
         // release it too. see cocos2d-x issue #484
@@ -188,15 +187,14 @@ bool TextureAtlas::initWithTexture(Texture2D *texture, ssize_t capacity)
     }
 
     memset( _quads, 0, _capacity * sizeof(V3F_C4B_T2F_Quad) );
-    memset( _indices, 0, _capacity * 6 * sizeof(GLushort) );
+
+    _quadIndices = QuadIndexBuffer::acquire(_capacity);
     
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     /** listen the event that renderer was recreated on Android/WP8 */
     _rendererRecreatedListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, CC_CALLBACK_1(TextureAtlas::listenRendererRecreated, this));
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, -1);
 #endif
-    
-    this->setupIndices();
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
@@ -233,34 +231,19 @@ std::string TextureAtlas::getDescription() const
 }
 
 
-void TextureAtlas::setupIndices()
-{
-    if (_capacity == 0)
-        return;
-
-    for( int i=0; i < _capacity; i++)
-    {
-        _indices[i*6+0] = i*4+0;
-        _indices[i*6+1] = i*4+1;
-        _indices[i*6+2] = i*4+2;
-
-        // inverted index. issue #179
-        _indices[i*6+3] = i*4+3;
-        _indices[i*6+4] = i*4+2;
-        _indices[i*6+5] = i*4+1;        
-    }
-}
-
 //TextureAtlas - VAO / VBO specific
 
 void TextureAtlas::setupVBOandVAO()
 {
+    // may upload the indices, so fetch it before binding the VAO
+    _buffersVBO[1] = _quadIndices->getVBO();
+
     glGenVertexArrays(1, &_VAOname);
     GL::bindVAO(_VAOname);
 
 #define kQuadSize sizeof(_quads[0].bl)
 
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_buffersVBO[0]);
 
     glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
     glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
@@ -278,7 +261,6 @@ void TextureAtlas::setupVBOandVAO()
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
@@ -290,7 +272,7 @@ void TextureAtlas::setupVBOandVAO()
 
 void TextureAtlas::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_buffersVBO[0]);
 
     mapBuffers();
 }
@@ -304,9 +286,7 @@ void TextureAtlas::mapBuffers()
     glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    _buffersVBO[1] = _quadIndices->getVBO();
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -465,10 +445,9 @@ bool TextureAtlas::resizeCapacity(ssize_t newCapacity)
     _capacity = newCapacity;
 
     V3F_C4B_T2F_Quad* tmpQuads = nullptr;
-    GLushort* tmpIndices = nullptr;
 
     // when calling initWithTexture(fileName, 0) on bada device, calloc(0, 1) will fail and return nullptr,
-    // so here must judge whether _quads and _indices is nullptr.
+    // so here must judge whether _quads is nullptr.
 
     ssize_t _quads_size = sizeof(_quads[0]);
     ssize_t new_quads_size = _capacity * _quads_size;
@@ -490,42 +469,16 @@ bool TextureAtlas::resizeCapacity(ssize_t newCapacity)
         _quads = nullptr;
     }
 
-    ssize_t _indices_size = sizeof(_indices[0]);
-    ssize_t new_size = _capacity * 6 * _indices_size;
-
-    if (_indices == nullptr)
-    {
-        tmpIndices = (GLushort*)malloc(new_size);
-        if (tmpIndices != nullptr)
-        {
-            memset(tmpIndices, 0, new_size);
-        }
-    }
-    else
-    {
-        tmpIndices = (GLushort*)realloc(_indices, new_size);
-        if (tmpIndices != nullptr && _capacity > oldCapacity)
-        {
-            memset(tmpIndices + oldCapacity, 0, (_capacity - oldCapacity) * 6 * _indices_size);
-        }
-        _indices = nullptr;
-    }
-
-    if (!(tmpQuads && tmpIndices)) {
+    if (!tmpQuads) {
         CCLOG("cocos2d: TextureAtlas: not enough memory");
-        CC_SAFE_FREE(tmpQuads);
-        CC_SAFE_FREE(tmpIndices);
         CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
         _capacity = _totalQuads = 0;
         return false;
     }
 
     _quads = tmpQuads;
-    _indices = tmpIndices;
-
 
-    setupIndices();
+    _quadIndices->reserve(_capacity);
     mapBuffers();
 
     _dirty = true;
@@ -610,8 +563,15 @@ void TextureAtlas::drawNumberOfQuads(ssize_t numberOfQuads, ssize_t start)
 {
     CCASSERT(numberOfQuads>=0 && start>=0, "numberOfQuads and start must be >= 0");
 
-    if(!numberOfQuads)
+    // without 32 bit index support the shared indices may not reach the whole atlas
+    numberOfQuads = std::min(numberOfQuads, _quadIndices->getCapacity() - start);
+    if(numberOfQuads <= 0)
         return;
+
+    // before binding the VAO: it may upload the indices
+    GLuint indicesVBO = _quadIndices->getVBO();
+    GLenum indexType = _quadIndices->getIndexType();
+    size_t indexOffset = start * 6 * _quadIndices->getSizePerIndex();
     
     GL::bindTexture2D(_texture);
 
@@ -646,10 +606,10 @@ void TextureAtlas::drawNumberOfQuads(ssize_t numberOfQuads, ssize_t start)
         GL::bindVAO(_VAOname);
 
 #if CC_REBIND_INDICES_BUFFER
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesVBO);
 #endif
 
-        glDrawElements(GL_TRIANGLES, (GLsizei) numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(_indices[0])) );
+        glDrawElements(GL_TRIANGLES, (GLsizei) numberOfQuads*6, indexType, (GLvoid*) indexOffset);
         
         GL::bindVAO(0);
         
@@ -686,9 +646,9 @@ void TextureAtlas::drawNumberOfQuads(ssize_t numberOfQuads, ssize_t start)
         // tex coords
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesVBO);
 
-        glDrawElements(GL_TRIANGLES, (GLsizei)numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(_indices[0])));
+        glDrawElements(GL_TRIANGLES, (GLsizei)numberOfQuads*6, indexType, (GLvoid*) indexOffset);
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
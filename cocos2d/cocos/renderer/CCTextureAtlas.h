@@ -40,6 +40,7 @@ NS_CC_BEGIN
 class Texture2D;
 class EventCustom;
 class EventListenerCustom;
+class QuadIndexBuffer;
 
 /**
  * @addtogroup _2d
@@ -241,15 +242,14 @@ public:
 private:
     void renderCommand();
 
-    void setupIndices();
     void mapBuffers();
     void setupVBOandVAO();
     void setupVBO();
 
 protected:
-    GLushort*           _indices;
+    QuadIndexBuffer*    _quadIndices;
     GLuint              _VAOname;
-    GLuint              _buffersVBO[2]; //0: vertex  1: indices
+    GLuint              _buffersVBO[2]; //0: vertex  1: indices, owned by _quadIndices
     bool                _dirty; //indicates whether or not the array buffer of the VBO needs to be updated
     /** quantity of quads that are going to be drawn */
     ssize_t _totalQuads;
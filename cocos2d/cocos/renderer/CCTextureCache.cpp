@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <chrono>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
@@ -39,8 +41,11 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 #include "base/ccUtils.h"
 #include "base/CCNinePatchImageParser.h"
+#include "base/CCConfiguration.h"
+#include "xxhash.h"
 
 
 
@@ -68,10 +73,13 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _asyncUploadTimeBudget(0)
 , _needQuit(false)
 , _asyncRefCount(0)
 {
+    // the main thread uploads the textures
+    unsigned int cores = std::thread::hardware_concurrency();
+    _asyncWorkerCount = cores > 1 ? cores - 1 : 1;
 }
 
 TextureCache::~TextureCache()
@@ -81,7 +89,10 @@ TextureCache::~TextureCache()
     for (auto& texture : _textures)
         texture.second->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    if (!_loadingThreads.empty())
+    {
+        waitForQuit();
+    }
 }
 
 void TextureCache::destroyInstance()
@@ -102,6 +113,26 @@ std::string TextureCache::getDescription() const
     return StringUtils::format("<TextureCache | Number of textures = %d>", static_cast<int>(_textures.size()));
 }
 
+struct TextureCache::DiskCacheEntry
+{
+    DiskCacheEntry()
+      : pixels(nullptr), pixelsLen(0), pixelFormat(Texture2D::PixelFormat::NONE),
+        width(0), height(0), hasPremultipliedAlpha(false)
+    {}
+
+    std::string filePath;
+    // the entry mapped from the disk
+    MappedFile file;
+    // the converted pixels of a new entry, when they are not the pixels of the image
+    Data data;
+    const unsigned char* pixels;
+    ssize_t pixelsLen;
+    Texture2D::PixelFormat pixelFormat;
+    int width;
+    int height;
+    bool hasPremultipliedAlpha;
+};
+
 struct TextureCache::AsyncStruct
 {
 public:
@@ -110,7 +141,9 @@ public:
       const std::string& key )
       : filename(fn), callback(f),callbackKey( key ),
         pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
+        priority(AsyncPriority::VISIBLE),
+        loadSuccess(false),
+        cancelled(false)
     {}
 
     std::string filename;
@@ -119,15 +152,22 @@ public:
     Image image;
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
+    AsyncPriority priority;
+    DiskCacheEntry diskCacheEntry;
     bool loadSuccess;
+    // set by cancelImageAsync() once the request was taken by a loading thread
+    bool cancelled;
 };
 
 /**
  The addImageAsync logic follow the steps:
  - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
+ - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load threads)
  - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
 
+ There are getAsyncWorkerCount() load threads, so the responses may come in any order.
+ _requestQueue is sorted by priority, the requests of a priority staying in order.
+
  the Critical Area include these members:
  - _requestQueue: locked by _requestMutex
  - _responseQueue: locked by _responseMutex
@@ -190,6 +230,11 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  unbindImageAsync(path) would be ambiguous.
  */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+{
+    addImageAsync(path, callback, callbackKey, AsyncPriority::VISIBLE);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority)
 {
     Texture2D *texture = nullptr;
 
@@ -212,11 +257,14 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     }
 
     // lazy init
-    if (_loadingThread == nullptr)
+    if (_loadingThreads.empty())
     {
-        // create a new thread to load images
         _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
+    }
+    while (_loadingThreads.size() < _asyncWorkerCount)
+    {
+        // create the threads to load images
+        _loadingThreads.emplace_back(&TextureCache::loadImage, this);
     }
 
     if (0 == _asyncRefCount)
@@ -229,11 +277,15 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     // generate async struct
     AsyncStruct *data =
       new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+    data->priority = priority;
     
-    // add async struct into queue
+    // add async struct into queue, after the requests of the same or a higher priority
     _asyncStructQueue.push_back(data);
     std::unique_lock<std::mutex> ul(_requestMutex);
-    _requestQueue.push_back(data);
+    auto position = std::find_if(_requestQueue.begin(), _requestQueue.end(), [priority](AsyncStruct* request) {
+        return request->priority < priority;
+    });
+    _requestQueue.insert(position, data);
     _sleepCondition.notify_one();
 }
 
@@ -266,6 +318,66 @@ void TextureCache::unbindAllImageAsync()
     }
 }
 
+void TextureCache::cancelImageAsync(const std::string& callbackKey)
+{
+    std::vector<AsyncStruct*> dropped;
+    {
+        std::unique_lock<std::mutex> ul(_requestMutex);
+        // the requests not taken by a loading thread yet
+        auto end = std::remove_if(_requestQueue.begin(), _requestQueue.end(), [&callbackKey, &dropped](AsyncStruct* request) {
+            if (request->callbackKey != callbackKey)
+                return false;
+            dropped.push_back(request);
+            return true;
+        });
+        _requestQueue.erase(end, _requestQueue.end());
+    }
+
+    for (auto& asyncStruct : _asyncStructQueue)
+    {
+        if (asyncStruct->callbackKey == callbackKey)
+        {
+            asyncStruct->callback = nullptr;
+            asyncStruct->cancelled = true;
+        }
+    }
+
+    releaseAsyncStructs(dropped);
+}
+
+void TextureCache::cancelAllImageAsync()
+{
+    std::vector<AsyncStruct*> dropped;
+    {
+        std::unique_lock<std::mutex> ul(_requestMutex);
+        dropped.assign(_requestQueue.begin(), _requestQueue.end());
+        _requestQueue.clear();
+    }
+
+    for (auto& asyncStruct : _asyncStructQueue)
+    {
+        asyncStruct->callback = nullptr;
+        asyncStruct->cancelled = true;
+    }
+
+    releaseAsyncStructs(dropped);
+}
+
+void TextureCache::releaseAsyncStructs(const std::vector<AsyncStruct*>& asyncStructs)
+{
+    for (auto asyncStruct : asyncStructs)
+    {
+        _asyncStructQueue.erase(std::find(_asyncStructQueue.begin(), _asyncStructQueue.end(), asyncStruct));
+        delete asyncStruct;
+        --_asyncRefCount;
+    }
+
+    if (!asyncStructs.empty() && 0 == _asyncRefCount)
+    {
+        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
+    }
+}
+
 void TextureCache::loadImage()
 {
     AsyncStruct *asyncStruct = nullptr;
@@ -293,7 +405,14 @@ void TextureCache::loadImage()
         ul.unlock();
 
         // load image
-        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+        if (!_diskCachePath.empty() && !NinePatchImageParser::isNinePatchImage(asyncStruct->filename))
+        {
+            asyncStruct->loadSuccess = loadImageWithDiskCache(asyncStruct->filename, asyncStruct->pixelFormat, &asyncStruct->image, &asyncStruct->diskCacheEntry);
+        }
+        else
+        {
+            asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+        }
 
         // ETC1 ALPHA supports.
         if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
@@ -313,6 +432,7 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
     Texture2D *texture = nullptr;
     AsyncStruct *asyncStruct = nullptr;
+    auto start = std::chrono::steady_clock::now();
     while (true)
     {
         // pop an AsyncStruct from response queue
@@ -325,10 +445,6 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         {
             asyncStruct = _responseQueue.front();
             _responseQueue.pop_front();
-
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
         }
         _responseMutex.unlock();
 
@@ -336,12 +452,19 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
             break;
         }
 
+        // the loading threads finish in any order
+        _asyncStructQueue.erase(std::find(_asyncStructQueue.begin(), _asyncStructQueue.end(), asyncStruct));
+
         // check the image has been convert to texture or not
         auto it = _textures.find(asyncStruct->filename);
         if (it != _textures.end())
         {
             texture = it->second;
         }
+        else if (asyncStruct->cancelled)
+        {
+            texture = nullptr;
+        }
         else
         {
             // convert image to texture
@@ -351,7 +474,14 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                 // generate texture in render thread
                 texture = new (std::nothrow) Texture2D();
 
-                texture->initWithImage(image, asyncStruct->pixelFormat);
+                if (asyncStruct->diskCacheEntry.pixels)
+                {
+                    initTextureWithDiskCacheEntry(texture, asyncStruct->diskCacheEntry);
+                }
+                else
+                {
+                    texture->initWithImage(image, asyncStruct->pixelFormat);
+                }
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, asyncStruct->filename);
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -387,6 +517,14 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         // release the asyncStruct
         delete asyncStruct;
         --_asyncRefCount;
+
+        // the remaining textures are created in the next frames
+        if (_asyncUploadTimeBudget > 0)
+        {
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= _asyncUploadTimeBudget)
+                break;
+        }
     }
 
     if (0 == _asyncRefCount)
@@ -420,12 +558,21 @@ Texture2D * TextureCache::addImage(const std::string &path)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
-            bool bRet = image->initWithImageFile(fullpath);
+            DiskCacheEntry entry;
+            bool bRet = false;
+            if (!_diskCachePath.empty() && !NinePatchImageParser::isNinePatchImage(path))
+            {
+                bRet = loadImageWithDiskCache(fullpath, Texture2D::getDefaultAlphaPixelFormat(), image, &entry);
+            }
+            else
+            {
+                bRet = image->initWithImageFile(fullpath);
+            }
             CC_BREAK_IF(!bRet);
 
             texture = new (std::nothrow) Texture2D();
 
-            if (texture && texture->initWithImage(image))
+            if (texture && (entry.pixels ? initTextureWithDiskCacheEntry(texture, entry) : texture->initWithImage(image)))
             {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
@@ -466,6 +613,184 @@ Texture2D * TextureCache::addImage(const std::string &path)
     return texture;
 }
 
+namespace
+{
+    const char DISK_CACHE_MAGIC[4] = { 'C', 'C', 'T', 'X' };
+    const uint32_t DISK_CACHE_VERSION = 1;
+
+    // header of a disk cache entry, followed by the pixels
+    struct DiskCacheHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t sourceHash[2];
+        uint64_t sourceSize;
+        int32_t pixelFormat;
+        int32_t width;
+        int32_t height;
+        uint32_t premultipliedAlpha;
+        uint64_t pixelsLen;
+    };
+
+    bool writeDiskCacheEntry(const std::string& entryPath, const DiskCacheHeader& header, const unsigned char* pixels)
+    {
+        // written aside and renamed, so that a loading thread never maps a partial entry
+        auto fileUtils = FileUtils::getInstance();
+        std::string tempPath = entryPath + StringUtils::format(".%p", (const void*)pixels);
+        FILE* fp = fopen(fileUtils->getSuitableFOpen(tempPath).c_str(), "wb");
+        if (!fp)
+            return false;
+
+        bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+            && fwrite(pixels, (size_t)header.pixelsLen, 1, fp) == 1;
+        written = fclose(fp) == 0 && written;
+        if (!written || !fileUtils->renameFile(tempPath, entryPath))
+        {
+            // another thread may have added the same entry
+            fileUtils->removeFile(tempPath);
+            return false;
+        }
+        return true;
+    }
+
+    // the entry is uploaded as is, so its pixels must be the rows of an uncompressed format
+    bool hasValidPixels(const DiskCacheHeader& header)
+    {
+        if (header.width <= 0 || header.height <= 0)
+            return false;
+
+        const auto& formats = Texture2D::getPixelFormatInfoMap();
+        auto iter = formats.find(static_cast<Texture2D::PixelFormat>(header.pixelFormat));
+        if (iter == formats.end() || iter->second.compressed)
+            return false;
+        return header.pixelsLen == (uint64_t)header.width * (uint64_t)header.height * iter->second.bpp / 8;
+    }
+}
+
+void TextureCache::setDiskCachePath(const std::string& path)
+{
+    _diskCachePath = path;
+    if (_diskCachePath.empty())
+        return;
+
+    if (_diskCachePath.back() != '/')
+    {
+        _diskCachePath += '/';
+    }
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isDirectoryExist(_diskCachePath) && !fileUtils->createDirectory(_diskCachePath))
+    {
+        CCLOG("cocos2d: TextureCache: can't create the disk cache %s", _diskCachePath.c_str());
+        _diskCachePath.clear();
+    }
+}
+
+void TextureCache::purgeDiskCache()
+{
+    if (_diskCachePath.empty())
+        return;
+
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->removeDirectory(_diskCachePath);
+    fileUtils->createDirectory(_diskCachePath);
+}
+
+bool TextureCache::loadImageWithDiskCache(const std::string& fullpath, Texture2D::PixelFormat format, Image* image, DiskCacheEntry* entry) const
+{
+    Data source = FileUtils::getInstance()->getDataFromFile(fullpath);
+    if (source.isNull())
+        return false;
+
+    // two seeds make a 64 bits key out of the 32 bits hash
+    uint32_t sourceHash[2];
+    sourceHash[0] = XXH32(source.getBytes(), (int)source.getSize(), 0);
+    sourceHash[1] = XXH32(source.getBytes(), (int)source.getSize(), sourceHash[0] ^ 0x9E3779B1u);
+    bool premultiply = Image::PNG_PREMULTIPLIED_ALPHA_ENABLED;
+    std::string entryPath = _diskCachePath + StringUtils::format("%08x%08x-%d%s.tex",
+        sourceHash[0], sourceHash[1], static_cast<int>(format), premultiply ? "p" : "");
+
+    entry->filePath = fullpath;
+    if (entry->file.open(entryPath) && entry->file.getSize() >= (ssize_t)sizeof(DiskCacheHeader))
+    {
+        DiskCacheHeader header;
+        memcpy(&header, entry->file.getBytes(), sizeof(header));
+        if (memcmp(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic)) == 0
+            && header.version == DISK_CACHE_VERSION
+            && header.sourceHash[0] == sourceHash[0] && header.sourceHash[1] == sourceHash[1]
+            && header.sourceSize == (uint64_t)source.getSize()
+            && header.pixelsLen == (uint64_t)(entry->file.getSize() - sizeof(header))
+            && hasValidPixels(header))
+        {
+            entry->pixels = entry->file.getBytes() + sizeof(header);
+            entry->pixelsLen = (ssize_t)header.pixelsLen;
+            entry->pixelFormat = static_cast<Texture2D::PixelFormat>(header.pixelFormat);
+            entry->width = header.width;
+            entry->height = header.height;
+            entry->hasPremultipliedAlpha = header.premultipliedAlpha != 0;
+            return true;
+        }
+        CCLOG("cocos2d: TextureCache: invalid disk cache entry %s", entryPath.c_str());
+    }
+    entry->file.close();
+
+    if (!image->initWithImageData(source.getBytes(), source.getSize()))
+        return false;
+    image->_filePath = fullpath;
+
+    // only the pixels converted from decoded files are worth caching
+    if (image->isCompressed() || image->getNumberOfMipmaps() > 1)
+        return true;
+
+    unsigned char* pixels = nullptr;
+    ssize_t pixelsLen = 0;
+    Texture2D::PixelFormat renderFormat = image->getRenderFormat();
+    Texture2D::PixelFormat pixelFormat = (Texture2D::PixelFormat::NONE == format || Texture2D::PixelFormat::AUTO == format) ? renderFormat : format;
+    pixelFormat = Texture2D::convertDataToFormat(image->getData(), image->getDataLen(), renderFormat, pixelFormat, &pixels, &pixelsLen);
+    if (pixels != image->getData())
+    {
+        entry->data.fastSet(pixels, pixelsLen);
+    }
+    entry->pixels = pixels;
+    entry->pixelsLen = pixelsLen;
+    entry->pixelFormat = pixelFormat;
+    entry->width = image->getWidth();
+    entry->height = image->getHeight();
+    entry->hasPremultipliedAlpha = image->hasPremultipliedAlpha();
+
+    DiskCacheHeader header;
+    memcpy(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic));
+    header.version = DISK_CACHE_VERSION;
+    header.sourceHash[0] = sourceHash[0];
+    header.sourceHash[1] = sourceHash[1];
+    header.sourceSize = (uint64_t)source.getSize();
+    header.pixelFormat = static_cast<int32_t>(pixelFormat);
+    header.width = entry->width;
+    header.height = entry->height;
+    header.premultipliedAlpha = entry->hasPremultipliedAlpha ? 1 : 0;
+    header.pixelsLen = (uint64_t)pixelsLen;
+    if (!writeDiskCacheEntry(entryPath, header, pixels))
+    {
+        CCLOG("cocos2d: TextureCache: can't write the disk cache entry %s", entryPath.c_str());
+    }
+    return true;
+}
+
+bool TextureCache::initTextureWithDiskCacheEntry(Texture2D* texture, const DiskCacheEntry& entry) const
+{
+    int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+    if (entry.width > maxTextureSize || entry.height > maxTextureSize)
+    {
+        CCLOG("cocos2d: WARNING: Image (%u x %u) is bigger than the supported %u x %u", entry.width, entry.height, maxTextureSize, maxTextureSize);
+        return false;
+    }
+
+    // uploaded straight from the mapped file
+    bool ret = texture->initWithData(entry.pixels, entry.pixelsLen, entry.pixelFormat, entry.width, entry.height,
+                                     Size((float)entry.width, (float)entry.height), entry.hasPremultipliedAlpha);
+    texture->_filePath = entry.filePath;
+    return ret;
+}
+
 void TextureCache::parseNinePatchImage(cocos2d::Image *image, cocos2d::Texture2D *texture, const std::string& path)
 {
     if (NinePatchImageParser::isNinePatchImage(path))
@@ -662,9 +987,13 @@ void TextureCache::waitForQuit()
     // notify sub thread to quick
     std::unique_lock<std::mutex> ul(_requestMutex);
     _needQuit = true;
-    _sleepCondition.notify_one();
+    _sleepCondition.notify_all();
     ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    for (auto& thread : _loadingThreads)
+    {
+        thread.join();
+    }
+    _loadingThreads.clear();
 }
 
 std::string TextureCache::getCachedTextureInfo() const
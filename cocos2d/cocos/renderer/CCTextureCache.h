@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
@@ -63,6 +64,13 @@ NS_CC_BEGIN
 class CC_DLL TextureCache : public Ref
 {
 public:
+    /** Priority of an asynchronous load, the requests of a higher priority are decoded first. */
+    enum class AsyncPriority
+    {
+        PREFETCH,   //!< the texture will be needed later
+        VISIBLE,    //!< the texture is needed now, the default
+    };
+
     /** Returns the shared instance of the cache. */
     CC_DEPRECATED_ATTRIBUTE static TextureCache * getInstance();
 
@@ -127,6 +135,15 @@ public:
     
     void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey );
 
+    /** Same as addImageAsync(), with a priority.
+     * Requests are decoded in order of priority, then in the order they were made.
+     * @param path The file path.
+     * @param callback A callback function would be invoked after the image is loaded.
+     * @param callbackKey The key to unbind or cancel the request with.
+     * @param priority The priority of the request.
+     */
+    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority);
+
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
@@ -140,6 +157,33 @@ public:
      */
     virtual void unbindAllImageAsync();
 
+    /** Cancels the asynchronous loads bound to a callback key, for example the prefetches of a level that was left.
+     * The requests that are not decoded yet are dropped, the others are not turned into textures.
+     * The callbacks are not called.
+     * @param callbackKey The key passed to addImageAsync(), the file path by default.
+     */
+    void cancelImageAsync(const std::string& callbackKey);
+
+    /** Cancels all the asynchronous loads. */
+    void cancelAllImageAsync();
+
+    /** Sets the number of threads decoding the asynchronous loads.
+     * The default is the number of cores minus one, at least one. Threads are added on the next
+     * asynchronous load, and the extra threads are only removed by waitForQuit().
+     * @param count The number of threads.
+     */
+    void setAsyncWorkerCount(unsigned int count) { _asyncWorkerCount = count > 0 ? count : 1; }
+    /** Gets the number of threads decoding the asynchronous loads. */
+    unsigned int getAsyncWorkerCount() const { return _asyncWorkerCount; }
+
+    /** Sets the time the main thread may spend per frame turning decoded images into textures, in seconds.
+     * At least one texture is created per frame. The default, 0, creates all the decoded ones.
+     * @param seconds The time budget.
+     */
+    void setAsyncUploadTimeBudget(float seconds) { _asyncUploadTimeBudget = seconds; }
+    /** Gets the time the main thread may spend per frame turning decoded images into textures, in seconds. */
+    float getAsyncUploadTimeBudget() const { return _asyncUploadTimeBudget; }
+
     /** Returns a Texture2D object given an Image.
     * If the image was not previously loaded, it will create a new Texture2D object and it will return it.
     * Otherwise it will return a reference of a previously loaded image.
@@ -219,6 +263,21 @@ public:
     */
     void renameTextureWithKey(const std::string& srcName, const std::string& dstName);
 
+    /** Sets the directory where decoded textures are cached between launches, disabled if empty.
+     * The pixels are stored after premultiplication and conversion to the pixel format, and
+     * they are mapped from the disk on later launches instead of being decoded again.
+     * Entries are keyed by a hash of the contents of the image file, so they are never stale.
+     * Compressed and nine-patch images are not cached.
+     * Call it before loading textures asynchronously.
+     * @param path The directory, for example under FileUtils::getWritablePath(). It is created if needed.
+     */
+    void setDiskCachePath(const std::string& path);
+    /** Gets the directory where decoded textures are cached, empty if disabled. */
+    const std::string& getDiskCachePath() const { return _diskCachePath; }
+
+    /** Removes the entries of the disk cache, including those of images that changed. */
+    void purgeDiskCache();
+
 
 private:
     void addImageAsyncCallBack(float dt);
@@ -227,8 +286,22 @@ private:
 public:
 protected:
     struct AsyncStruct;
+    struct DiskCacheEntry;
+
+    /** Maps the disk cache entry of an image file, or decodes the file and adds its entry.
+     * The entry is left empty when the image can't be cached, the image is decoded then.
+     * Thread safe.
+     */
+    bool loadImageWithDiskCache(const std::string& fullpath, Texture2D::PixelFormat format, Image* image, DiskCacheEntry* entry) const;
+    bool initTextureWithDiskCacheEntry(Texture2D* texture, const DiskCacheEntry& entry) const;
+
+    /** Deletes requests that were removed from _requestQueue. */
+    void releaseAsyncStructs(const std::vector<AsyncStruct*>& asyncStructs);
     
-    std::thread* _loadingThread;
+    std::vector<std::thread> _loadingThreads;
+    unsigned int _asyncWorkerCount;
+    float _asyncUploadTimeBudget;
+    std::string _diskCachePath;
 
     std::deque<AsyncStruct*> _asyncStructQueue;
     std::deque<AsyncStruct*> _requestQueue;
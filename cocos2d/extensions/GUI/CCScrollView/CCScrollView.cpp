@@ -68,7 +68,7 @@ ScrollView::ScrollView()
 , _touchListener(nullptr)
 , _animatedScrollAction(nullptr)
 {
-
+    setVisitThreadSafe(false);
 }
 
 ScrollView::~ScrollView()
@@ -55,7 +55,8 @@ ParticleSystem3D::ParticleSystem3D()
 , _keepLocal(false)
 , _isEnabled(true)
 {
-    
+    // the renders create and fill their GL buffers in draw()
+    setVisitThreadSafe(false);
 }
 ParticleSystem3D::~ParticleSystem3D()
 {
@@ -0,0 +1,118 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+// Packs a directory into an asset pack, mounted with FileUtils::addAssetPack().
+//
+// usage: ccpack [-z] <directory> <pack>
+//   -z  compresses the entries with zlib, except the formats that are already compressed
+
+#include "platform/CCFileUtils.h"
+#include "platform/CCAssetPack.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+
+USING_NS_CC;
+
+// the arguments are relative to the working directory, not to the search paths
+static std::string getAbsolutePath(const std::string& path)
+{
+    if (FileUtils::getInstance()->isAbsolutePath(path))
+        return path;
+
+    char cwd[4096];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return path;
+
+    std::string absolutePath = std::string(cwd) + "/" + path;
+    std::replace(absolutePath.begin(), absolutePath.end(), '\\', '/');
+    return absolutePath;
+}
+
+static bool isCompressedFormat(const std::string& extension)
+{
+    static const char* formats[] = { ".png", ".jpg", ".jpeg", ".webp", ".ccz", ".ccpb", ".mp3", ".ogg" };
+    for (auto format : formats)
+    {
+        if (extension == format)
+            return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    bool compress = argc == 4 && strcmp(argv[1], "-z") == 0;
+    if (argc != (compress ? 4 : 3))
+    {
+        fprintf(stderr, "usage: %s [-z] <directory> <pack>\n", argv[0]);
+        return 1;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string directory = getAbsolutePath(argv[argc - 2]);
+    std::string packPath = getAbsolutePath(argv[argc - 1]);
+    if (!fileUtils->isDirectoryExist(directory))
+    {
+        fprintf(stderr, "%s is not a directory\n", argv[argc - 2]);
+        return 1;
+    }
+    if (directory.back() != '/')
+    {
+        directory += '/';
+    }
+
+    std::vector<std::string> files;
+    fileUtils->listFilesRecursively(directory, &files);
+
+    AssetPackWriter writer;
+    size_t originalSize = 0;
+    for (const auto& file : files)
+    {
+        if (file.back() == '/' || file.compare(0, directory.size(), directory) != 0)
+            continue;
+
+        Data data = fileUtils->getDataFromFile(file);
+        std::string extension = fileUtils->getFileExtension(file);
+        bool compressEntry = compress && !isCompressedFormat(extension);
+        writer.addEntry(file.substr(directory.size()), data, compressEntry ? AssetPack::Compression::ZLIB : AssetPack::Compression::NONE);
+        originalSize += (size_t)data.getSize();
+    }
+
+    if (!writer.write(packPath))
+    {
+        fprintf(stderr, "can't write %s\n", packPath.c_str());
+        return 1;
+    }
+    printf("%s: %d files, %lu bytes, packed in %ld bytes\n", packPath.c_str(), (int)writer.getEntryCount(),
+           (unsigned long)originalSize, fileUtils->getFileSize(packPath));
+    return 0;
+}
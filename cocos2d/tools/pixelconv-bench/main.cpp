@@ -0,0 +1,361 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+// Checks the pixel conversion and alpha premultiplication kernels of MathUtil byte for byte
+// against the scalar loops Texture2D and Image used before, and times both for every format pair.
+//
+// usage: pixelconv-bench [width height]
+//   the size of the benchmarked images, 2048x2048 by default. Returns 1 if a kernel differs.
+
+#include "math/MathUtil.h"
+#include "platform/CCImage.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+USING_NS_CC;
+
+namespace reference
+{
+    // the loops of Texture2D and Image the kernels replace
+
+    void convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        for (ssize_t i = 0; i < dataLen; ++i)
+        {
+            *outData++ = data[i];     //R
+            *outData++ = data[i];     //G
+            *outData++ = data[i];     //B
+            *outData++ = 0xFF;        //A
+        }
+    }
+
+    void convertAI88ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
+        {
+            *outData++ = data[i];     //R
+            *outData++ = data[i];     //G
+            *outData++ = data[i];     //B
+            *outData++ = data[i + 1]; //A
+        }
+    }
+
+    void convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
+        {
+            *outData++ = data[i];         //R
+            *outData++ = data[i + 1];     //G
+            *outData++ = data[i + 2];     //B
+            *outData++ = 0xFF;            //A
+        }
+    }
+
+    void convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+        {
+            *outData++ = data[i];         //R
+            *outData++ = data[i + 1];     //G
+            *outData++ = data[i + 2];     //B
+        }
+    }
+
+    void convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        for (ssize_t i = 0, l = dataLen -3; i < l; i += 4)
+        {
+            *outData++ = data[i + 3]; //A
+        }
+    }
+
+    void convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        unsigned short* out16 = (unsigned short*)outData;
+        for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
+        {
+            *out16++ = (data[i] & 0x00F8) << 8    //R
+                | (data[i + 1] & 0x00FC) << 3     //G
+                | (data[i + 2] & 0x00F8) >> 3;    //B
+        }
+    }
+
+    void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        unsigned short* out16 = (unsigned short*)outData;
+        for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+        {
+            *out16++ = (data[i] & 0x00F8) << 8    //R
+                | (data[i + 1] & 0x00FC) << 3     //G
+                | (data[i + 2] & 0x00F8) >> 3;    //B
+        }
+    }
+
+    void convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        unsigned short* out16 = (unsigned short*)outData;
+        for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
+        {
+            *out16++ = ((data[i] & 0x00F0) << 8           //R
+                        | (data[i + 1] & 0x00F0) << 4     //G
+                        | (data[i + 2] & 0xF0)            //B
+                        |  0x0F);                         //A
+        }
+    }
+
+    void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        unsigned short* out16 = (unsigned short*)outData;
+        for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+        {
+            *out16++ = (data[i] & 0x00F0) << 8    //R
+            | (data[i + 1] & 0x00F0) << 4         //G
+            | (data[i + 2] & 0xF0)                //B
+            |  (data[i + 3] & 0xF0) >> 4;         //A
+        }
+    }
+
+    void convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        unsigned short* out16 = (unsigned short*)outData;
+        for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
+        {
+            *out16++ = (data[i] & 0x00F8) << 8    //R
+                | (data[i + 1] & 0x00F8) << 3     //G
+                | (data[i + 2] & 0x00F8) >> 2     //B
+                |  0x01;                          //A
+        }
+    }
+
+    void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+    {
+        unsigned short* out16 = (unsigned short*)outData;
+        for (ssize_t i = 0, l = dataLen - 2; i < l; i += 4)
+        {
+            *out16++ = (data[i] & 0x00F8) << 8    //R
+                | (data[i + 1] & 0x00F8) << 3     //G
+                | (data[i + 2] & 0x00F8) >> 2     //B
+                |  (data[i + 3] & 0x0080) >> 7;   //A
+        }
+    }
+
+    void premultiplyAlpha(unsigned char* data, int count)
+    {
+        unsigned int* fourBytes = (unsigned int*)data;
+        for (int i = 0; i < count; i++)
+        {
+            unsigned char* p = data + i * 4;
+            fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+        }
+    }
+
+    inline unsigned char clamp(int x)
+    {
+        return (unsigned char)(x >= 0 ? (x < 255 ? x : 255) : 0);
+    }
+
+    void reversePremultipliedAlpha(unsigned char* data, int count)
+    {
+        unsigned int* fourBytes = (unsigned int*)data;
+        for (int i = 0; i < count; i++)
+        {
+            unsigned char* p = data + i * 4;
+            if (p[3] > 0)
+            {
+                fourBytes[i] = clamp(int(std::ceil((p[0] * 255.0f) / p[3]))) |
+                    clamp(int(std::ceil((p[1] * 255.0f) / p[3]))) << 8 |
+                    clamp(int(std::ceil((p[2] * 255.0f) / p[3]))) << 16 |
+                    p[3] << 24;
+            }
+        }
+    }
+}
+
+namespace
+{
+    typedef void (*ReferenceConversion)(const unsigned char*, ssize_t, unsigned char*);
+    typedef void (*Conversion)(const unsigned char*, unsigned char*, int);
+    typedef void (*InPlace)(unsigned char*, int);
+
+    struct ConversionCase
+    {
+        const char* name;
+        int srcBytes;
+        int dstBytes;
+        ReferenceConversion reference;
+        Conversion kernel;
+    };
+
+    // the 16 bit kernels write unsigned shorts
+    template <void (*KERNEL)(const unsigned char*, unsigned short*, int)>
+    void convert16(const unsigned char* src, unsigned char* dst, int count)
+    {
+        KERNEL(src, reinterpret_cast<unsigned short*>(dst), count);
+    }
+
+    const ConversionCase CONVERSIONS[] = {
+        { "I8 -> RGBA8888", 1, 4, reference::convertI8ToRGBA8888, MathUtil::convertI8ToRGBA8888 },
+        { "AI88 -> RGBA8888", 2, 4, reference::convertAI88ToRGBA8888, MathUtil::convertAI88ToRGBA8888 },
+        { "RGB888 -> RGBA8888", 3, 4, reference::convertRGB888ToRGBA8888, MathUtil::convertRGB888ToRGBA8888 },
+        { "RGB888 -> RGB565", 3, 2, reference::convertRGB888ToRGB565, convert16<MathUtil::convertRGB888ToRGB565> },
+        { "RGB888 -> RGBA4444", 3, 2, reference::convertRGB888ToRGBA4444, convert16<MathUtil::convertRGB888ToRGBA4444> },
+        { "RGB888 -> RGB5A1", 3, 2, reference::convertRGB888ToRGB5A1, convert16<MathUtil::convertRGB888ToRGB5A1> },
+        { "RGBA8888 -> RGB888", 4, 3, reference::convertRGBA8888ToRGB888, MathUtil::convertRGBA8888ToRGB888 },
+        { "RGBA8888 -> A8", 4, 1, reference::convertRGBA8888ToA8, MathUtil::convertRGBA8888ToA8 },
+        { "RGBA8888 -> RGB565", 4, 2, reference::convertRGBA8888ToRGB565, convert16<MathUtil::convertRGBA8888ToRGB565> },
+        { "RGBA8888 -> RGBA4444", 4, 2, reference::convertRGBA8888ToRGBA4444, convert16<MathUtil::convertRGBA8888ToRGBA4444> },
+        { "RGBA8888 -> RGB5A1", 4, 2, reference::convertRGBA8888ToRGB5A1, convert16<MathUtil::convertRGBA8888ToRGB5A1> },
+    };
+
+    struct InPlaceCase
+    {
+        const char* name;
+        InPlace reference;
+        InPlace kernel;
+    };
+
+    const InPlaceCase IN_PLACE[] = {
+        { "premultiplyAlpha", reference::premultiplyAlpha, MathUtil::premultiplyAlpha },
+        { "reversePremultipliedAlpha", reference::reversePremultipliedAlpha, MathUtil::reversePremultipliedAlpha },
+    };
+
+    std::vector<unsigned char> randomBytes(size_t size)
+    {
+        std::vector<unsigned char> bytes(size);
+        unsigned int seed = 0x12345678u;
+        for (auto& byte : bytes)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            byte = (unsigned char)(seed >> 24);
+        }
+        return bytes;
+    }
+
+    // best of a few runs, in milliseconds
+    template <typename F>
+    double measure(F&& run)
+    {
+        double best = 1e30;
+        for (int i = 0; i < 5; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best = std::min(best, elapsed);
+        }
+        return best;
+    }
+
+    bool checkConversion(const ConversionCase& test, const std::vector<unsigned char>& src, int count)
+    {
+        // one guard byte past the pixels, the kernels must not write there
+        std::vector<unsigned char> expected(count * test.dstBytes + 1, 0xCD);
+        std::vector<unsigned char> actual(count * test.dstBytes + 1, 0xCD);
+        test.reference(src.data(), (ssize_t)count * test.srcBytes, expected.data());
+        test.kernel(src.data(), actual.data(), count);
+        return expected == actual;
+    }
+
+    bool checkInPlace(const InPlaceCase& test, const std::vector<unsigned char>& pixels)
+    {
+        std::vector<unsigned char> expected(pixels);
+        std::vector<unsigned char> actual(pixels);
+        int count = (int)pixels.size() / 4;
+        test.reference(expected.data(), count);
+        test.kernel(actual.data(), count);
+        return expected == actual;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int width = 2048;
+    int height = 2048;
+    if (argc == 3)
+    {
+        width = atoi(argv[1]);
+        height = atoi(argv[2]);
+    }
+    if (argc != 1 && (argc != 3 || width <= 0 || height <= 0))
+    {
+        fprintf(stderr, "usage: %s [width height]\n", argv[0]);
+        return 1;
+    }
+    int count = width * height;
+    auto src = randomBytes((size_t)count * 4);
+
+    // every color of every channel with every alpha
+    std::vector<unsigned char> colorAlphaPairs(65536 * 4);
+    for (int i = 0; i < 65536; ++i)
+    {
+        colorAlphaPairs[i * 4] = (unsigned char)i;
+        colorAlphaPairs[i * 4 + 1] = (unsigned char)(i ^ 0x55);
+        colorAlphaPairs[i * 4 + 2] = (unsigned char)(255 - (i & 0xFF));
+        colorAlphaPairs[i * 4 + 3] = (unsigned char)(i >> 8);
+    }
+
+    bool identical = true;
+    printf("%-28s %10s %10s %8s  %s\n", "", "scalar ms", "kernel ms", "speedup", "check");
+    for (const auto& test : CONVERSIONS)
+    {
+        // odd counts exercise the remainders of the vector loops
+        bool ok = checkConversion(test, src, count);
+        for (int n = 1; n < 67 && ok; ++n)
+        {
+            ok = checkConversion(test, src, n);
+        }
+        identical = identical && ok;
+
+        std::vector<unsigned char> dst((size_t)count * test.dstBytes);
+        double scalar = measure([&] { test.reference(src.data(), (ssize_t)count * test.srcBytes, dst.data()); });
+        double kernel = measure([&] { test.kernel(src.data(), dst.data(), count); });
+        printf("%-28s %10.2f %10.2f %7.2fx  %s\n", test.name, scalar, kernel, scalar / kernel, ok ? "identical" : "DIFFERENT");
+    }
+
+    for (const auto& test : IN_PLACE)
+    {
+        bool ok = checkInPlace(test, colorAlphaPairs);
+        for (int n = 1; n < 67 && ok; ++n)
+        {
+            ok = checkInPlace(test, std::vector<unsigned char>(src.begin(), src.begin() + n * 4));
+        }
+        identical = identical && ok;
+
+        // the pixels are restored before each run, both functions work in place
+        std::vector<unsigned char> pixels(src);
+        double scalar = measure([&] { memcpy(pixels.data(), src.data(), src.size()); test.reference(pixels.data(), count); });
+        double kernel = measure([&] { memcpy(pixels.data(), src.data(), src.size()); test.kernel(pixels.data(), count); });
+        double copy = measure([&] { memcpy(pixels.data(), src.data(), src.size()); });
+        scalar -= copy;
+        kernel -= copy;
+        printf("%-28s %10.2f %10.2f %7.2fx  %s\n", test.name, scalar, kernel, scalar / kernel, ok ? "identical" : "DIFFERENT");
+    }
+
+    printf("%dx%d pixels, conversions to I8 and AI88 have no kernel and keep the Texture2D loops\n", width, height);
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+// Times the loading of images without the texture disk cache, on a miss and on a hit of the
+// cache, following the steps of TextureCache::loadImageWithDiskCache() without the GL upload.
+//
+// usage: texture-cache-bench <images> <cache> [RGBA4444|RGB565]
+//   images  directory of the png and jpg files to load
+//   cache   directory of the entries, emptied before each miss
+//   the pixel format the images are converted to, their own format by default
+
+#include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
+#include "platform/CCMappedFile.h"
+#include "math/MathUtil.h"
+#include "base/ccUTF8.h"
+#include "xxhash.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+
+USING_NS_CC;
+
+// keeps the reads of the mapped pixels
+static volatile unsigned int s_touchedPixels = 0;
+
+// the layout of the entries of TextureCache
+struct DiskCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t sourceHash[2];
+    uint64_t sourceSize;
+    int32_t pixelFormat;
+    int32_t width;
+    int32_t height;
+    uint32_t premultipliedAlpha;
+    uint64_t pixelsLen;
+};
+
+static const char DISK_CACHE_MAGIC[4] = { 'C', 'C', 'T', 'X' };
+static const uint32_t DISK_CACHE_VERSION = 1;
+
+// the arguments are relative to the working directory, not to the search paths
+static std::string getAbsolutePath(const std::string& path)
+{
+    if (FileUtils::getInstance()->isAbsolutePath(path))
+        return path;
+
+    char cwd[4096];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return path;
+
+    std::string absolutePath = std::string(cwd) + "/" + path;
+    std::replace(absolutePath.begin(), absolutePath.end(), '\\', '/');
+    return absolutePath;
+}
+
+static bool isImage(const std::string& extension)
+{
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+static void hashSource(const Data& source, uint32_t sourceHash[2])
+{
+    sourceHash[0] = XXH32(source.getBytes(), (int)source.getSize(), 0);
+    sourceHash[1] = XXH32(source.getBytes(), (int)source.getSize(), sourceHash[0] ^ 0x9E3779B1u);
+}
+
+// the conversions of Texture2D::convertDataToFormat() the tool offers, the others keep the pixels
+static Texture2D::PixelFormat convertPixels(Image* image, Texture2D::PixelFormat format, std::vector<unsigned char>* converted)
+{
+    auto renderFormat = image->getRenderFormat();
+    bool rgba = renderFormat == Texture2D::PixelFormat::RGBA8888;
+    bool rgb = renderFormat == Texture2D::PixelFormat::RGB888;
+    int count = image->getWidth() * image->getHeight();
+    if ((!rgba && !rgb) || (format != Texture2D::PixelFormat::RGBA4444 && format != Texture2D::PixelFormat::RGB565))
+        return renderFormat;
+
+    converted->resize((size_t)count * 2);
+    auto out16 = reinterpret_cast<unsigned short*>(converted->data());
+    if (format == Texture2D::PixelFormat::RGBA4444)
+    {
+        rgba ? MathUtil::convertRGBA8888ToRGBA4444(image->getData(), out16, count) : MathUtil::convertRGB888ToRGBA4444(image->getData(), out16, count);
+    }
+    else
+    {
+        rgba ? MathUtil::convertRGBA8888ToRGB565(image->getData(), out16, count) : MathUtil::convertRGB888ToRGB565(image->getData(), out16, count);
+    }
+    return format;
+}
+
+// the images keep the default premultiplication of png files
+static std::string getEntryPath(const std::string& cachePath, const uint32_t sourceHash[2], Texture2D::PixelFormat format)
+{
+    return cachePath + StringUtils::format("%08x%08x-%dp.tex", sourceHash[0], sourceHash[1], static_cast<int>(format));
+}
+
+// reads, decodes and converts an image, returns the size of its pixels
+static ssize_t loadWithoutCache(const std::string& path, Texture2D::PixelFormat format)
+{
+    Data source = FileUtils::getInstance()->getDataFromFile(path);
+    Image image;
+    if (source.isNull() || !image.initWithImageData(source.getBytes(), source.getSize()))
+        return 0;
+
+    std::vector<unsigned char> converted;
+    convertPixels(&image, format, &converted);
+    return converted.empty() ? image.getDataLen() : (ssize_t)converted.size();
+}
+
+// on a miss, also hashes the source and writes its entry
+static ssize_t loadWithCacheMiss(const std::string& path, const std::string& cachePath, Texture2D::PixelFormat format)
+{
+    auto fileUtils = FileUtils::getInstance();
+    Data source = fileUtils->getDataFromFile(path);
+    if (source.isNull())
+        return 0;
+
+    uint32_t sourceHash[2];
+    hashSource(source, sourceHash);
+    Image image;
+    if (!image.initWithImageData(source.getBytes(), source.getSize()))
+        return 0;
+
+    std::vector<unsigned char> converted;
+    auto pixelFormat = convertPixels(&image, format, &converted);
+    const unsigned char* pixels = converted.empty() ? image.getData() : converted.data();
+    ssize_t pixelsLen = converted.empty() ? image.getDataLen() : (ssize_t)converted.size();
+
+    DiskCacheHeader header;
+    memcpy(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic));
+    header.version = DISK_CACHE_VERSION;
+    header.sourceHash[0] = sourceHash[0];
+    header.sourceHash[1] = sourceHash[1];
+    header.sourceSize = (uint64_t)source.getSize();
+    header.pixelFormat = static_cast<int32_t>(pixelFormat);
+    header.width = image.getWidth();
+    header.height = image.getHeight();
+    header.premultipliedAlpha = image.hasPremultipliedAlpha() ? 1 : 0;
+    header.pixelsLen = (uint64_t)pixelsLen;
+
+    std::string entryPath = getEntryPath(cachePath, sourceHash, format);
+    std::string tempPath = entryPath + ".tmp";
+    FILE* fp = fopen(fileUtils->getSuitableFOpen(tempPath).c_str(), "wb");
+    if (!fp)
+        return 0;
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+        && fwrite(pixels, (size_t)pixelsLen, 1, fp) == 1;
+    written = fclose(fp) == 0 && written;
+    if (!written || !fileUtils->renameFile(tempPath, entryPath))
+        return 0;
+    return pixelsLen;
+}
+
+// on a hit, hashes the source and maps its entry, the upload then reads every page of the pixels
+static ssize_t loadWithCacheHit(const std::string& path, const std::string& cachePath, Texture2D::PixelFormat format)
+{
+    Data source = FileUtils::getInstance()->getDataFromFile(path);
+    if (source.isNull())
+        return 0;
+
+    uint32_t sourceHash[2];
+    hashSource(source, sourceHash);
+    std::string entryPath = getEntryPath(cachePath, sourceHash, format);
+    MappedFile file;
+    if (!file.open(entryPath) || file.getSize() < (ssize_t)sizeof(DiskCacheHeader))
+        return 0;
+
+    DiskCacheHeader header;
+    memcpy(&header, file.getBytes(), sizeof(header));
+    if (memcmp(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != DISK_CACHE_VERSION
+        || header.sourceHash[0] != sourceHash[0] || header.sourceHash[1] != sourceHash[1]
+        || header.sourceSize != (uint64_t)source.getSize()
+        || header.pixelsLen != (uint64_t)(file.getSize() - sizeof(header)))
+        return 0;
+
+    const unsigned char* pixels = file.getBytes() + sizeof(header);
+    for (uint64_t i = 0; i < header.pixelsLen; i += 4096)
+    {
+        s_touchedPixels += pixels[i];
+    }
+    return (ssize_t)header.pixelsLen;
+}
+
+// best of a few runs, in milliseconds
+template <typename F>
+static double measure(F&& run)
+{
+    double best = 1e30;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (!run())
+            return -1;
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed);
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 && argc != 4)
+    {
+        fprintf(stderr, "usage: %s <images> <cache> [RGBA4444|RGB565]\n", argv[0]);
+        return 1;
+    }
+
+    auto format = Texture2D::PixelFormat::AUTO;
+    if (argc == 4)
+    {
+        if (strcmp(argv[3], "RGBA4444") == 0)
+            format = Texture2D::PixelFormat::RGBA4444;
+        else if (strcmp(argv[3], "RGB565") == 0)
+            format = Texture2D::PixelFormat::RGB565;
+        else
+        {
+            fprintf(stderr, "%s: unknown pixel format %s\n", argv[0], argv[3]);
+            return 1;
+        }
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string imagesPath = getAbsolutePath(argv[1]);
+    std::string cachePath = getAbsolutePath(argv[2]);
+    if (cachePath.back() != '/')
+    {
+        cachePath += '/';
+    }
+    if (!fileUtils->isDirectoryExist(imagesPath))
+    {
+        fprintf(stderr, "%s: %s is not a directory\n", argv[0], imagesPath.c_str());
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    std::vector<std::string> images;
+    fileUtils->listFilesRecursively(imagesPath, &files);
+    for (const auto& file : files)
+    {
+        if (!file.empty() && file.back() != '/' && isImage(fileUtils->getFileExtension(file)))
+        {
+            images.push_back(file);
+        }
+    }
+    if (images.empty())
+    {
+        fprintf(stderr, "%s: no png or jpg file in %s\n", argv[0], imagesPath.c_str());
+        return 1;
+    }
+
+    // the first load brings the sources in the file cache of the system
+    ssize_t sourceLen = 0;
+    ssize_t pixelsLen = 0;
+    for (const auto& image : images)
+    {
+        sourceLen += fileUtils->getFileSize(image);
+        pixelsLen += loadWithoutCache(image, format);
+    }
+
+    double withoutCache = measure([&] {
+        for (const auto& image : images)
+        {
+            if (!loadWithoutCache(image, format))
+                return false;
+        }
+        return true;
+    });
+
+    double miss = measure([&] {
+        fileUtils->removeDirectory(cachePath);
+        if (!fileUtils->createDirectory(cachePath))
+            return false;
+        for (const auto& image : images)
+        {
+            if (!loadWithCacheMiss(image, cachePath, format))
+                return false;
+        }
+        return true;
+    });
+
+    double hit = measure([&] {
+        for (const auto& image : images)
+        {
+            if (!loadWithCacheHit(image, cachePath, format))
+                return false;
+        }
+        return true;
+    });
+
+    if (withoutCache < 0 || miss < 0 || hit < 0)
+    {
+        fprintf(stderr, "%s: can't load the images or write the cache in %s\n", argv[0], cachePath.c_str());
+        return 1;
+    }
+
+    printf("%d images, %.1f MB of sources, %.1f MB of pixels\n", (int)images.size(), sourceLen / 1048576.0, pixelsLen / 1048576.0);
+    printf("without cache %10.2f ms\n", withoutCache);
+    printf("cache miss    %10.2f ms\n", miss);
+    printf("cache hit     %10.2f ms  %.1fx faster than without cache\n", hit, withoutCache / hit);
+    return 0;
+}